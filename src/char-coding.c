@@ -442,3 +442,32 @@ int get_user_codepage(void)
 	warning("could not guess your codepage. Falling back to 'UTF-8'\n");
 	return get_codepage_index("UTF-8");
 }
+
+/*
+ * copy of the UTF-8 string 's', converted to charset 'charset_id'.
+ * Chars not available in the target charset are dropped.
+ * Result is to be freed by caller, NULL if 's' is NULL.
+ */
+char *utf8_to_charset(const char *s, unsigned charset_id)
+{
+	char to[64];
+	char *out, *pi, *po;
+	size_t ni, no;
+	iconv_t cd;
+
+	if (s == NULL)
+		return NULL;
+	if (charset_id >= iconv_codes_count())
+		return strdup(s);
+	snprintf(to, sizeof(to), "%s//IGNORE", iconv_codes[charset_id]);
+	if ((cd = iconv_open(to, "UTF-8")) == (iconv_t) (-1))
+		return strdup(s);
+	ni = strlen(s);
+	no = 4 * ni + 1;
+	out = calloc(no, 1);
+	pi = (char *)s;
+	po = out;
+	iconv(cd, &pi, &ni, &po, &no);	// -1 if anything was dropped.
+	iconv_close(cd);
+	return out;
+}
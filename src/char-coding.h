@@ -35,4 +35,10 @@ int get_codepage_index(const char *codepage);
 void char_coding(char **inbuf, size_t * inbytesleft, char **outbuf,
 		 size_t * outbytesleft, unsigned user_charset_id);
 
+/*
+ * malloc'ed copy of UTF-8 string 's' in charset 'charset_id',
+ * used if outputs need different charsets.
+ */
+char *utf8_to_charset(const char *s, unsigned charset_id);
+
 #endif
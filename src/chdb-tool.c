@@ -0,0 +1,157 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "chdb.h"
+#include "diff.h"
+
+/******************************************************************************
+ * w_scan2-db: query a binary channel database written by
+ * 'w_scan2 --output db:<file>'.
+ *****************************************************************************/
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s <file> [command]\n"
+		"commands:\n"
+		"       list                    all services, by onid/tsid/sid (default)\n"
+		"       lcn                     all services, by logical channel number\n"
+		"       name                    all services, by name\n"
+		"       sid <onid> <tsid> <sid> one service\n"
+		"       lcn <n>                 services with logical channel number n\n"
+		"       name <name>             services named <name>, case insensitive\n"
+		"       diff <file2> [vdr]      changes from <file> to <file2> as JSON, or\n"
+		"                               new, moved and changed services in VDR format\n",
+		prog);
+	exit(1);
+}
+
+static void print_service(const struct chdb *db, const struct chdb_service *s)
+{
+	const struct chdb_transponder *t = chdb_transponder_of(db, s);
+
+	printf("%5u:%5u:%5u lcn=%-4u %-32s %-20s freq=%u pmt=%u%s\n",
+	       chdb16(s->original_network_id),
+	       chdb16(s->transport_stream_id),
+	       chdb16(s->service_id),
+	       chdb32(s->logical_channel_number),
+	       chdb_string(db, s->name),
+	       chdb_string(db, s->provider),
+	       t ? chdb32(t->frequency) : 0,
+	       chdb16(s->pmt_pid), s->scrambled ? " scrambled" : "");
+}
+
+/* exit code 3 if there are differences. */
+static int diff_files(const struct chdb *db, const char *file, bool vdr)
+{
+	struct chdb db2;
+	struct w_scan_flags flags;
+	struct output_buffer ob;
+	cList before, now;
+	FILE *json = stdout;
+	uint32_t changes;
+
+	if (chdb_open(&db2, file) < 0) {
+		fprintf(stderr, "%s: %s\n", file, strerror(errno));
+		return 1;
+	}
+	if (vdr && ((json = fopen("/dev/null", "w")) == NULL))
+		return 1;
+	memset(&flags, 0, sizeof(flags));
+	flags.vdr_version = 2;
+	flags.ca_select = 1;
+	NewList(&before, "before");
+	NewList(&now, "now");
+	diff_load(db, &before);
+	diff_load(&db2, &now);
+	ob_init(&ob, STDOUT_FILENO);
+	changes = diff_results(&before, &now, NULL, json, vdr ? &ob : NULL,
+			       &flags);
+	ob_flush(&ob);
+	if (vdr)
+		fclose(json);
+	diff_free(&before);
+	diff_free(&now);
+	chdb_close(&db2);
+	return changes ? 3 : 0;
+}
+
+static void print_range(const struct chdb *db, const uint32_t * index,
+			size_t pos, size_t count)
+{
+	size_t i;
+
+	for (i = pos; i < pos + count; i++) {
+		uint32_t n = chdb32(index[i]);
+		if (n < db->service_count)
+			print_service(db, &db->services[n]);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct chdb db;
+	const char *cmd = argc > 2 ? argv[2] : "list";
+	size_t pos, count;
+	int ret = 0;
+
+	if (argc < 2)
+		usage(argv[0]);
+	if (chdb_open(&db, argv[1]) < 0) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	if (!strcmp(cmd, "list") && (argc == 3 || argc == 2))
+		print_range(&db, db.by_id, 0, db.service_count);
+	else if (!strcmp(cmd, "lcn") && (argc == 3))
+		print_range(&db, db.by_lcn, 0, db.service_count);
+	else if (!strcmp(cmd, "name") && (argc == 3))
+		print_range(&db, db.by_name, 0, db.service_count);
+	else if (!strcmp(cmd, "sid") && (argc == 6)) {
+		const struct chdb_service *s;
+		s = chdb_find_service(&db, strtoul(argv[3], NULL, 0),
+				      strtoul(argv[4], NULL, 0),
+				      strtoul(argv[5], NULL, 0));
+		if (s)
+			print_service(&db, s);
+		ret = s ? 0 : 2;
+	} else if (!strcmp(cmd, "lcn") && (argc == 4)) {
+		pos = chdb_lcn_range(&db, strtoul(argv[3], NULL, 0), &count);
+		print_range(&db, db.by_lcn, pos, count);
+		ret = count ? 0 : 2;
+	} else if (!strcmp(cmd, "name") && (argc == 4)) {
+		pos = chdb_name_range(&db, argv[3], &count);
+		print_range(&db, db.by_name, pos, count);
+		ret = count ? 0 : 2;
+	} else if (!strcmp(cmd, "diff") && (argc == 4))
+		ret = diff_files(&db, argv[3], false);
+	else if (!strcmp(cmd, "diff") && (argc == 5) && !strcmp(argv[4], "vdr"))
+		ret = diff_files(&db, argv[3], true);
+	else
+		usage(argv[0]);
+
+	chdb_close(&db);
+	return ret;
+}
@@ -0,0 +1,223 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "chdb.h"
+
+/******************************************************************************
+ * reader for the binary channel database, see chdb.h. Only the section
+ * bounds are checked on open, records are used in place.
+ *****************************************************************************/
+
+static int section_ok(size_t size, uint32_t offset, uint32_t count,
+		      size_t record)
+{
+	if (offset & 3)
+		return 0;
+	if (offset > size)
+		return 0;
+	return (size - offset) / record >= count;
+}
+
+int chdb_open(struct chdb *db, const char *path)
+{
+	const struct chdb_header *h;
+	struct stat st;
+	void *p;
+	int fd;
+
+	memset(db, 0, sizeof(*db));
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return -1;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return -1;
+	}
+	if ((size_t) st.st_size < sizeof(struct chdb_header)) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return -1;
+	db->base = p;
+	db->size = st.st_size;
+
+	h = p;
+	if (memcmp(h->magic, CHDB_MAGIC, sizeof(h->magic))
+	    || (chdb32(h->version) != CHDB_VERSION)
+	    || (chdb32(h->file_size) != db->size))
+		goto bad;
+	db->transponder_count = chdb32(h->transponder_count);
+	db->service_count = chdb32(h->service_count);
+	db->strings_size = chdb32(h->strings_size);
+	if (!section_ok(db->size, chdb32(h->transponder_offset),
+			db->transponder_count, sizeof(struct chdb_transponder))
+	    || !section_ok(db->size, chdb32(h->service_offset),
+			   db->service_count, sizeof(struct chdb_service))
+	    || !section_ok(db->size, chdb32(h->strings_offset),
+			   db->strings_size, 1)
+	    || !section_ok(db->size, chdb32(h->index_id_offset),
+			   db->service_count, sizeof(uint32_t))
+	    || !section_ok(db->size, chdb32(h->index_lcn_offset),
+			   db->service_count, sizeof(uint32_t))
+	    || !section_ok(db->size, chdb32(h->index_name_offset),
+			   db->service_count, sizeof(uint32_t)))
+		goto bad;
+	db->transponders = (const void *)(db->base + chdb32(h->transponder_offset));
+	db->services = (const void *)(db->base + chdb32(h->service_offset));
+	db->strings = (const char *)db->base + chdb32(h->strings_offset);
+	db->by_id = (const void *)(db->base + chdb32(h->index_id_offset));
+	db->by_lcn = (const void *)(db->base + chdb32(h->index_lcn_offset));
+	db->by_name = (const void *)(db->base + chdb32(h->index_name_offset));
+	// pool has to start with the empty string and be terminated.
+	if ((db->strings_size == 0) || db->strings[0]
+	    || db->strings[db->strings_size - 1])
+		goto bad;
+	return 0;
+
+ bad:
+	chdb_close(db);
+	errno = EINVAL;
+	return -1;
+}
+
+void chdb_close(struct chdb *db)
+{
+	if (db->base)
+		munmap((void *)db->base, db->size);
+	memset(db, 0, sizeof(*db));
+}
+
+const char *chdb_string(const struct chdb *db, uint32_t offset)
+{
+	offset = chdb32(offset);
+	if (offset >= db->strings_size)
+		return "";
+	return db->strings + offset;
+}
+
+const struct chdb_transponder *chdb_transponder_of(const struct chdb *db,
+						  const struct chdb_service *s)
+{
+	uint32_t i = chdb32(s->transponder);
+
+	if (i >= db->transponder_count)
+		return NULL;
+	return &db->transponders[i];
+}
+
+static const struct chdb_service *service_at(const struct chdb *db,
+					     const uint32_t * index,
+					     size_t pos)
+{
+	uint32_t i = chdb32(index[pos]);
+
+	if (i >= db->service_count)
+		return &db->services[0];	// broken index, stay in bounds.
+	return &db->services[i];
+}
+
+static int cmp_id(const struct chdb_service *s, uint16_t onid, uint16_t tsid,
+		  uint16_t sid)
+{
+	if (chdb16(s->original_network_id) != onid)
+		return chdb16(s->original_network_id) < onid ? -1 : 1;
+	if (chdb16(s->transport_stream_id) != tsid)
+		return chdb16(s->transport_stream_id) < tsid ? -1 : 1;
+	if (chdb16(s->service_id) != sid)
+		return chdb16(s->service_id) < sid ? -1 : 1;
+	return 0;
+}
+
+const struct chdb_service *chdb_find_service(const struct chdb *db,
+					     uint16_t onid, uint16_t tsid,
+					     uint16_t sid)
+{
+	size_t lo = 0, hi = db->service_count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const struct chdb_service *s = service_at(db, db->by_id, mid);
+		int c = cmp_id(s, onid, tsid, sid);
+
+		if (c == 0)
+			return s;
+		if (c < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return NULL;
+}
+
+/* first position in 'index' where key(service) >= key, and the number of
+ * services with the same key following there.
+ */
+#define LOWER_BOUND(db, index, less, equal)                             \
+	do {                                                            \
+		size_t lo = 0, hi = (db)->service_count;                \
+		while (lo < hi) {                                       \
+			size_t mid = lo + (hi - lo) / 2;                \
+			const struct chdb_service *s =                  \
+			    service_at(db, index, mid);                 \
+			if (less)                                       \
+				lo = mid + 1;                           \
+			else                                            \
+				hi = mid;                               \
+		}                                                       \
+		pos = lo;                                               \
+		for (n = 0; pos + n < (db)->service_count; n++) {       \
+			const struct chdb_service *s =                  \
+			    service_at(db, index, pos + n);             \
+			if (!(equal))                                   \
+				break;                                  \
+		}                                                       \
+	} while (0)
+
+size_t chdb_lcn_range(const struct chdb *db, uint32_t lcn, size_t * count)
+{
+	size_t pos, n;
+
+	LOWER_BOUND(db, db->by_lcn, chdb32(s->logical_channel_number) < lcn,
+		    chdb32(s->logical_channel_number) == lcn);
+	*count = n;
+	return pos;
+}
+
+size_t chdb_name_range(const struct chdb *db, const char *name,
+		       size_t * count)
+{
+	size_t pos, n;
+
+	LOWER_BOUND(db, db->by_name,
+		    strcasecmp(chdb_string(db, s->name), name) < 0,
+		    strcasecmp(chdb_string(db, s->name), name) == 0);
+	*count = n;
+	return pos;
+}
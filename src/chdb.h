@@ -0,0 +1,159 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __CHDB_H__
+#define __CHDB_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <endian.h>
+
+/******************************************************************************
+ * binary channel database, written by '--output db:<file>'.
+ *
+ * All integers are little-endian, all sections start 4-byte aligned and all
+ * records have fixed size, so that the file can be mmap()ed and used without
+ * parsing. Strings are NUL terminated UTF-8 in one pool and referenced by
+ * their offset, offset 0 is the empty string. The three indexes are arrays
+ * of service_count uint32_t service numbers, sorted by
+ *   - (onid, tsid, sid)
+ *   - (lcn, onid, tsid, sid)
+ *   - name (strcasecmp), then (onid, tsid, sid)
+ *
+ * Incompatible changes increase CHDB_VERSION, new fields go into the
+ * reserved space or at the end of the records.
+ *****************************************************************************/
+
+#define CHDB_MAGIC    "W2CHDB\r\n"
+#define CHDB_VERSION  3
+
+struct chdb_header {		// 64 bytes
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint32_t file_size;
+	uint32_t transponder_count;
+	uint32_t transponder_offset;
+	uint32_t service_count;
+	uint32_t service_offset;
+	uint32_t strings_offset;
+	uint32_t strings_size;
+	uint32_t index_id_offset;
+	uint32_t index_lcn_offset;
+	uint32_t index_name_offset;
+	uint32_t reserved[2];
+};
+
+struct chdb_transponder {	// 48 bytes
+	uint32_t frequency;
+	uint32_t symbolrate;
+	uint32_t bandwidth;
+	uint32_t source;
+	uint32_t network_name;	// string
+	uint16_t original_network_id;
+	uint16_t network_id;
+	uint16_t transport_stream_id;
+	uint8_t delsys;
+	uint8_t modulation;
+	uint8_t coderate;
+	uint8_t polarization;
+	uint8_t rolloff;
+	uint8_t plp_id;
+	// version 2: all tuning parameters, see --warm-start.
+	uint16_t orbital_position;
+	uint16_t system_id;
+	uint8_t type;		// scan type
+	uint8_t inversion;
+	uint8_t pilot;
+	uint8_t input_stream_id;
+	uint8_t coderate_LP;
+	uint8_t guard;
+	uint8_t transmission;
+	uint8_t hierarchy;
+	uint8_t west_east_flag;
+	uint8_t data_slice_id;
+	uint8_t reserved[2];
+};
+
+struct chdb_service {		// 48 bytes
+	uint32_t transponder;	// index into transponder table
+	uint32_t name;		// string
+	uint32_t provider;	// string
+	uint32_t logical_channel_number;
+	uint16_t original_network_id;
+	uint16_t transport_stream_id;
+	uint16_t service_id;
+	uint16_t pmt_pid;
+	uint16_t pcr_pid;
+	uint16_t video_pid;
+	uint16_t audio_pid;	// first audio pid
+	uint16_t ac3_pid;	// first ac3 pid
+	uint16_t teletext_pid;
+	uint16_t ca_id;		// first CA system id
+	uint8_t video_stream_type;
+	uint8_t audio_num;
+	uint8_t ac3_num;
+	uint8_t scrambled;
+	// version 3: languages, see --diff.
+	char audio_lang[4];	// first audio language, NUL terminated
+	char ac3_lang[4];	// first ac3 language, NUL terminated
+};
+
+/* field access, no-ops on little-endian hosts. */
+#define chdb16(v) le16toh(v)
+#define chdb32(v) le32toh(v)
+
+/******************************************************************************
+ * reader.
+ *****************************************************************************/
+
+struct chdb {
+	const uint8_t *base;
+	size_t size;
+	uint32_t transponder_count;
+	uint32_t service_count;
+	const struct chdb_transponder *transponders;
+	const struct chdb_service *services;
+	const char *strings;
+	uint32_t strings_size;
+	const uint32_t *by_id;
+	const uint32_t *by_lcn;
+	const uint32_t *by_name;
+};
+
+/* returns 0 on success, -1 with errno set otherwise. */
+int chdb_open(struct chdb *db, const char *path);
+void chdb_close(struct chdb *db);
+
+const char *chdb_string(const struct chdb *db, uint32_t offset);
+const struct chdb_transponder *chdb_transponder_of(const struct chdb *db,
+						  const struct chdb_service *s);
+
+/* chdb_find_service() returns NULL if not found. The range lookups return
+ * the position of the first match in by_lcn[] / by_name[] and the number of
+ * matches in *count, i.e. services[chdb32(by_lcn[pos + i])], i < *count.
+ */
+const struct chdb_service *chdb_find_service(const struct chdb *db,
+					     uint16_t onid, uint16_t tsid,
+					     uint16_t sid);
+size_t chdb_lcn_range(const struct chdb *db, uint32_t lcn, size_t * count);
+size_t chdb_name_range(const struct chdb *db, const char *name,
+		       size_t * count);
+
+#endif
@@ -0,0 +1,271 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "scan.h"
+#include "checkpoint.h"
+
+struct checkpoint_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t transponder_size;
+	uint32_t service_size;
+	uint32_t cell_size;
+	struct checkpoint_state state;
+	uint32_t count;		// transponders, scanned first
+	uint32_t scanned;
+};
+
+/******************************************************************************
+ * strings: length + bytes, 0xFFFFFFFF for NULL.
+ *****************************************************************************/
+
+static bool write_string(FILE *f, const char *s)
+{
+	uint32_t len = s ? strlen(s) : 0xFFFFFFFF;
+
+	if (fwrite(&len, sizeof(len), 1, f) != 1)
+		return false;
+	return (s == NULL) || (len == 0) || (fwrite(s, len, 1, f) == 1);
+}
+
+static bool read_string(FILE *f, char **s)
+{
+	uint32_t len;
+
+	*s = NULL;
+	if (fread(&len, sizeof(len), 1, f) != 1)
+		return false;
+	if (len == 0xFFFFFFFF)
+		return true;
+	if (len > 0xFFFF)
+		return false;
+	if ((*s = calloc(len + 1, 1)) == NULL)
+		fatal("out of memory\n");
+	return (len == 0) || (fread(*s, len, 1, f) == 1);
+}
+
+/******************************************************************************
+ * transponders.
+ *****************************************************************************/
+
+static bool write_transponder(FILE *f, struct transponder *t)
+{
+	struct service *s;
+	struct cell *c;
+	uint32_t n;
+
+	if (fwrite(t, sizeof(*t), 1, f) != 1 || !write_string(f, t->network_name))
+		return false;
+	n = t->cells->count;
+	if (fwrite(&n, sizeof(n), 1, f) != 1)
+		return false;
+	for (c = t->cells->first; c; c = c->next)
+		if (fwrite(c, sizeof(*c), 1, f) != 1)
+			return false;
+	n = t->services->count;
+	if (fwrite(&n, sizeof(n), 1, f) != 1)
+		return false;
+	for (s = t->services->first; s; s = s->next)
+		if ((fwrite(s, sizeof(*s), 1, f) != 1)
+		    || !write_string(f, s->provider_name)
+		    || !write_string(f, s->provider_short_name)
+		    || !write_string(f, s->service_name)
+		    || !write_string(f, s->service_short_name))
+			return false;
+	return true;
+}
+
+static void free_transponder(struct transponder *t)
+{
+	struct service *s;
+
+	for (s = t->services->first; s; s = s->next) {
+		free(s->provider_name);
+		free(s->provider_short_name);
+		free(s->service_name);
+		free(s->service_short_name);
+	}
+	ClearList(t->services);
+	ClearList(t->cells);
+	free(t->network_name);
+	free(t);
+}
+
+/* pointers read from the file are replaced before anything may use them. */
+static struct transponder *read_transponder(FILE *f)
+{
+	struct transponder *t = calloc(1, sizeof(*t));
+	char *network_name = NULL;
+	uint32_t i, n;
+	bool ok;
+
+	if (t == NULL)
+		fatal("out of memory\n");
+	ok = fread(t, sizeof(*t), 1, f) == 1;
+	init_transponder_lists(t);
+	t->network_name = NULL;
+	// network change notify descriptors are not kept.
+	memset(&t->network_change, 0, sizeof(t->network_change));
+	ok = ok && read_string(f, &network_name);
+	t->network_name = network_name;
+
+	ok = ok && (fread(&n, sizeof(n), 1, f) == 1);
+	for (i = 0; ok && (i < n); i++) {
+		struct cell *c = calloc(1, sizeof(*c));
+		if (c == NULL)
+			fatal("out of memory\n");
+		if (!(ok = fread(c, sizeof(*c), 1, f) == 1)) {
+			free(c);
+			break;
+		}
+		AddItem(t->cells, c);
+	}
+
+	ok = ok && (fread(&n, sizeof(n), 1, f) == 1);
+	for (i = 0; ok && (i < n); i++) {
+		struct service *s = calloc(1, sizeof(*s));
+		if (s == NULL)
+			fatal("out of memory\n");
+		ok = fread(s, sizeof(*s), 1, f) == 1;
+		s->transponder = t;
+		s->priv = NULL;
+		ok = ok && read_string(f, &s->provider_name);
+		ok = ok && read_string(f, &s->provider_short_name);
+		ok = ok && read_string(f, &s->service_name);
+		ok = ok && read_string(f, &s->service_short_name);
+		AddItem(t->services, s);
+	}
+	if (!ok) {
+		free_transponder(t);
+		return NULL;
+	}
+	return t;
+}
+
+/******************************************************************************
+ * checkpoint file.
+ *****************************************************************************/
+
+/* queued may be NULL. */
+static bool write_checkpoint(FILE *f, const struct checkpoint_state *st,
+			     pList scanned, pList queued)
+{
+	struct checkpoint_header h;
+	struct transponder *t;
+	bool ok;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic));
+	h.version = CHECKPOINT_VERSION;
+	h.transponder_size = sizeof(struct transponder);
+	h.service_size = sizeof(struct service);
+	h.cell_size = sizeof(struct cell);
+	h.state = *st;
+	h.count = scanned->count + (queued ? queued->count : 0);
+	h.scanned = scanned->count;
+	ok = fwrite(&h, sizeof(h), 1, f) == 1;
+	for (t = scanned->first; ok && t; t = t->next)
+		ok = write_transponder(f, t);
+	for (t = queued ? queued->first : NULL; ok && t; t = t->next)
+		ok = write_transponder(f, t);
+	return ok;
+}
+
+/* written to <file>.tmp and renamed, an interrupted write keeps the old one. */
+int checkpoint_write(const char *file, const struct checkpoint_state *st,
+		     pList scanned, pList queued)
+{
+	char tmp[strlen(file) + 5];
+	bool ok;
+	FILE *f;
+
+	sprintf(tmp, "%s.tmp", file);
+	if ((f = fopen(tmp, "w")) == NULL)
+		return -1;
+	ok = write_checkpoint(f, st, scanned, queued);
+	if (fclose(f) != 0)
+		ok = false;
+	if (!ok || rename(tmp, file) != 0) {
+		int e = errno;
+		unlink(tmp);
+		errno = e;
+		return -1;
+	}
+	return 0;
+}
+
+int checkpoint_write_result(int fd, pList scanned)
+{
+	struct checkpoint_state st = {
+		.phase = CHECKPOINT_RESULT,
+		.rotor_position = -1,
+	};
+	bool ok;
+	FILE *f;
+	int dup_fd = dup(fd);
+
+	if ((dup_fd < 0) || (f = fdopen(dup_fd, "w")) == NULL) {
+		if (dup_fd >= 0)
+			close(dup_fd);
+		return -1;
+	}
+	ok = write_checkpoint(f, &st, scanned, NULL);
+	if (fclose(f) != 0)
+		ok = false;
+	return ok ? 0 : -1;
+}
+
+int checkpoint_read(const char *file, struct checkpoint_state *st,
+		    pList scanned, pList queued)
+{
+	struct checkpoint_header h;
+	struct transponder *t;
+	uint32_t i;
+	FILE *f;
+
+	if ((f = fopen(file, "r")) == NULL)
+		return -1;
+	if ((fread(&h, sizeof(h), 1, f) != 1)
+	    || memcmp(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic))
+	    || (h.version != CHECKPOINT_VERSION)
+	    || (h.transponder_size != sizeof(struct transponder))
+	    || (h.service_size != sizeof(struct service))
+	    || (h.cell_size != sizeof(struct cell))
+	    || (h.scanned > h.count)) {
+		fclose(f);
+		errno = EINVAL;
+		return -1;
+	}
+	for (i = 0; i < h.count; i++) {
+		if ((t = read_transponder(f)) == NULL) {
+			fclose(f);
+			errno = EINVAL;
+			return -1;
+		}
+		AddItem(i < h.scanned ? scanned : queued, t);
+	}
+	fclose(f);
+	*st = h.state;
+	return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <stdint.h>
+#include "list.h"
+
+/******************************************************************************
+ * scan checkpoints, written by '--checkpoint <file>', read by
+ * '--resume <file>'.
+ *
+ * Holds the scanned and the queued transponders with all their services,
+ * the blind scan position and the rotor position. The records are the
+ * in-memory structs, so a checkpoint is only valid for the w_scan2 binary
+ * which wrote it; the struct sizes are checked on reading.
+ *
+ * '--output shard:<file>' writes the same records for the result of a
+ * finished scan, read by '--merge'.
+ *****************************************************************************/
+
+#define CHECKPOINT_MAGIC    "W2CHKPNT"
+#define CHECKPOINT_VERSION  1
+
+enum {
+	CHECKPOINT_BLIND_SCAN = 0,	// initial_tune(), at 'position'
+	CHECKPOINT_NETWORK_SCAN = 1,	// scanning the queued transponders
+	CHECKPOINT_RESULT = 2,	// finished, all transponders scanned
+};
+
+struct checkpoint_state {
+	uint32_t scantype;
+	uint32_t channellist;
+	uint32_t phase;
+	uint32_t delsys_parm;	// blind scan: next position
+	uint32_t mod_parm;
+	uint32_t channel;
+	int32_t rotor_position;	// -1 == unknown
+};
+
+/* 0 on success. */
+int checkpoint_write(const char *file, const struct checkpoint_state *st,
+		     pList scanned, pList queued);
+
+/* the scan result as checkpoint, phase CHECKPOINT_RESULT, to fd.
+ * 0 on success.
+ */
+int checkpoint_write_result(int fd, pList scanned);
+
+/* appends to scanned and queued. 0 on success, -1 with errno set
+ * (EINVAL: not a checkpoint of this binary) otherwise.
+ */
+int checkpoint_read(const char *file, struct checkpoint_state *st,
+		    pList scanned, pList queued);
+
+#endif
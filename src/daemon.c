@@ -0,0 +1,328 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "scan.h"
+#include "tools.h"
+#include "daemon.h"
+
+#define MAX_JOB_LEN  4096
+#define MAX_JOB_ARGS 64
+#define JOB_TIMEOUT  10		// seconds to send the job line.
+
+static struct warm_device warm = {.fd = -1,.rotor_pos = -1 };
+
+static int job_fd = -1;		// in a scan job: socket to the daemon.
+
+/* one line of w_scan2 options, i.e. "-fs -s S19E2 -X". */
+static int read_job(int client, char *buf, size_t size)
+{
+	size_t len = 0;
+	ssize_t n;
+
+	while (len < size - 1) {
+		n = read(client, buf + len, size - 1 - len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		len += n;
+		if (memchr(buf, '\n', len))
+			break;
+	}
+	buf[len] = 0;
+	buf[strcspn(buf, "\r\n")] = 0;
+	return len;
+}
+
+static int split_args(char *line, char **argv, int max)
+{
+	int argc = 0;
+	char *p, *save;
+
+	argv[argc++] = (char *)"w_scan2";
+	for (p = strtok_r(line, " \t", &save); p && argc < max - 1;
+	     p = strtok_r(NULL, " \t", &save))
+		argv[argc++] = p;
+	argv[argc] = NULL;
+	return argc;
+}
+
+/* options a client may not use: they read or write files as the daemon's
+ * user, or start another daemon. A value of "-" (stdout) is fine for some.
+ */
+static const struct {
+	const char *name;
+	int stdout_ok;
+} job_denied[] = {
+	{"daemon", 0},
+	{"initial", 0},
+	{"position-file", 0},
+	{"rotor-model", 0},
+	{"output", 1},
+	{"stats", 1},
+	{"trace", 1},
+	{"monitor", 1},
+	{"si-cache", 0},
+	{"dead-cache", 0},
+	{"warm-start", 0},
+	{"verify", 0},
+	{"diff", 0},
+	{"diff-vdr", 0},
+	{"checkpoint", 0},
+	{"resume", 0},
+	{"merge", 0},
+};
+
+/* short options with argument, as in scan_run(). */
+#define JOB_SHORT_ARGS "aceflioprstuACDEIOQRST"
+#define JOB_SHORT_DENIED "Ip"
+
+/* '-a <value>': neither a number nor a /dev/dvb path is read as emulation
+ * log file, see scan_run().
+ */
+static int is_emulation_log(const char *value)
+{
+	int n;
+
+	return !strstr(value, "/dev/dvb") && (sscanf(value, "%d", &n) < 1);
+}
+
+/* NULL if the job is allowed, otherwise the offending option. */
+static const char *job_denied_option(int argc, char **argv)
+{
+	int i;
+	size_t j, len;
+	const char *p, *value;
+
+	for (i = 1; i < argc; i++) {
+		p = argv[i];
+		if (!strcmp(p, "--"))
+			break;
+		if ((p[0] != '-') || (p[1] == 0))
+			continue;
+		if (p[1] != '-') {
+			// clustered short options, i.e. "-fsI file"
+			for (p++; *p; p++) {
+				if (strchr(JOB_SHORT_DENIED, *p))
+					return argv[i];
+				if (strchr(JOB_SHORT_ARGS, *p)) {
+					value = p[1] ? p + 1 :
+					    (i + 1 < argc ? argv[i + 1] : "");
+					if ((*p == 'a') && is_emulation_log(value))
+						return argv[i];
+					if (p[1] == 0)
+						i++;	// next one is the value.
+					break;
+				}
+			}
+			continue;
+		}
+		// long options may be abbreviated, i.e. "--check".
+		p += 2;
+		len = strcspn(p, "=");
+		value = p[len] ? p + len + 1 : (i + 1 < argc ? argv[i + 1] : "");
+		if (len && !strncmp(p, "adapter", len) && is_emulation_log(value))
+			return argv[i];
+		for (j = 0; j < sizeof(job_denied) / sizeof(job_denied[0]); j++) {
+			if (len && !strncmp(p, job_denied[j].name, len)) {
+				if (strlen(job_denied[j].name) != len)
+					return argv[i];	// abbreviated, don't guess.
+				if (!job_denied[j].stdout_ok)
+					return argv[i];
+				// "--output format:-"
+				if (strcmp(value, "-")
+				    && ((len = strlen(value)) < 2
+					|| strcmp(value + len - 2, ":-")))
+					return argv[i];
+				break;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* state and frontend fd of a finished job, 0 if the job sent none. */
+static int receive_state(int sock, struct warm_device *w)
+{
+	char cbuf[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = {.iov_base = w,.iov_len = sizeof(*w) };
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = cbuf,
+		.msg_controllen = sizeof(cbuf),
+	};
+	struct cmsghdr *cmsg;
+
+	if (recvmsg(sock, &msg, 0) != sizeof(*w))
+		return 0;
+	w->fd = -1;
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg && cmsg->cmsg_level == SOL_SOCKET
+	    && cmsg->cmsg_type == SCM_RIGHTS)
+		memcpy(&w->fd, CMSG_DATA(cmsg), sizeof(int));
+	return 1;
+}
+
+static void run_job(int client)
+{
+	char line[MAX_JOB_LEN];
+	char *argv[MAX_JOB_ARGS];
+	int argc, sv[2], status, received;
+	struct warm_device next;
+	const char *denied;
+	pid_t pid;
+
+	if (read_job(client, line, sizeof(line)) <= 0)
+		return;
+	info("(time: %s) job: %s\n", run_time(), line);
+	argc = split_args(line, argv, MAX_JOB_ARGS);
+	if ((denied = job_denied_option(argc, argv)) != NULL) {
+		dprintf(client, "option '%s' not allowed in scan jobs\n",
+			denied);
+		warning("job rejected: option '%s' not allowed\n", denied);
+		return;
+	}
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+		errorn("socketpair");
+		return;
+	}
+	fflush(stdout);
+	switch (pid = fork()) {
+	case -1:
+		errorn("fork");
+		close(sv[0]);
+		close(sv[1]);
+		return;
+	case 0:
+		close(sv[0]);
+		job_fd = sv[1];
+		dup2(client, STDOUT_FILENO);
+		close(client);
+		signal(SIGINT, SIG_DFL);	// the handler knows the daemon's context only.
+		exit(scan_run(scan_context_new(), argc, argv));
+	default:;
+	}
+	close(sv[1]);
+
+	received = receive_state(sv[0], &next);
+	close(sv[0]);
+	waitpid(pid, &status, 0);
+	if (received) {
+		if (warm.fd >= 0)
+			close(warm.fd);	// we got a new copy.
+		warm = next;
+	} else if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+		// job failed while using the frontend: state is unknown.
+		warm.rotor_pos = -1;
+		memset(warm.sec_state, 0xFF, sizeof(warm.sec_state));	// all -1
+	}
+	info("(time: %s) job done, exit status %d\n", run_time(),
+	     WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+}
+
+void daemon_run(const char *socket_path)
+{
+	struct sockaddr_un addr;
+	struct timeval timeout = {.tv_sec = JOB_TIMEOUT };
+	int sock, client;
+	mode_t mask;
+
+	if (strlen(socket_path) >= sizeof(addr.sun_path))
+		fatal("socket path too long: '%s'\n", socket_path);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+
+	if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		fatal("socket: %s\n", strerror(errno));
+	unlink(socket_path);
+	// owner only: jobs run with our privileges.
+	mask = umask(0177);
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		fatal("bind '%s': %s\n", socket_path, strerror(errno));
+	umask(mask);
+	if (chmod(socket_path, 0600) < 0)
+		fatal("chmod '%s': %s\n", socket_path, strerror(errno));
+	if (listen(sock, 4) < 0)
+		fatal("listen: %s\n", strerror(errno));
+	signal(SIGPIPE, SIG_IGN);	// client gone: job ends by write error.
+	info("daemon: waiting for scan jobs on %s\n", socket_path);
+
+	for (;;) {
+		if ((client = accept(sock, NULL, NULL)) < 0) {
+			if (errno != EINTR)
+				errorn("accept");
+			continue;
+		}
+		// a client which never sends a newline must not block us.
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+			   sizeof(timeout));
+		run_job(client);
+		close(client);
+	}
+}
+
+struct warm_device *daemon_warm_device(int adapter, int frontend,
+				       uint16_t scantype)
+{
+	if ((job_fd < 0) || (warm.fd < 0) || (warm.scantype != scantype))
+		return NULL;
+	if ((adapter >= 0)
+	    && ((adapter != warm.adapter) || (frontend != warm.frontend)))
+		return NULL;
+	return &warm;
+}
+
+void daemon_job_done(struct warm_device *w)
+{
+	char cbuf[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = {.iov_base = w,.iov_len = sizeof(*w) };
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = cbuf,
+		.msg_controllen = sizeof(cbuf),
+	};
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+
+	if (job_fd < 0)
+		return;
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &w->fd, sizeof(int));
+	if (sendmsg(job_fd, &msg, 0) != sizeof(*w))
+		warning("could not hand frontend back to daemon\n");
+	close(job_fd);
+	job_fd = -1;
+}
@@ -0,0 +1,58 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __DAEMON_H__
+#define __DAEMON_H__
+
+#include <stdint.h>
+#include "extended_frontend.h"
+#include "diseqc.h"
+
+/******************************************************************************
+ * daemon mode, '--daemon <socket>': scan jobs are read from a UNIX socket
+ * and run in a child process each, writing results to the client.
+ * The frontend stays open in the daemon together with what is known about
+ * it, so the next job neither searches adapters nor waits for an unknown
+ * rotor position.
+ *****************************************************************************/
+
+struct warm_device {
+	int fd;			// open frontend, -1 if none.
+	int adapter;
+	int frontend;
+	uint16_t scantype;
+	uint16_t api_version;
+	struct dvb_frontend_info fe_info;
+	int rotor_pos;		// -1 == unknown
+	uint8_t sec_state[SEC_STATE_SIZE];
+};
+
+/* never returns. */
+void daemon_run(const char *socket_path);
+
+/* in a scan job: the kept frontend, if it matches; NULL otherwise.
+ * adapter < 0 matches any adapter.
+ */
+struct warm_device *daemon_warm_device(int adapter, int frontend,
+				       uint16_t scantype);
+
+/* in a scan job: hand the frontend and its state back to the daemon. */
+void daemon_job_done(struct warm_device *w);
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <endian.h>
+#include "tools.h"
+#include "dead-cache.h"
+
+/******************************************************************************
+ * file format, all integers little-endian:
+ *   header: magic[8], uint32 version, uint32 entry count
+ *   entry:  uint32 frequency, uint16 source, uint8 delsys,
+ *           uint8 polarization, int64 time of the last failed attempt
+ *****************************************************************************/
+
+struct dead_record {
+	uint32_t frequency;
+	uint16_t source;
+	uint8_t delsys;
+	uint8_t polarization;
+	int64_t failed;
+} __attribute__ ((packed));
+
+struct dead_cache *dead_cache_new(void)
+{
+	struct dead_cache *c = calloc(1, sizeof(*c));
+
+	if (c == NULL)
+		fatal("out of memory\n");
+	c->entries = &c->_entries;
+	NewList(c->entries, "dead_cache");
+	c->ttl = DEAD_CACHE_TTL;
+	return c;
+}
+
+static bool expired(struct dead_cache *c, struct dead_frequency *e,
+		    time_t now)
+{
+	return (c->ttl == 0) || (now - e->failed > (time_t) c->ttl);
+}
+
+/* a missing or unreadable file gives an empty cache. */
+void dead_cache_load(struct dead_cache *c, const char *file)
+{
+	struct dead_record r;
+	char magic[8];
+	uint32_t version, count, i;
+	FILE *f;
+
+	free(c->file);
+	c->file = strdup(file);
+
+	if ((f = fopen(file, "r")) == NULL) {
+		if (errno != ENOENT)
+			warning("could not open dead frequency cache %s: %s\n",
+				file, strerror(errno));
+		return;
+	}
+	if ((fread(magic, sizeof(magic), 1, f) != 1) ||
+	    memcmp(magic, DEAD_CACHE_MAGIC, sizeof(magic)) ||
+	    (fread(&version, sizeof(version), 1, f) != 1) ||
+	    (le32toh(version) != DEAD_CACHE_VERSION) ||
+	    (fread(&count, sizeof(count), 1, f) != 1)) {
+		warning("%s: not a dead frequency cache (version %d), ignored.\n",
+			file, DEAD_CACHE_VERSION);
+		fclose(f);
+		return;
+	}
+	count = le32toh(count);
+	for (i = 0; i < count; i++) {
+		struct dead_frequency *e;
+
+		if (fread(&r, sizeof(r), 1, f) != 1) {
+			warning("%s: truncated after %u frequencies.\n", file,
+				i);
+			break;
+		}
+		if ((e = calloc(1, sizeof(*e))) == NULL)
+			fatal("out of memory\n");
+		e->frequency = le32toh(r.frequency);
+		e->source = le16toh(r.source);
+		e->delsys = r.delsys;
+		e->polarization = r.polarization;
+		e->failed = (time_t) le64toh(r.failed);
+		AddItem(c->entries, e);
+	}
+	fclose(f);
+	verbose("dead frequency cache %s: %u frequencies\n", file,
+		c->entries->count);
+}
+
+/* written to <file>.tmp and renamed, an interrupted write keeps the old one.
+ * Expired entries are dropped.
+ */
+void dead_cache_save(struct dead_cache *c)
+{
+	struct dead_frequency *e;
+	struct dead_record r;
+	time_t now = time(NULL);
+	uint32_t v, count = 0;
+	bool ok;
+	FILE *f;
+
+	if (c->file == NULL)
+		return;
+
+	char tmp[strlen(c->file) + 5];
+
+	for (e = c->entries->first; e; e = e->next)
+		if (!expired(c, e, now))
+			count++;
+
+	sprintf(tmp, "%s.tmp", c->file);
+	if ((f = fopen(tmp, "w")) == NULL) {
+		warning("could not write dead frequency cache %s: %s\n", tmp,
+			strerror(errno));
+		return;
+	}
+	ok = fwrite(DEAD_CACHE_MAGIC, 8, 1, f) == 1;
+	v = htole32(DEAD_CACHE_VERSION);
+	ok = ok && fwrite(&v, sizeof(v), 1, f) == 1;
+	v = htole32(count);
+	ok = ok && fwrite(&v, sizeof(v), 1, f) == 1;
+	for (e = c->entries->first; ok && e; e = e->next) {
+		if (expired(c, e, now))
+			continue;
+		r.frequency = htole32(e->frequency);
+		r.source = htole16(e->source);
+		r.delsys = e->delsys;
+		r.polarization = e->polarization;
+		r.failed = htole64((int64_t) e->failed);
+		ok = fwrite(&r, sizeof(r), 1, f) == 1;
+	}
+	if (fclose(f) != 0)
+		ok = false;
+	if (!ok || rename(tmp, c->file) != 0) {
+		warning("could not write dead frequency cache %s: %s\n",
+			c->file, strerror(errno));
+		unlink(tmp);
+	}
+}
+
+void dead_cache_free(struct dead_cache *c)
+{
+	if (c == NULL)
+		return;
+	ClearList(c->entries);
+	free(c->file);
+	free(c);
+}
+
+static struct dead_frequency *find(struct dead_cache *c, uint32_t frequency,
+				   uint16_t source, uint8_t delsys,
+				   uint8_t polarization, uint32_t tolerance)
+{
+	struct dead_frequency *e;
+
+	for (e = c->entries->first; e; e = e->next) {
+		if ((e->source != source) || (e->delsys != delsys)
+		    || (e->polarization != polarization))
+			continue;
+		if ((e->frequency > frequency ? e->frequency - frequency :
+		     frequency - e->frequency) < tolerance)
+			return e;
+	}
+	return NULL;
+}
+
+bool dead_cache_known(struct dead_cache *c, uint32_t frequency,
+		      uint16_t source, uint8_t delsys, uint8_t polarization,
+		      uint32_t tolerance)
+{
+	struct dead_frequency *e;
+
+	e = find(c, frequency, source, delsys, polarization, tolerance);
+	return e && !expired(c, e, time(NULL));
+}
+
+void dead_cache_add(struct dead_cache *c, uint32_t frequency,
+		    uint16_t source, uint8_t delsys, uint8_t polarization,
+		    uint32_t tolerance)
+{
+	struct dead_frequency *e;
+
+	e = find(c, frequency, source, delsys, polarization, tolerance);
+	if (e == NULL) {
+		if ((e = calloc(1, sizeof(*e))) == NULL)
+			fatal("out of memory\n");
+		e->frequency = frequency;
+		e->source = source;
+		e->delsys = delsys;
+		e->polarization = polarization;
+		AddItem(c->entries, e);
+	}
+	e->failed = time(NULL);
+}
+
+/* got lock: not dead anymore. */
+void dead_cache_forget(struct dead_cache *c, uint32_t frequency,
+		       uint16_t source, uint8_t delsys, uint8_t polarization,
+		       uint32_t tolerance)
+{
+	struct dead_frequency *e;
+
+	while ((e = find(c, frequency, source, delsys, polarization,
+			 tolerance)) != NULL)
+		UnlinkItem(c->entries, e, true);
+}
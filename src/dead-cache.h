@@ -0,0 +1,74 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __DEAD_CACHE_H__
+#define __DEAD_CACHE_H__
+
+#include <stdint.h>
+#include <time.h>
+#include "list.h"
+
+/******************************************************************************
+ * negative cache: frequencies which didnt lock, also after retrying with
+ * AUTO parameters. Keyed by frequency, polarization, delivery system and
+ * source (satellite orbital position, 0 otherwise).
+ *
+ * Always used during a scan, so that a dead frequency is tuned only once,
+ * regardless of how many NITs refer to it. Read and written by
+ * '--dead-cache <file>'; entries older than '--dead-ttl' are ignored.
+ *****************************************************************************/
+
+#define DEAD_CACHE_MAGIC    "W2DEADFQ"
+#define DEAD_CACHE_VERSION  1
+#define DEAD_CACHE_TTL      (24 * 3600)	// seconds
+
+struct dead_frequency {
+	void *prev;
+	void *next;
+	uint32_t index;
+	uint32_t frequency;
+	uint16_t source;
+	uint8_t delsys;
+	uint8_t polarization;
+	time_t failed;		// last tuning attempt without lock
+};
+
+struct dead_cache {
+	char *file;		// NULL == not saved
+	cList _entries, *entries;
+	uint32_t ttl;		// seconds, 0 == cache disabled
+};
+
+struct dead_cache *dead_cache_new(void);
+void dead_cache_load(struct dead_cache *c, const char *file);
+void dead_cache_save(struct dead_cache *c);
+void dead_cache_free(struct dead_cache *c);
+
+/* frequencies match, if they differ less than tolerance. */
+bool dead_cache_known(struct dead_cache *c, uint32_t frequency,
+		      uint16_t source, uint8_t delsys, uint8_t polarization,
+		      uint32_t tolerance);
+void dead_cache_add(struct dead_cache *c, uint32_t frequency,
+		    uint16_t source, uint8_t delsys, uint8_t polarization,
+		    uint32_t tolerance);
+void dead_cache_forget(struct dead_cache *c, uint32_t frequency,
+		       uint16_t source, uint8_t delsys, uint8_t polarization,
+		       uint32_t tolerance);
+
+#endif
@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 #include "extended_frontend.h"
 #include "si_types.h"
 #include "scan.h"
@@ -2585,31 +2586,36 @@ void parse_SH_delivery_system_descriptor(const unsigned char
 #endif
 
 static __u32 crc_table[256];
-static __u8 crc_initialized = 0;
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
 
-int crc_check(const unsigned char *buf, __u16 len)
+/* crc lookup table, once for all scan threads. */
+static void crc_init(void)
 {
 	__u16 i, j;
+	__u32 accu;
+
+	for (i = 0; i < 256; i++) {
+		accu = ((__u32) i << 24);
+		for (j = 0; j < 8; j++) {
+			if (accu & 0x80000000L)
+				accu = (accu << 1) ^ 0x04C11DB7L;	// CRC32 Polynom
+			else
+				accu = (accu << 1);
+		}
+		crc_table[i] = accu;
+	}
+}
+
+int crc_check(const unsigned char *buf, __u16 len)
+{
+	__u16 i;
 	__u32 crc = 0xffffffff;
 	__u32 transmitted_crc =
 	    buf[len - 4] << 24 | buf[len - 3] << 16 | buf[len -
 							  2] <<
 	    8 | buf[len - 1];
 
-	if (!crc_initialized) {	// initialize crc lookup table before first use.
-		__u32 accu;
-		for (i = 0; i < 256; i++) {
-			accu = ((__u32) i << 24);
-			for (j = 0; j < 8; j++) {
-				if (accu & 0x80000000L)
-					accu = (accu << 1) ^ 0x04C11DB7L;	// CRC32 Polynom
-				else
-					accu = (accu << 1);
-			}
-			crc_table[i] = accu;
-		}
-		crc_initialized = 1;
-	}
+	pthread_once(&crc_once, crc_init);
 
 	for (i = 0; i < len - 4; i++)
 		crc = (crc << 8) ^ crc_table[((crc >> 24) ^ *buf++) & 0xFF];
@@ -22,6 +22,7 @@
 #ifndef __DESCRIPTORS_H__
 #define __DESCRIPTORS_H__
 
+#include <time.h>
 #include "extended_frontend.h"
 
 /******************************************************************************
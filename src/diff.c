@@ -0,0 +1,559 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tools.h"
+#include "satellites.h"
+#include "dump-vdr.h"
+#include "diff.h"
+
+struct key {
+	uint16_t onid;
+	uint16_t tsid;
+	uint16_t sid;
+	bool matched;
+	struct transponder *t;
+	struct service *s;	// NULL for transponders
+};
+
+struct diff_counts {
+	uint32_t transponders_added;
+	uint32_t transponders_removed;
+	uint32_t transponders_changed;
+	uint32_t added;
+	uint32_t removed;
+	uint32_t moved;
+	uint32_t changed;
+};
+
+/******************************************************************************
+ * loading a channel database.
+ *****************************************************************************/
+
+static char *db_string(const struct chdb *db, uint32_t offset)
+{
+	const char *s = chdb_string(db, chdb32(offset));
+
+	return *s ? strdup(s) : NULL;
+}
+
+void diff_load(const struct chdb *db, pList list)
+{
+	struct transponder **tps, *t;
+	struct service *s;
+	uint32_t i, n;
+
+	tps = calloc(db->transponder_count + 1, sizeof(*tps));
+	if (tps == NULL)
+		fatal("out of memory\n");
+	for (i = 0; i < db->transponder_count; i++) {
+		const struct chdb_transponder *ct = &db->transponders[i];
+
+		if ((t = calloc(1, sizeof(*t))) == NULL)
+			fatal("out of memory\n");
+		init_transponder_lists(t);
+		t->type = ct->type;
+		t->frequency = chdb32(ct->frequency);
+		t->delsys = ct->delsys;
+		t->polarization = ct->polarization;
+		t->source = chdb32(ct->source);
+		t->symbolrate = chdb32(ct->symbolrate);
+		t->bandwidth = chdb32(ct->bandwidth);
+		t->modulation = ct->modulation;
+		t->coderate = ct->coderate;
+		t->coderate_LP = ct->coderate_LP;
+		t->rolloff = ct->rolloff;
+		t->pilot = ct->pilot;
+		t->inversion = ct->inversion;
+		t->input_stream_identifier = ct->input_stream_id;
+		t->guard = ct->guard;
+		t->transmission = ct->transmission;
+		t->hierarchy = ct->hierarchy;
+		t->plp_id = ct->plp_id;
+		t->system_id = chdb16(ct->system_id);
+		t->data_slice_id = ct->data_slice_id;
+		t->orbital_position = chdb16(ct->orbital_position);
+		t->west_east_flag = ct->west_east_flag;
+		t->original_network_id = chdb16(ct->original_network_id);
+		t->network_id = chdb16(ct->network_id);
+		t->transport_stream_id = chdb16(ct->transport_stream_id);
+		t->network_name = db_string(db, ct->network_name);
+		AddItem(list, t);
+		tps[i] = t;
+	}
+
+	// the db keeps the first audio, ac3 and CA entry only.
+	for (i = 0; i < db->service_count; i++) {
+		const struct chdb_service *cs = &db->services[i];
+
+		if ((n = chdb32(cs->transponder)) >= db->transponder_count)
+			continue;
+		if ((s = calloc(1, sizeof(*s))) == NULL)
+			fatal("out of memory\n");
+		s->transponder = tps[n];
+		s->transport_stream_id = chdb16(cs->transport_stream_id);
+		s->service_id = chdb16(cs->service_id);
+		s->service_name = db_string(db, cs->name);
+		s->provider_name = db_string(db, cs->provider);
+		s->logical_channel_number = chdb32(cs->logical_channel_number);
+		s->pmt_pid = chdb16(cs->pmt_pid);
+		s->pcr_pid = chdb16(cs->pcr_pid);
+		s->video_pid = chdb16(cs->video_pid);
+		s->video_stream_type = cs->video_stream_type;
+		s->teletext_pid = chdb16(cs->teletext_pid);
+		s->scrambled = cs->scrambled;
+		if (cs->audio_num) {
+			s->audio_pid[0] = chdb16(cs->audio_pid);
+			memcpy(s->audio_lang[0], cs->audio_lang, 3);
+			s->audio_num = 1;
+		}
+		if (cs->ac3_num) {
+			s->ac3_pid[0] = chdb16(cs->ac3_pid);
+			memcpy(s->ac3_lang[0], cs->ac3_lang, 3);
+			s->ac3_num = 1;
+		}
+		if (cs->ca_id) {
+			s->ca_id[0] = chdb16(cs->ca_id);
+			s->ca_num = 1;
+		}
+		AddItem(tps[n]->services, s);
+	}
+	free(tps);
+}
+
+void diff_free(pList list)
+{
+	struct transponder *t;
+	struct service *s;
+
+	for (t = list->first; t; t = t->next) {
+		for (s = t->services->first; s; s = s->next) {
+			free(s->provider_name);
+			free(s->service_name);
+		}
+		ClearList(t->services);
+		ClearList(t->cells);
+		free(t->network_name);
+	}
+	ClearList(list);
+}
+
+/******************************************************************************
+ * sorted keys.
+ *****************************************************************************/
+
+static int cmp_key(const void *p1, const void *p2)
+{
+	const struct key *a = p1, *b = p2;
+
+	if (a->onid != b->onid)
+		return a->onid < b->onid ? -1 : 1;
+	if (a->tsid != b->tsid)
+		return a->tsid < b->tsid ? -1 : 1;
+	if (a->sid != b->sid)
+		return a->sid < b->sid ? -1 : 1;
+	return 0;
+}
+
+/* sort order: cmp_key(), duplicates (i.e. same ids on several satellites or
+ * simulcasts) by polarization and frequency.
+ */
+static int cmp_sort(const void *p1, const void *p2)
+{
+	const struct key *a = p1, *b = p2;
+	int cmp = cmp_key(a, b);
+
+	if (cmp)
+		return cmp;
+	if (a->t->polarization != b->t->polarization)
+		return a->t->polarization < b->t->polarization ? -1 : 1;
+	if (a->t->frequency != b->t->frequency)
+		return a->t->frequency < b->t->frequency ? -1 : 1;
+	return 0;
+}
+
+/* services ? all wanted services : all transponders. */
+static struct key *keys(pList list, bool services,
+			bool (*want) (struct service *), size_t * count)
+{
+	struct transponder *t;
+	struct service *s;
+	struct key *k;
+	size_t n = 0;
+
+	for (t = list->first; t; t = t->next)
+		n += services ? t->services->count : 1;
+	if ((k = calloc(n + 1, sizeof(*k))) == NULL)
+		fatal("out of memory\n");
+	n = 0;
+	for (t = list->first; t; t = t->next) {
+		if (!services) {
+			k[n].onid = t->original_network_id;
+			k[n].tsid = t->transport_stream_id;
+			k[n++].t = t;
+			continue;
+		}
+		for (s = t->services->first; s; s = s->next) {
+			if (want && !want(s))
+				continue;
+			k[n].onid = t->original_network_id;
+			k[n].tsid = t->transport_stream_id;
+			k[n].sid = s->service_id;
+			k[n].t = t;
+			k[n++].s = s;
+		}
+	}
+	qsort(k, n, sizeof(*k), cmp_sort);
+	*count = n;
+	return k;
+}
+
+/******************************************************************************
+ * JSON output. The field functions print "key":[before,now] if different
+ * and return the number of differences so far; with f == NULL they count.
+ *****************************************************************************/
+
+static void json_string(FILE * f, const char *s)
+{
+	fputc('"', f);
+	for (; s && *s; s++) {
+		unsigned char c = *s;
+		if ((c == '"') || (c == '\\'))
+			fprintf(f, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(f, "\\u%04x", c);
+		else
+			fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+static int field_u(FILE * f, int n, const char *key, unsigned a, unsigned b)
+{
+	if (a == b)
+		return n;
+	if (f)
+		fprintf(f, "%s\"%s\":[%u,%u]", n ? "," : "", key, a, b);
+	return n + 1;
+}
+
+static int field_s(FILE * f, int n, const char *key, const char *a,
+		   const char *b)
+{
+	if (!strcmp(a ? a : "", b ? b : ""))
+		return n;
+	if (f) {
+		fprintf(f, "%s\"%s\":[", n ? "," : "", key);
+		json_string(f, a);
+		fputc(',', f);
+		json_string(f, b);
+		fputc(']', f);
+	}
+	return n + 1;
+}
+
+#define FIRST(s, field, num) ((s)->num ? (s)->field[0] : 0)
+#define FIRST_LANG(s, field, num) ((s)->num ? (s)->field[0] : "")
+
+static int service_fields(FILE * f, struct service *a, struct service *b)
+{
+	int n = 0;
+
+	n = field_s(f, n, "name", a->service_name, b->service_name);
+	n = field_s(f, n, "provider", a->provider_name, b->provider_name);
+	n = field_u(f, n, "lcn", a->logical_channel_number,
+		    b->logical_channel_number);
+	n = field_u(f, n, "pmt_pid", a->pmt_pid, b->pmt_pid);
+	n = field_u(f, n, "pcr_pid", a->pcr_pid, b->pcr_pid);
+	n = field_u(f, n, "video_pid", a->video_pid, b->video_pid);
+	n = field_u(f, n, "audio_pid", FIRST(a, audio_pid, audio_num),
+		    FIRST(b, audio_pid, audio_num));
+	n = field_s(f, n, "audio_lang", FIRST_LANG(a, audio_lang, audio_num),
+		    FIRST_LANG(b, audio_lang, audio_num));
+	n = field_u(f, n, "ac3_pid", FIRST(a, ac3_pid, ac3_num),
+		    FIRST(b, ac3_pid, ac3_num));
+	n = field_s(f, n, "ac3_lang", FIRST_LANG(a, ac3_lang, ac3_num),
+		    FIRST_LANG(b, ac3_lang, ac3_num));
+	n = field_u(f, n, "teletext_pid", a->teletext_pid, b->teletext_pid);
+	n = field_u(f, n, "ca_id", FIRST(a, ca_id, ca_num),
+		    FIRST(b, ca_id, ca_num));
+	n = field_u(f, n, "scrambled", a->scrambled, b->scrambled);
+	return n;
+}
+
+static int transponder_fields(FILE * f, struct transponder *a,
+			      struct transponder *b)
+{
+	int n = 0;
+
+	n = field_u(f, n, "frequency", a->frequency, b->frequency);
+	n = field_u(f, n, "polarization", a->polarization, b->polarization);
+	n = field_u(f, n, "delsys", a->delsys, b->delsys);
+	n = field_u(f, n, "symbolrate", a->symbolrate, b->symbolrate);
+	n = field_u(f, n, "bandwidth", a->bandwidth, b->bandwidth);
+	n = field_u(f, n, "modulation", a->modulation, b->modulation);
+	n = field_u(f, n, "coderate", a->coderate, b->coderate);
+	n = field_u(f, n, "rolloff", a->rolloff, b->rolloff);
+	n = field_u(f, n, "plp_id", a->plp_id, b->plp_id);
+	n = field_u(f, n, "input_stream_id", a->input_stream_identifier,
+		    b->input_stream_identifier);
+	return n;
+}
+
+/* opens an object, the caller adds fields and "}\n". */
+static void change(FILE * f, const char *name, const struct key *k)
+{
+	fprintf(f, "{\"change\":\"%s\",\"onid\":%u,\"tsid\":%u", name,
+		k->onid, k->tsid);
+	if (k->s) {
+		fprintf(f, ",\"sid\":%u,\"name\":", k->sid);
+		json_string(f, k->s->service_name);
+	}
+	fprintf(f, ",\"frequency\":%u", k->t->frequency);
+}
+
+/******************************************************************************
+ * VDR output of services which are new or changed.
+ *****************************************************************************/
+
+static void vdr_service(struct output_buffer *vdr, const struct key *k,
+			const struct w_scan_flags *flags)
+{
+	struct w_scan_flags fl = *flags;
+	char sn[20];
+	int i;
+
+	if (vdr == NULL)
+		return;
+	if (!k->s->service_name) {	// same as dump_transponder()
+		snprintf(sn, sizeof(sn), "service_id %d", k->s->service_id);
+		k->s->service_name = strdup(sn);
+	}
+	fl.scantype = k->t->type;
+	if ((fl.scantype == SCAN_SATELLITE) && k->t->orbital_position) {
+		for (i = 0; i < sat_count(); i++)
+			if ((sat_list[i].orbital_position ==
+			     k->t->orbital_position)
+			    && (sat_list[i].west_east_flag ==
+				k->t->west_east_flag)) {
+				fl.list_id = sat_list[i].id;
+				break;
+			}
+	}
+	vdr_dump_service_parameter_set(vdr, k->s, k->t, &fl);
+}
+
+/******************************************************************************
+ * the diff.
+ *****************************************************************************/
+
+/* same polarization first, then nearest frequency. */
+static uint64_t tp_distance(struct transponder *a, struct transponder *b)
+{
+	uint64_t d = a->frequency > b->frequency ?
+	    a->frequency - b->frequency : b->frequency - a->frequency;
+
+	if (a->polarization != b->polarization)
+		d += 1ULL << 32;
+	return d;
+}
+
+/* all keys of a and b have the same (onid, tsid): the closest transponders
+ * are paired, the others are removed or added.
+ */
+static void pair_transponders(struct key *a, size_t na, struct key *b,
+			      size_t nb, FILE * f, struct diff_counts *c)
+{
+	size_t i, j, bi, bj;
+	uint64_t d, best;
+
+	for (;;) {
+		best = UINT64_MAX;
+		bi = bj = 0;
+		for (i = 0; i < na; i++) {
+			if (a[i].matched)
+				continue;
+			for (j = 0; j < nb; j++) {
+				if (b[j].matched)
+					continue;
+				d = tp_distance(a[i].t, b[j].t);
+				if (d < best) {
+					best = d;
+					bi = i;
+					bj = j;
+				}
+			}
+		}
+		if (best == UINT64_MAX)
+			break;
+		a[bi].matched = b[bj].matched = true;
+		if (transponder_fields(NULL, a[bi].t, b[bj].t)) {
+			change(f, "transponder_changed", &b[bj]);
+			fprintf(f, ",\"fields\":{");
+			transponder_fields(f, a[bi].t, b[bj].t);
+			fprintf(f, "}}\n");
+			c->transponders_changed++;
+		}
+	}
+	for (i = 0; i < na; i++) {
+		if (a[i].matched)
+			continue;
+		change(f, "transponder_removed", &a[i]);
+		fprintf(f, "}\n");
+		c->transponders_removed++;
+	}
+	for (j = 0; j < nb; j++) {
+		if (b[j].matched)
+			continue;
+		change(f, "transponder_added", &b[j]);
+		fprintf(f, "}\n");
+		c->transponders_added++;
+	}
+}
+
+static void diff_transponders(pList before, pList now, FILE * f,
+			      struct diff_counts *c)
+{
+	struct key *a, *b;
+	size_t na, nb, i = 0, j = 0, ei, ej;
+	int cmp;
+
+	a = keys(before, false, NULL, &na);
+	b = keys(now, false, NULL, &nb);
+	while ((i < na) || (j < nb)) {
+		if (i == na)
+			cmp = 1;
+		else if (j == nb)
+			cmp = -1;
+		else
+			cmp = cmp_key(&a[i], &b[j]);
+		if (cmp < 0) {
+			pair_transponders(&a[i++], 1, NULL, 0, f, c);
+		} else if (cmp > 0) {
+			pair_transponders(NULL, 0, &b[j++], 1, f, c);
+		} else {
+			for (ei = i; (ei < na) && !cmp_key(&a[ei], &a[i]); ei++) ;
+			for (ej = j; (ej < nb) && !cmp_key(&b[ej], &b[j]); ej++) ;
+			pair_transponders(&a[i], ei - i, &b[j], ej - j, f, c);
+			i = ei;
+			j = ej;
+		}
+	}
+	free(a);
+	free(b);
+}
+
+static void diff_services(pList before, pList now,
+			  bool (*want) (struct service *), FILE * f,
+			  struct output_buffer *vdr,
+			  const struct w_scan_flags *flags,
+			  struct diff_counts *c)
+{
+	struct key *a, *b;
+	size_t na, nb, i = 0, j = 0;
+	int cmp;
+
+	a = keys(before, true, NULL, &na);
+	b = keys(now, true, want, &nb);
+	while ((i < na) && (j < nb)) {
+		cmp = cmp_key(&a[i], &b[j]);
+		if (cmp < 0)
+			i++;
+		else if (cmp > 0)
+			j++;
+		else {
+			a[i].matched = b[j].matched = true;
+			if (service_fields(NULL, a[i].s, b[j].s)) {
+				change(f, "service_changed", &b[j]);
+				fprintf(f, ",\"fields\":{");
+				service_fields(f, a[i].s, b[j].s);
+				fprintf(f, "}}\n");
+				vdr_service(vdr, &b[j], flags);
+				c->changed++;
+			} else if (transponder_fields(NULL, a[i].t, b[j].t))
+				vdr_service(vdr, &b[j], flags);	// new tuning
+			i++;
+			j++;
+		}
+	}
+
+	// same (onid, sid) in another transport stream.
+	for (i = 0; i < na; i++) {
+		if (a[i].matched)
+			continue;
+		for (j = 0; j < nb; j++) {
+			if (b[j].matched || (b[j].onid != a[i].onid)
+			    || (b[j].sid != a[i].sid))
+				continue;
+			a[i].matched = b[j].matched = true;
+			change(f, "service_moved", &b[j]);
+			fprintf(f, ",\"from\":{\"tsid\":%u,\"frequency\":%u}",
+				a[i].tsid, a[i].t->frequency);
+			if (service_fields(NULL, a[i].s, b[j].s)) {
+				fprintf(f, ",\"fields\":{");
+				service_fields(f, a[i].s, b[j].s);
+				fprintf(f, "}");
+			}
+			fprintf(f, "}\n");
+			vdr_service(vdr, &b[j], flags);
+			c->moved++;
+			break;
+		}
+	}
+
+	for (i = 0; i < na; i++) {
+		if (a[i].matched)
+			continue;
+		change(f, "service_removed", &a[i]);
+		fprintf(f, "}\n");
+		c->removed++;
+	}
+	for (j = 0; j < nb; j++) {
+		if (b[j].matched)
+			continue;
+		change(f, "service_added", &b[j]);
+		fprintf(f, "}\n");
+		vdr_service(vdr, &b[j], flags);
+		c->added++;
+	}
+	free(a);
+	free(b);
+}
+
+uint32_t diff_results(pList before, pList now, bool (*want) (struct service *),
+		      FILE * json, struct output_buffer *vdr,
+		      const struct w_scan_flags *flags)
+{
+	struct diff_counts c;
+
+	memset(&c, 0, sizeof(c));
+	diff_transponders(before, now, json, &c);
+	diff_services(before, now, want, json, vdr, flags, &c);
+	fprintf(json, "{\"change\":\"summary\",\"transponders_added\":%u,"
+		"\"transponders_removed\":%u,\"transponders_changed\":%u,"
+		"\"services_added\":%u,\"services_removed\":%u,"
+		"\"services_moved\":%u,\"services_changed\":%u}\n",
+		c.transponders_added, c.transponders_removed,
+		c.transponders_changed, c.added, c.removed, c.moved, c.changed);
+	fflush(json);
+	return c.transponders_added + c.transponders_removed +
+	    c.transponders_changed + c.added + c.removed + c.moved + c.changed;
+}
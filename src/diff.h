@@ -0,0 +1,55 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __DIFF_H__
+#define __DIFF_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "scan.h"
+#include "si_types.h"
+#include "chdb.h"
+#include "output-buffer.h"
+
+/******************************************************************************
+ * differences between two scan results, '--diff <file>' and
+ * 'w_scan2-db <file> diff <file>'.
+ *
+ * Services are matched by (onid, tsid, sid), transponders by (onid, tsid).
+ * A service which left one transport stream and shows up with the same
+ * (onid, sid) in another one is 'moved'. Only the fields which the channel
+ * database holds are compared, so that a live result and a loaded one give
+ * the same answer.
+ *
+ * One JSON object per change and a summary line, optionally all added,
+ * moved and changed services in VDR format.
+ *****************************************************************************/
+
+/* appends the transponders and services of db to list. */
+void diff_load(const struct chdb *db, pList list);
+void diff_free(pList list);
+
+/* want selects services of 'now' (NULL: all). vdr may be NULL.
+ * Returns the number of changes.
+ */
+uint32_t diff_results(pList before, pList now, bool (*want) (struct service *),
+		      FILE * json, struct output_buffer *vdr,
+		      const struct w_scan_flags *flags);
+
+#endif
@@ -2,9 +2,12 @@
  */
 
 #include <sys/ioctl.h>
+#include <sys/file.h>
+#include <fcntl.h>
 #include <time.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
 #include "extended_frontend.h"
 #include "scan.h"
 #include "satellites.h"
@@ -204,7 +207,41 @@ struct diseqc_cmd uncommitted_switch_cmds[] = {
 #define ROTOR_CMD_GOTO_ANGLE            12
 #define ROTOR_CMD_WR_COMMITTED          13
 
-int diseqc_2_x_error = 0;	// do 2.x cmds only once.
+static __thread struct diseqc_context *dc = NULL;	// see diseqc_context_use()
+
+/******************************************************************************
+ * last state sent to LNB, DiSEqC switches and SCR. Used to skip tone, voltage
+ * and DiSEqC sequences which would not change anything. -1 == unknown.
+ * One per thread, as each scan thread drives its own frontend.
+ ******************************************************************************/
+static __thread struct {
+	int voltage_18;
+	int hiband;
+	int committed;
+	int uncommitted;
+	int scr_msg_len;
+	uint8_t scr_msg[6];
+} sec_state = { -1, -1, -1, -1, -1, {0} };
+typedef char sec_state_fits[(sizeof(sec_state) <= SEC_STATE_SIZE) ? 1 : -1];
+
+void sec_state_invalidate(void)
+{
+	sec_state.voltage_18 = -1;
+	sec_state.hiband = -1;
+	sec_state.committed = -1;
+	sec_state.uncommitted = -1;
+	sec_state.scr_msg_len = -1;
+}
+
+void sec_state_export(uint8_t *buf)
+{
+	memcpy(buf, &sec_state, sizeof(sec_state));
+}
+
+void sec_state_import(const uint8_t *buf)
+{
+	memcpy(&sec_state, buf, sizeof(sec_state));
+}
 
 /*****************************************************************************/
 
@@ -249,7 +286,7 @@ static inline void msleep(uint32_t msec)
 
 static float hex_to_float(const int bin_val)
 {
-	int b0 = (bin_val & 0xFF00);
+	int b0 = (bin_val >> 8) & 0xFF;
 	int b1 = (bin_val & 0x00FF);
 
 	return (float)(((b0 >> 4) & 0x0f) * 1000 + (b0 & 0x0f) * 100 +
@@ -278,6 +315,56 @@ float rotor_angle(uint16_t channellist)
 			10);
 }
 
+/******************************************************************************
+ * angle on the clarke belt, east positive, west negative (-180° .. 180°)
+ *
+ ******************************************************************************/
+
+static float rotor_arc_angle(uint16_t channellist)
+{
+	float angle = rotor_angle(channellist);
+	return angle > 180 ? angle - 360 : angle;
+}
+
+/******************************************************************************
+ * a rotor moves along the arc, so the shortest path visiting all satellites
+ * is a single sweep from the arc end nearest to the start position.
+ *
+ ******************************************************************************/
+
+void rotor_order_satellites(int *channellists, int count, int from)
+{
+	int i, j, tmp;
+	float start, east, west;
+
+	for (i = 1; i < count; i++) {
+		tmp = channellists[i];
+		for (j = i;
+		     j > 0
+		     && rotor_arc_angle(channellists[j - 1]) >
+		     rotor_arc_angle(tmp); j--)
+			channellists[j] = channellists[j - 1];
+		channellists[j] = tmp;
+	}
+
+	// unknown position, rotate_rotor() assumes the worst case of 180deg:
+	// sweep from west to east.
+	i = from < 1 ? -1 : rotor_position_to_sat_list_index(from);
+	if ((i < 0) || (count < 2))
+		return;
+
+	start = rotor_arc_angle(i);
+	west = rotor_arc_angle(channellists[0]) - start;
+	east = rotor_arc_angle(channellists[count - 1]) - start;
+	if (east * east < west * west) {
+		for (i = 0, j = count - 1; i < j; i++, j--) {
+			tmp = channellists[i];
+			channellists[i] = channellists[j];
+			channellists[j] = tmp;
+		}
+	}
+}
+
 /******************************************************************************
  * positioning status bits, see "3.11. Read Positioner Status Byte (Level 2.2)"
  *
@@ -346,9 +433,116 @@ int get_positioner_status(int frontend_fd, int *data)
 #define speed_13V       1.5	//degrees per second
 #define speed_18V       2.4	//degrees per second
 
+/******************************************************************************
+ * rotor motion model: t = t0 + angle / speed
+ *
+ * fitted by least squares over all moves timed by DiSEqC-2.2 positioner
+ * status. t0 covers motor start, acceleration and braking; for a trapezoidal
+ * velocity profile t0 == speed / acceleration. Sums are kept in a file, so
+ * the model improves with every run. Kept in struct diseqc_context.
+ ******************************************************************************/
+
+static void rotor_model_fit(void)
+{
+	double n = dc->rotor_model.moves;
+	double d = n * dc->rotor_model.sum_aa - dc->rotor_model.sum_a * dc->rotor_model.sum_a;
+	double slope, t0;
+
+	if ((n < 1) || (dc->rotor_model.sum_a <= 0) || (dc->rotor_model.sum_t <= 0))
+		return;
+
+	if ((n > 1) && (d > n * n)) {	// need moves of different length.
+		slope = (n * dc->rotor_model.sum_at -
+			 dc->rotor_model.sum_a * dc->rotor_model.sum_t) / d;
+		t0 = (dc->rotor_model.sum_t - slope * dc->rotor_model.sum_a) / n;
+		if ((slope > 0) && (t0 >= 0)) {
+			dc->rotor_model.speed = 1 / slope;
+			dc->rotor_model.t0 = t0;
+			return;
+		}
+	}
+	dc->rotor_model.speed = dc->rotor_model.sum_a / dc->rotor_model.sum_t;
+	dc->rotor_model.t0 = 0;
+}
+
+static void rotor_model_save(void)
+{
+	FILE *f;
+
+	if (dc->rotor_model.file == NULL)
+		return;
+	if ((f = fopen(dc->rotor_model.file, "w")) == NULL) {
+		warning("could not write rotor model %s\n", dc->rotor_model.file);
+		return;
+	}
+	fprintf(f, "# w_scan2 rotor motion model: t = t0 + angle / speed\n");
+	fprintf(f, "speed %.4f\n", dc->rotor_model.speed);
+	fprintf(f, "t0 %.4f\n", dc->rotor_model.t0);
+	fprintf(f, "moves %u\n", dc->rotor_model.moves);
+	fprintf(f, "sum_a %.4f\n", dc->rotor_model.sum_a);
+	fprintf(f, "sum_t %.4f\n", dc->rotor_model.sum_t);
+	fprintf(f, "sum_aa %.4f\n", dc->rotor_model.sum_aa);
+	fprintf(f, "sum_at %.4f\n", dc->rotor_model.sum_at);
+	fclose(f);
+}
+
+int rotor_model_load(const char *file)
+{
+	FILE *f;
+	char buf[128], key[32];
+	double val;
+
+	free(dc->rotor_model.file);
+	dc->rotor_model.file = strdup(file);
+
+	if ((f = fopen(file, "r")) == NULL) {
+		info("rotor model %s not found, will be created.\n", file);
+		return 0;
+	}
+	while (fgets(buf, sizeof(buf), f) != NULL) {
+		if (sscanf(buf, "%31s %lf", key, &val) != 2)
+			continue;
+		if (!strcmp(key, "moves"))
+			dc->rotor_model.moves = val;
+		else if (!strcmp(key, "sum_a"))
+			dc->rotor_model.sum_a = val;
+		else if (!strcmp(key, "sum_t"))
+			dc->rotor_model.sum_t = val;
+		else if (!strcmp(key, "sum_aa"))
+			dc->rotor_model.sum_aa = val;
+		else if (!strcmp(key, "sum_at"))
+			dc->rotor_model.sum_at = val;
+	}
+	fclose(f);
+	rotor_model_fit();
+	info("rotor model: %.2fdeg/sec, %.2fsec start/stop (%u moves)\n",
+	     dc->rotor_model.speed, dc->rotor_model.t0, dc->rotor_model.moves);
+	return 0;
+}
+
+static void rotor_model_add(float angle, double seconds)
+{
+	if ((angle < 1) || (seconds <= 0))
+		return;		// too short to say anything.
+	dc->rotor_model.moves++;
+	dc->rotor_model.sum_a += angle;
+	dc->rotor_model.sum_t += seconds;
+	dc->rotor_model.sum_aa += angle * angle;
+	dc->rotor_model.sum_at += angle * seconds;
+	rotor_model_fit();
+	verbose("rotor model: %.2fdeg in %.2fsec -> %.2fdeg/sec, %.2fsec start/stop\n",
+		angle, seconds, dc->rotor_model.speed, dc->rotor_model.t0);
+	rotor_model_save();
+}
+
+static float rotor_model_predict(float angle)
+{
+	return dc->rotor_model.t0 + angle / dc->rotor_model.speed;
+}
+
 /******************************************************************************
  * Rotate a DiSEqC 1.2 rotor from position 'from_rotor_pos' to position 'to_rotor_pos',
- * from and to are assigned to sat_list[channellist].rotor_position
+ * from and to are assigned by set_sat_rotor_position()
  ******************************************************************************/
 
 extern int rotate_rotor(int frontend_fd, int *from, int to, uint8_t voltage_18,
@@ -361,31 +555,35 @@ extern int rotate_rotor(int frontend_fd, int *from, int to, uint8_t voltage_18,
 
 	//convert rotor position to sat_list index
 	to_satlist_index = rotor_position_to_sat_list_index(to);
+	if (to_satlist_index < 0)
+		to_satlist_index = 0;	// not in sat_list, only used for messages.
+	from_satlist_index = -1;
+	if (*from > -1)
+		from_satlist_index = rotor_position_to_sat_list_index(*from);
 
 	if (to > -1) {
 		if (*from != to) {
-			if (*from < 0) {
+			if (from_satlist_index < 0) {
 				/* starting from unknown position, therefore
 				 * assuming worst case: 180°
 				 * diseqc-2.2 rotor should stop earlier
 				 */
 				rotation_angle = 180;
-				info("Initializing rotor to %s (rotor position %d)\n", satellite_to_short_name(to_satlist_index), sat_list[to_satlist_index].rotor_position);
+				info("Initializing rotor to %s (rotor position %d)\n", satellite_to_short_name(to_satlist_index), sat_rotor_position(to_satlist_index));
 			} else {
-				//convert rotor position to sat_list index
-				from_satlist_index =
-				    rotor_position_to_sat_list_index(*from);
-
-				info("moving rotor from %s (rotor position %d) to %s (rotor position %d)\n", satellite_to_short_name(from_satlist_index), sat_list[from_satlist_index].rotor_position, satellite_to_short_name(to_satlist_index), sat_list[to_satlist_index].rotor_position);
+				info("moving rotor from %s (rotor position %d) to %s (rotor position %d)\n", satellite_to_short_name(from_satlist_index), sat_rotor_position(from_satlist_index), satellite_to_short_name(to_satlist_index), sat_rotor_position(to_satlist_index));
 
 				rotation_angle =
-				    abs(rotor_angle(to_satlist_index) -
-					rotor_angle(from_satlist_index));
+				    rotor_angle(to_satlist_index) -
+				    rotor_angle(from_satlist_index);
+				if (rotation_angle < 0)
+					rotation_angle = -rotation_angle;
 				if (rotation_angle > 180)
 					rotation_angle = 360.0 - rotation_angle;
 			}
 
-			rotor_positioning_time = rotation_angle / speed_18V;
+			rotor_positioning_time =
+			    rotor_model_predict(rotation_angle);
 			info("expected rotation %.2fdeg (%.1f sec)\n",
 			     rotation_angle, rotor_positioning_time);
 			//switch tone off
@@ -410,38 +608,65 @@ extern int rotate_rotor(int frontend_fd, int *from, int to, uint8_t voltage_18,
 				     __FUNCTION__);
 				return -1;
 			} else {
-				int i, status;
+				int status, seconds = -1, completed = 0, stopped = 0;
+				struct timespec start, now;
+				double t = 0, limit = rotor_positioning_time;
+
+				/* with positioner status, wait up to 50% longer
+				 * than predicted: the model may be off. But not
+				 * longer than the fixed estimate for 180deg.
+				 */
+				if (dc->diseqc_2_x_error == 0) {
+					limit = 1.5 * rotor_positioning_time + 5;
+					if (limit > 180 / speed_18V)
+						limit = 180 / speed_18V;
+					if (limit < rotor_positioning_time)
+						limit = rotor_positioning_time;
+				}
+				get_time(&start);
 				info("Rotating");
-				for (i = 0;
-				     i < (int)(rotor_positioning_time + 0.5);
-				     i++) {
-					if ((i % 32) == 0)
-						info("\n\t");
-					if (diseqc_2_x_error == 0) {
-						usleep(1000000 - 82500);
-						if (!
-						    (diseqc_2_x_error =
-						     get_positioner_status
-						     (frontend_fd, &status))) {
-							if (status &
-							    MOVEMENT_COMPLETE)
-								break;
-							if (status &
-							    HARD_LIMIT_REACHED)
-								break;
-							if ((status &
-							     MOTOR_RUNNING) !=
-							    MOTOR_RUNNING)
-								break;
-						}
-					} else
-						usleep(1000000);
-					info("%d ",
-					     (int)rotor_positioning_time - i);
+				while (t < limit) {
+					/* coarse steps first, 100msec polling
+					 * from 1sec + 10% before the predicted end.
+					 */
+					if (t < rotor_positioning_time * 0.9 - 1)
+						msleep(dc->diseqc_2_x_error ? 1000 : 1000 - 82);
+					else
+						msleep(100);
+					if ((dc->diseqc_2_x_error == 0) &&
+					    !(dc->diseqc_2_x_error =
+					      get_positioner_status(frontend_fd,
+								    &status))) {
+						// only complete moves are timed.
+						if (status & MOVEMENT_COMPLETE)
+							completed = 1;
+						else if ((status & HARD_LIMIT_REACHED)
+							 || ((status & MOTOR_RUNNING) !=
+							     MOTOR_RUNNING))
+							stopped = 1;
+					}
+					get_time(&now);
+					t = elapsed(&start, &now);
+					if (completed || stopped)
+						break;
+					if (dc->diseqc_2_x_error)
+						limit = rotor_positioning_time;
+					if ((int)t != seconds) {
+						seconds = t;
+						if ((seconds % 32) == 0)
+							info("\n\t");
+						info("%d ", (int)(limit - t + 0.5));
+					}
 				}
-				info(" completed.\n");
+				info(" %s (%.1f sec).\n",
+				     stopped ? "stopped" : "completed", t);
+				// unknown start position: 180 degrees is a guess, not measured.
+				if (completed && (from_satlist_index >= 0))
+					rotor_model_add(rotation_angle, t);
 			}
 			*from = to;
+			// tone and voltage were touched, resend switch cmds on next tune.
+			sec_state_invalidate();
 		}
 		// correct tone and voltage
 		if (ioctl
@@ -514,6 +739,17 @@ int setup_switch(int frontend_fd, int switch_pos, int voltage_18, int hiband,
 	int err;
 	struct diseqc_cmd *cmd[2] = { NULL, NULL };
 
+	voltage_18 = voltage_18 ? 1 : 0;
+	hiband = hiband ? 1 : 0;
+
+	if ((sec_state.voltage_18 == voltage_18)
+	    && (sec_state.hiband == hiband)
+	    && (sec_state.committed == switch_pos)
+	    && (sec_state.uncommitted == uncommitted_switch_pos)) {
+		verbose("DiSEqC: switch unchanged, skipped.\n");
+		return 1;
+	}
+
 	i = uncommitted_switch_pos;
 
 	verbose("DiSEqC: uncommitted switch pos %i\n", uncommitted_switch_pos);
@@ -522,17 +758,22 @@ int setup_switch(int frontend_fd, int switch_pos, int voltage_18, int hiband,
 	    (int)(sizeof(uncommitted_switch_cmds) / sizeof(struct diseqc_cmd)))
 		return -EINVAL;
 
-	cmd[0] = &uncommitted_switch_cmds[i];
+	if (sec_state.uncommitted != uncommitted_switch_pos) {
+		cmd[0] = &uncommitted_switch_cmds[i];
 
-	if ((err = diseqc_send_msg(frontend_fd,
-				   voltage_18 ? SEC_VOLTAGE_18 : SEC_VOLTAGE_13,
-				   cmd,
-				   hiband ? SEC_TONE_ON : SEC_TONE_OFF,
-				   switch_pos % 2 ? SEC_MINI_B : SEC_MINI_A))) {
-		return err;
+		if ((err = diseqc_send_msg(frontend_fd,
+					   voltage_18 ? SEC_VOLTAGE_18 :
+					   SEC_VOLTAGE_13, cmd,
+					   hiband ? SEC_TONE_ON : SEC_TONE_OFF,
+					   switch_pos %
+					   2 ? SEC_MINI_B : SEC_MINI_A))) {
+			sec_state_invalidate();
+			return err;
+		}
+		sec_state.uncommitted = uncommitted_switch_pos;
 	}
 
-	i = 4 * switch_pos + 2 * hiband + (voltage_18 ? 1 : 0);
+	i = 4 * switch_pos + 2 * hiband + voltage_18;
 
 	verbose("DiSEqC: switch pos %i, %sV, %sband (index %d)\n",
 		switch_pos, voltage_18 ? "18" : "13", hiband ? "hi" : "lo", i);
@@ -550,12 +791,74 @@ int setup_switch(int frontend_fd, int switch_pos, int voltage_18, int hiband,
 			      hiband ? SEC_TONE_ON : SEC_TONE_OFF,
 			      switch_pos % 2 ? SEC_MINI_B : SEC_MINI_A);
 
-	return err;
+	if (err) {
+		sec_state_invalidate();
+		return err;
+	}
+	sec_state.voltage_18 = voltage_18;
+	sec_state.hiband = hiband;
+	sec_state.committed = switch_pos;
+	sec_state.scr_msg_len = -1;
+	return 0;
 }
 
 //------------------------------------------------------------------------------
 #define ROUND(x) ( 0.5 + x )
 
+/******************************************************************************
+ * SCR bus arbitration.
+ *
+ * All receivers on one SCR cable share the DiSEqC bus, a command sent while
+ * another receiver is sending gets lost. Receivers run by w_scan2 serialize
+ * by a lock file; if the bus is busy, back off for a random time (EN50494)
+ * instead of queueing up in lock step. A lock held for longer, i.e. by a
+ * hanging process, is ignored: the command is sent without arbitration.
+ ******************************************************************************/
+
+#define SCR_LOCKDIR  "/run/lock"
+#define SCR_LOCKFILE "w_scan2-scr.lock"
+
+/* true, if the lock was taken and has to be released by scr_bus_unlock(). */
+static bool scr_bus_lock(void)
+{
+	int attempt;
+
+	if (dc->scr_lock_pid != getpid()) {
+		// first call or fork()ed: flock() needs an open file of our own.
+		if (dc->scr_lock_fd >= 0)
+			close(dc->scr_lock_fd);
+		// never follow a symlink placed into a world writable directory.
+		if (access(SCR_LOCKDIR, W_OK) == 0)
+			dc->scr_lock_fd = open(SCR_LOCKDIR "/" SCR_LOCKFILE,
+					       O_RDWR | O_CREAT | O_NOFOLLOW |
+					       O_CLOEXEC, 0600);
+		else
+			dc->scr_lock_fd = open("/tmp/" SCR_LOCKFILE,
+					       O_RDWR | O_CREAT | O_NOFOLLOW |
+					       O_CLOEXEC, 0600);
+		dc->scr_lock_pid = getpid();
+		srand(dc->scr_lock_pid ^ time(NULL));
+	}
+	if (dc->scr_lock_fd < 0)
+		return false;	// no arbitration possible, just send.
+
+	for (attempt = 1; flock(dc->scr_lock_fd, LOCK_EX | LOCK_NB) < 0;
+	     attempt++) {
+		if (attempt > 8) {	// about 2sec, far more than one command.
+			warning("SCR bus lock busy, sending without arbitration\n");
+			return false;
+		}
+		msleep(20 + rand() % (50 * attempt));
+	}
+	return true;
+}
+
+static void scr_bus_unlock(bool locked)
+{
+	if (locked)
+		flock(dc->scr_lock_fd, LOCK_UN);
+}
+
 static int scr_cmd(int frontend_fd, struct dvb_diseqc_master_cmd *diseqc)
 {
 	int err = 0;
@@ -651,6 +954,9 @@ static void scr_prepare_tune_EN50494(uint16_t fIF, struct scr *config,
 
 /* Programmes SCR LNB/Switch via diseqc.
  * DVB card should tune afterwards to (userband + offset) in MHz.
+ * The sequence is repeated once after 100msec, because it may fail and we
+ * cannot check here. If slot, tuning word and sat pos are the same as last
+ * time, nothing is sent at all.
  * returns:
  *    0         on success
  *    non-zero  on error (check errno)
@@ -667,6 +973,8 @@ int setup_scr(int frontend_fd, struct transponder *t, struct lnb_types_st *lnb,
 	uint8_t horiz = t->polarization == POLARIZATION_HORIZONTAL ? 1 : 0;
 	uint32_t fLO = hiband > 0 ? lnb->high_val : lnb->low_val;
 	uint16_t fIF = ROUND(abs(t->frequency - fLO) / 1000.0);	// 950..2150MHz
+	bool locked;
+	int err;
 
 	struct dvb_diseqc_master_cmd diseqc = {
 		{0xE0, 0x10, 0x5A, 0x00, 0x00, 0x00}, 5
@@ -685,11 +993,31 @@ int setup_scr(int frontend_fd, struct transponder *t, struct lnb_types_st *lnb,
 		      __FUNCTION__, __LINE__, config->norm);
 	}
 
-	return scr_cmd(frontend_fd, &diseqc);
+	if ((sec_state.scr_msg_len == diseqc.msg_len)
+	    && (memcmp(sec_state.scr_msg, diseqc.msg, diseqc.msg_len) == 0)) {
+		verbose("SCR: user band unchanged, skipped.\n");
+		return 0;
+	}
+
+	sec_state_invalidate();
+	locked = scr_bus_lock();
+	if ((err = scr_cmd(frontend_fd, &diseqc)) == 0) {
+		msleep(50 + rand() % 100);	// randomized repeat
+		err = scr_cmd(frontend_fd, &diseqc);
+	}
+	scr_bus_unlock(locked);
+	if (err)
+		return err;
+
+	sec_state.scr_msg_len = diseqc.msg_len;
+	memcpy(sec_state.scr_msg, diseqc.msg, diseqc.msg_len);
+	return 0;
 }
 
 int scr_poweroff(int frontend_fd, struct scr *config)
 {
+	bool locked;
+	int err;
 	struct dvb_diseqc_master_cmd diseqc;
 
 	switch (config->norm) {
@@ -722,5 +1050,68 @@ int scr_poweroff(int frontend_fd, struct scr *config)
 		fatal("%s:%d: unknown SCR norm '%d'\n",
 		      __FUNCTION__, __LINE__, config->norm);
 	}
-	return scr_cmd(frontend_fd, &diseqc);
+	sec_state_invalidate();
+	locked = scr_bus_lock();
+	err = scr_cmd(frontend_fd, &diseqc);
+	scr_bus_unlock(locked);
+	return err;
+}
+
+void diseqc_context_init(struct diseqc_context *d)
+{
+	int i;
+
+	memset(d, 0, sizeof(*d));
+	d->rotor_model.speed = speed_18V;
+	d->scr_lock_fd = -1;
+	d->rotor_positions = malloc(sat_count() * sizeof(int));
+	for (i = 0; d->rotor_positions && (i < sat_count()); i++)
+		d->rotor_positions[i] = -1;
+}
+
+void diseqc_context_release(struct diseqc_context *d)
+{
+	if ((d->scr_lock_fd >= 0) && (d->scr_lock_pid == getpid()))
+		close(d->scr_lock_fd);
+	d->scr_lock_fd = -1;
+	free(d->rotor_model.file);
+	d->rotor_model.file = NULL;
+	free(d->rotor_positions);
+	d->rotor_positions = NULL;
+	if (dc == d)
+		dc = NULL;
+}
+
+struct diseqc_context *diseqc_context_use(struct diseqc_context *d)
+{
+	struct diseqc_context *prev = dc;
+
+	dc = d;
+	return prev;
+}
+
+int sat_rotor_position(int channellist)
+{
+	if ((dc == NULL) || (dc->rotor_positions == NULL)
+	    || (channellist < 0) || (channellist >= sat_count()))
+		return -1;
+	return dc->rotor_positions[channellist];
+}
+
+void set_sat_rotor_position(int channellist, int position)
+{
+	if ((dc == NULL) || (dc->rotor_positions == NULL)
+	    || (channellist < 0) || (channellist >= sat_count()))
+		return;
+	dc->rotor_positions[channellist] = position;
+}
+
+int rotor_position_to_sat_list_index(int position)
+{
+	int i;
+
+	for (i = 0; i < sat_count(); i++)
+		if (position == sat_rotor_position(i))
+			return i;
+	return -1;
 }
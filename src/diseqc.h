@@ -5,6 +5,7 @@
 #define __DISEQC_H__
 
 #include <stdint.h>
+#include <sys/types.h>
 #include "extended_frontend.h"
 #include "si_types.h"
 #include "lnb.h"
@@ -19,13 +20,76 @@ extern int diseqc_send_msg(int fd, fe_sec_voltage_t v, struct diseqc_cmd **cmd,
 
 /*
 *   set up the switch to position/voltage/tone
+*   returns 0 if sent, 1 if switch was already in this state, < 0 on error.
 */
 int setup_switch(int frontend_fd, int switch_pos, int voltage_18, int freq,
 		 int uncommitted_switch_pos);
+
+/*
+*   forget the cached LNB/switch/SCR state, next setup sends everything again.
+*/
+void sec_state_invalidate(void);
+
+/*
+*   daemon mode: carry the cached state over to the next scan job.
+*/
+#define SEC_STATE_SIZE 32
+void sec_state_export(uint8_t *buf);
+void sec_state_import(const uint8_t *buf);
 int rotate_rotor(int frontend_fd, int *from, int to, uint8_t voltage_18,
 		 uint8_t hiband);
+float rotor_angle(uint16_t channellist);
+
+/*
+*   read measured rotor speed from file, new measurements are saved there.
+*/
+int rotor_model_load(const char *file);
+
+/*
+*   rotor position of satellite 'channellist' (sat_list index), -1 if none.
+*   Set by '-r' or '-p', kept per scan; sat_list itself is read only.
+*/
+int sat_rotor_position(int channellist);
+void set_sat_rotor_position(int channellist, int position);
+
+/*
+*   sat_list index of rotor position 'position', -1 if no satellite has it.
+*/
+int rotor_position_to_sat_list_index(int position);
+
+/*
+*   sort satellites (sat_list indices) for minimal total rotor movement,
+*   starting from rotor position 'from' (-1 == unknown).
+*/
+void rotor_order_satellites(int *channellists, int count, int from);
 
 int setup_scr(int frontend_fd, struct transponder *t, struct lnb_types_st *lnb,
 	      struct scr *config);
 
+/*
+*   per scan state: DiSEqC 2.x support, learned rotor speed, SCR bus lock.
+*   Each scan_context has its own, see diseqc_context_use().
+*/
+struct diseqc_context {
+	int diseqc_2_x_error;	// do 2.x cmds only once.
+	struct rotor_model {
+		char *file;
+		uint32_t moves;
+		double sum_a, sum_t, sum_aa, sum_at;
+		double speed;	// degrees per second
+		double t0;	// seconds
+	} rotor_model;
+	int scr_lock_fd;
+	pid_t scr_lock_pid;
+	int *rotor_positions;	// per sat_list index, -1 == none
+};
+
+void diseqc_context_init(struct diseqc_context *d);
+void diseqc_context_release(struct diseqc_context *d);
+
+/*
+*   state used by the calling thread from now on, returns the previous one.
+*/
+struct diseqc_context *diseqc_context_use(struct diseqc_context *d);
+
 #endif
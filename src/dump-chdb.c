@@ -0,0 +1,287 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "extended_frontend.h"
+#include "scan.h"
+#include "si_types.h"
+#include "chdb.h"
+#include "dump-chdb.h"
+
+/******************************************************************************
+ * binary channel database output, file format see chdb.h.
+ *****************************************************************************/
+
+struct string_pool {
+	char *data;
+	uint32_t len;
+	uint32_t size;
+};
+
+static uint32_t pool_add(struct string_pool *p, const char *s)
+{
+	uint32_t offset = p->len;
+	size_t len;
+
+	if ((s == NULL) || (*s == 0))
+		return 0;
+	len = strlen(s) + 1;
+	while (p->len + len > p->size) {
+		p->size = p->size ? 2 * p->size : 65536;
+		if ((p->data = realloc(p->data, p->size)) == NULL)
+			fatal("out of memory\n");
+	}
+	memcpy(p->data + p->len, s, len);
+	p->len += len;
+	return offset;
+}
+
+/* qsort() has no context argument. */
+static const struct chdb_service *sort_services;
+static const char *sort_strings;
+
+static int cmp_id(const void *a, const void *b)
+{
+	const struct chdb_service *x = &sort_services[*(const uint32_t *)a];
+	const struct chdb_service *y = &sort_services[*(const uint32_t *)b];
+
+	if (x->original_network_id != y->original_network_id)
+		return x->original_network_id - y->original_network_id;
+	if (x->transport_stream_id != y->transport_stream_id)
+		return x->transport_stream_id - y->transport_stream_id;
+	return x->service_id - y->service_id;
+}
+
+static int cmp_lcn(const void *a, const void *b)
+{
+	const struct chdb_service *x = &sort_services[*(const uint32_t *)a];
+	const struct chdb_service *y = &sort_services[*(const uint32_t *)b];
+
+	if (x->logical_channel_number != y->logical_channel_number)
+		return x->logical_channel_number <
+		    y->logical_channel_number ? -1 : 1;
+	return cmp_id(a, b);
+}
+
+static int cmp_name(const void *a, const void *b)
+{
+	const struct chdb_service *x = &sort_services[*(const uint32_t *)a];
+	const struct chdb_service *y = &sort_services[*(const uint32_t *)b];
+	int c = strcasecmp(sort_strings + x->name, sort_strings + y->name);
+
+	return c ? c : cmp_id(a, b);
+}
+
+static void write_index(struct output_buffer *f, uint32_t * index,
+			uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		uint32_t v = htole32(index[i]);
+		ob_write(f, (const char *)&v, sizeof(v));
+	}
+}
+
+static void write_padding(struct output_buffer *f, uint32_t len)
+{
+	static const char zero[4];
+
+	ob_write(f, zero, (4 - (len & 3)) & 3);
+}
+
+#define ALIGN4(x) (((x) + 3) & ~3U)
+
+void chdb_dump(struct output_buffer *f, pList transponders,
+	       bool (*want_service) (struct service * s))
+{
+	struct string_pool pool = { NULL, 0, 0 };
+	struct chdb_header h;
+	struct chdb_transponder *tps;
+	struct chdb_service *srv;
+	uint32_t *by_id, *by_lcn, *by_name;
+	uint32_t nt = 0, ns = 0, i;
+	struct transponder *t;
+	struct service *s;
+
+	for (t = transponders->first; t; t = t->next) {
+		nt++;
+		for (s = t->services->first; s; s = s->next)
+			if (want_service(s))
+				ns++;
+	}
+	tps = calloc(nt ? nt : 1, sizeof(*tps));
+	srv = calloc(ns ? ns : 1, sizeof(*srv));
+	by_id = calloc(ns ? ns : 1, sizeof(*by_id));
+	by_lcn = calloc(ns ? ns : 1, sizeof(*by_lcn));
+	by_name = calloc(ns ? ns : 1, sizeof(*by_name));
+	if (!tps || !srv || !by_id || !by_lcn || !by_name)
+		fatal("out of memory\n");
+	pool.size = 65536;
+	if ((pool.data = malloc(pool.size)) == NULL)
+		fatal("out of memory\n");
+	pool.data[0] = 0;	// offset 0: the empty string.
+	pool.len = 1;
+
+	// host byte order while sorting, converted when written.
+	for (t = transponders->first, nt = 0, ns = 0; t; t = t->next, nt++) {
+		struct chdb_transponder *ct = &tps[nt];
+		uint32_t provider = 0;
+		const char *last_provider = NULL;
+
+		ct->frequency = t->frequency;
+		ct->symbolrate = t->symbolrate;
+		ct->bandwidth = t->bandwidth;
+		ct->source = t->source;
+		ct->network_name = pool_add(&pool, t->network_name);
+		ct->original_network_id = t->original_network_id;
+		ct->network_id = t->network_id;
+		ct->transport_stream_id = t->transport_stream_id;
+		ct->delsys = t->delsys;
+		ct->modulation = t->modulation;
+		ct->coderate = t->coderate;
+		ct->polarization = t->polarization;
+		ct->rolloff = t->rolloff;
+		ct->plp_id = t->plp_id;
+		ct->orbital_position = t->orbital_position;
+		ct->system_id = t->system_id;
+		ct->type = t->type;
+		ct->inversion = t->inversion;
+		ct->pilot = t->pilot;
+		ct->input_stream_id = t->input_stream_identifier;
+		ct->coderate_LP = t->coderate_LP;
+		ct->guard = t->guard;
+		ct->transmission = t->transmission;
+		ct->hierarchy = t->hierarchy;
+		ct->west_east_flag = t->west_east_flag;
+		ct->data_slice_id = t->data_slice_id;
+
+		for (s = t->services->first; s; s = s->next) {
+			struct chdb_service *cs = &srv[ns];
+			if (!want_service(s))
+				continue;
+			cs->transponder = nt;
+			cs->name = pool_add(&pool, s->service_name);
+			// providers repeat for all services of a transponder.
+			if ((last_provider == NULL) || (s->provider_name == NULL)
+			    || strcmp(last_provider, s->provider_name))
+				provider = pool_add(&pool, s->provider_name);
+			last_provider = s->provider_name;
+			cs->provider = provider;
+			cs->logical_channel_number = s->logical_channel_number;
+			cs->original_network_id = t->original_network_id;
+			cs->transport_stream_id = t->transport_stream_id;
+			cs->service_id = s->service_id;
+			cs->pmt_pid = s->pmt_pid;
+			cs->pcr_pid = s->pcr_pid;
+			cs->video_pid = s->video_pid;
+			cs->audio_pid = s->audio_pid[0];
+			cs->ac3_pid = s->ac3_pid[0];
+			cs->teletext_pid = s->teletext_pid;
+			cs->ca_id = s->ca_id[0];
+			cs->video_stream_type = s->video_stream_type;
+			cs->audio_num = s->audio_num;
+			cs->ac3_num = s->ac3_num;
+			cs->scrambled = s->scrambled;
+			memcpy(cs->audio_lang, s->audio_lang[0], 3);
+			memcpy(cs->ac3_lang, s->ac3_lang[0], 3);
+			by_id[ns] = by_lcn[ns] = by_name[ns] = ns;
+			ns++;
+		}
+	}
+
+	sort_services = srv;
+	sort_strings = pool.data;
+	qsort(by_id, ns, sizeof(uint32_t), cmp_id);
+	qsort(by_lcn, ns, sizeof(uint32_t), cmp_lcn);
+	qsort(by_name, ns, sizeof(uint32_t), cmp_name);
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CHDB_MAGIC, sizeof(h.magic));
+	h.version = htole32(CHDB_VERSION);
+	h.header_size = htole32(sizeof(h));
+	h.transponder_count = htole32(nt);
+	h.transponder_offset = htole32(sizeof(h));
+	h.service_count = htole32(ns);
+	i = sizeof(h) + nt * sizeof(*tps);
+	h.service_offset = htole32(i);
+	i += ns * sizeof(*srv);
+	h.strings_offset = htole32(i);
+	h.strings_size = htole32(pool.len);
+	i = ALIGN4(i + pool.len);
+	h.index_id_offset = htole32(i);
+	i += ns * sizeof(uint32_t);
+	h.index_lcn_offset = htole32(i);
+	i += ns * sizeof(uint32_t);
+	h.index_name_offset = htole32(i);
+	i += ns * sizeof(uint32_t);
+	h.file_size = htole32(i);
+	ob_write(f, (const char *)&h, sizeof(h));
+
+	for (i = 0; i < nt; i++) {
+		struct chdb_transponder *ct = &tps[i];
+		ct->frequency = htole32(ct->frequency);
+		ct->symbolrate = htole32(ct->symbolrate);
+		ct->bandwidth = htole32(ct->bandwidth);
+		ct->source = htole32(ct->source);
+		ct->network_name = htole32(ct->network_name);
+		ct->original_network_id = htole16(ct->original_network_id);
+		ct->network_id = htole16(ct->network_id);
+		ct->transport_stream_id = htole16(ct->transport_stream_id);
+		ct->orbital_position = htole16(ct->orbital_position);
+		ct->system_id = htole16(ct->system_id);
+	}
+	ob_write(f, (const char *)tps, nt * sizeof(*tps));
+
+	for (i = 0; i < ns; i++) {
+		struct chdb_service *cs = &srv[i];
+		cs->transponder = htole32(cs->transponder);
+		cs->name = htole32(cs->name);
+		cs->provider = htole32(cs->provider);
+		cs->logical_channel_number =
+		    htole32(cs->logical_channel_number);
+		cs->original_network_id = htole16(cs->original_network_id);
+		cs->transport_stream_id = htole16(cs->transport_stream_id);
+		cs->service_id = htole16(cs->service_id);
+		cs->pmt_pid = htole16(cs->pmt_pid);
+		cs->pcr_pid = htole16(cs->pcr_pid);
+		cs->video_pid = htole16(cs->video_pid);
+		cs->audio_pid = htole16(cs->audio_pid);
+		cs->ac3_pid = htole16(cs->ac3_pid);
+		cs->teletext_pid = htole16(cs->teletext_pid);
+		cs->ca_id = htole16(cs->ca_id);
+	}
+	ob_write(f, (const char *)srv, ns * sizeof(*srv));
+
+	ob_write(f, pool.data, pool.len);
+	write_padding(f, pool.len);
+	write_index(f, by_id, ns);
+	write_index(f, by_lcn, ns);
+	write_index(f, by_name, ns);
+
+	free(pool.data);
+	free(tps);
+	free(srv);
+	free(by_id);
+	free(by_lcn);
+	free(by_name);
+}
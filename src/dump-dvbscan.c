@@ -37,7 +37,7 @@
  * used later in w_scan2.
  *****************************************************************************/
 
-void dvbscan_dump_tuningdata(FILE * f,
+void dvbscan_dump_tuningdata(struct output_buffer *f,
 			     struct transponder *t,
 			     uint16_t index, struct w_scan_flags *flags)
 {
@@ -47,12 +47,12 @@ void dvbscan_dump_tuningdata(FILE * f,
 		time_t rawtime;
 		time(&rawtime);
 		ti = localtime(&rawtime);
-		fprintf(f,
+		ob_printf(f,
 			"#------------------------------------------------------------------------------\n");
-		fprintf(f, "# file automatically generated by %s\n",
+		ob_printf(f, "# file automatically generated by %s\n",
 			PACKAGE_NAME);
-		fprintf(f, "# (https://github.com/stefantalpalaru/w_scan2)\n");
-		fprintf(f, "#! <w_scan> %s %u %u %s %s </w_scan>\n",
+		ob_printf(f, "# (https://github.com/stefantalpalaru/w_scan2)\n");
+		ob_printf(f, "#! <w_scan> %s %u %u %s %s </w_scan>\n",
 			flags->version,
 			flags->tuning_timeout,
 			flags->filter_timeout,
@@ -60,89 +60,89 @@ void dvbscan_dump_tuningdata(FILE * f,
 			flags->scantype == SCAN_SATELLITE ?
 			satellite_to_short_name(flags->list_id) :
 			country_to_short_name(flags->list_id));
-		fprintf(f,
+		ob_printf(f,
 			"#------------------------------------------------------------------------------\n");
 
 		if (flags->scantype == SCAN_SATELLITE)
-			fprintf(f, "# satellite            : %s\n",
+			ob_printf(f, "# satellite            : %s\n",
 				satellite_to_short_name(flags->list_id));
 		else
-			fprintf(f,
+			ob_printf(f,
 				"# location and provider: <add description here>\n");
-		fprintf(f, "# date (yyyy-mm-dd)    : %.04d-%.02d-%.02d\n",
+		ob_printf(f, "# date (yyyy-mm-dd)    : %.04d-%.02d-%.02d\n",
 			ti->tm_year + 1900, ti->tm_mon + 1, ti->tm_mday);
-		fprintf(f,
+		ob_printf(f,
 			"# provided by (opt)    : <your name or email here>\n");
-		fprintf(f, "#\n");
+		ob_printf(f, "#\n");
 
 		switch (flags->scantype) {
 		case SCAN_TERRCABLE_ATSC:
-			fprintf(f, "# A[2] <freq> <mod> [# comment]\n");
+			ob_printf(f, "# A[2] <freq> <mod> [# comment]\n");
 			break;
 		case SCAN_CABLE:
-			fprintf(f,
+			ob_printf(f,
 				"# C[2] <freq> <sr> <fec> <mod> [plp_id] [data_slice_id] [system_id] [# comment]\n");
 			break;
 		case SCAN_TERRESTRIAL:
-			fprintf(f,
+			ob_printf(f,
 				"# T[2] <freq> <bw> <fec_hi> <fec_lo> <mod>");
-			fprintf(f, " <tm> <guard> <hi> [plp_id] [# comment]\n");	//  [system_id]
+			ob_printf(f, " <tm> <guard> <hi> [plp_id] [# comment]\n");	//  [system_id]
 			break;
 		case SCAN_SATELLITE:
-			fprintf(f,
+			ob_printf(f,
 				"# S[2] <freq> <pol> <sr> <fec> [ro] [mod] [isi] [pls_code] [pls_mode] [# comment]\n");
 			break;
 		default:
 			fatal("%s (%d): UNKNOWN SCAN TYPE %d\n", __FUNCTION__,
 			      __LINE__, flags->scantype);
 		};
-		fprintf(f,
+		ob_printf(f,
 			"#------------------------------------------------------------------------------\n");
 	}			/* end if index == 0 */
 	switch (flags->scantype) {
 	case SCAN_TERRCABLE_ATSC:
-		fprintf(f, "A ");
-		fprintf(f, "%9i ", t->frequency);
-		fprintf(f, "%8s", atsc_mod_to_txt(t->modulation));
+		ob_printf(f, "A ");
+		ob_printf(f, "%9i ", t->frequency);
+		ob_printf(f, "%8s", atsc_mod_to_txt(t->modulation));
 		break;
 	case SCAN_CABLE:
-		fprintf(f, "C ");
+		ob_printf(f, "C ");
 		if (t->delsys == SYS_DVBC2)
-			fprintf(f, "2 %u %u %u", t->plp_id, t->data_slice_id,
+			ob_printf(f, "2 %u %u %u", t->plp_id, t->data_slice_id,
 				t->system_id);
-		fprintf(f, "%9i ", t->frequency);
-		fprintf(f, "%7i ", t->symbolrate);
-		fprintf(f, "%4s ", cable_fec_to_txt(t->coderate));
-		fprintf(f, "%8s", cable_mod_to_txt(t->modulation));
+		ob_printf(f, "%9i ", t->frequency);
+		ob_printf(f, "%7i ", t->symbolrate);
+		ob_printf(f, "%4s ", cable_fec_to_txt(t->coderate));
+		ob_printf(f, "%8s", cable_mod_to_txt(t->modulation));
 		break;
 	case SCAN_TERRESTRIAL:
-		fprintf(f, "%s", t->delsys == SYS_DVBT2 ? "T2" : "T");
-		fprintf(f, " %9i ", t->frequency);
-		fprintf(f, "%4s ", terr_bw_to_txt(t->bandwidth));
-		fprintf(f, "%4s ", terr_fec_to_txt(t->coderate));
-		fprintf(f, "%4s ", terr_fec_to_txt(t->coderate_LP));
-		fprintf(f, "%8s ", terr_mod_to_txt(t->modulation));
-		fprintf(f, "%4s ", terr_transmission_to_txt(t->transmission));
-		fprintf(f, "%4s ", terr_guard_to_txt(t->guard));
-		fprintf(f, "%4s", terr_hierarchy_to_txt(t->hierarchy));
+		ob_printf(f, "%s", t->delsys == SYS_DVBT2 ? "T2" : "T");
+		ob_printf(f, " %9i ", t->frequency);
+		ob_printf(f, "%4s ", terr_bw_to_txt(t->bandwidth));
+		ob_printf(f, "%4s ", terr_fec_to_txt(t->coderate));
+		ob_printf(f, "%4s ", terr_fec_to_txt(t->coderate_LP));
+		ob_printf(f, "%8s ", terr_mod_to_txt(t->modulation));
+		ob_printf(f, "%4s ", terr_transmission_to_txt(t->transmission));
+		ob_printf(f, "%4s ", terr_guard_to_txt(t->guard));
+		ob_printf(f, "%4s", terr_hierarchy_to_txt(t->hierarchy));
 		if (t->plp_id)
-			fprintf(f, " %u", t->plp_id);
+			ob_printf(f, " %u", t->plp_id);
 		break;
 	case SCAN_SATELLITE:
-		fprintf(f, "%-2s ", sat_delivery_system_to_txt(t->delsys));
-		fprintf(f, "%8i ", t->frequency);
-		fprintf(f, "%1s ", sat_pol_to_txt(t->polarization));
-		fprintf(f, "%8i ", t->symbolrate);
-		fprintf(f, "%4s", sat_fec_to_txt(t->coderate));
+		ob_printf(f, "%-2s ", sat_delivery_system_to_txt(t->delsys));
+		ob_printf(f, "%8i ", t->frequency);
+		ob_printf(f, "%1s ", sat_pol_to_txt(t->polarization));
+		ob_printf(f, "%8i ", t->symbolrate);
+		ob_printf(f, "%4s", sat_fec_to_txt(t->coderate));
 		if (t->delsys != SYS_DVBS) {
-			fprintf(f, " %2s ", sat_rolloff_to_txt(t->rolloff));
-			fprintf(f, "%6s", sat_mod_to_txt(t->modulation));
+			ob_printf(f, " %2s ", sat_rolloff_to_txt(t->rolloff));
+			ob_printf(f, "%6s", sat_mod_to_txt(t->modulation));
 		}
 		break;
 	default:
 		;
 	};
 	if (network_name != NULL)
-		fprintf(f, "\t# %s", network_name);
-	fprintf(f, "\n");
+		ob_printf(f, "\t# %s", network_name);
+	ob_printf(f, "\n");
 }
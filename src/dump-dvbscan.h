@@ -25,8 +25,9 @@
 #include <stdint.h>
 #include "extended_frontend.h"
 #include "scan.h"
+#include "output-buffer.h"
 
-extern void dvbscan_dump_tuningdata(FILE * f,
+extern void dvbscan_dump_tuningdata(struct output_buffer *f,
 				    struct transponder *t,
 				    uint16_t index, struct w_scan_flags *flags);
 
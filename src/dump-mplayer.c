@@ -28,41 +28,48 @@
 #include "dump-mplayer.h"
 #include "dump-xine.h"
 
-void mplayer_dump_service_parameter_set(FILE * f,
+void mplayer_dump_service_parameter_set(struct output_buffer *f,
 					struct service *s,
 					struct transponder *t,
 					struct w_scan_flags *flags)
 {
 	int i;
 
-	fprintf(f, "%s:", s->service_name);
+	ob_puts_escaped(f, s->service_name, ESCAPE_VDR);
+	ob_putc(f, ':');
 	xine_dump_dvb_parameters(f, t, flags);
-	fprintf(f, ":%i:", s->video_pid);
+	ob_putc(f, ':');
+	ob_putd(f, s->video_pid);
+	ob_putc(f, ':');
 
 	// build '+' separated list of mpeg audio and ac3 audio pids
 	if (s->audio_pid[0] || s->ac3_pid[0]) {
 
 		// prefer ac3 audio.
 		if (s->ac3_pid[0]) {
-			fprintf(f, "%i", s->ac3_pid[0]);
+			ob_putd(f, s->ac3_pid[0]);
 			for (i = 1; i < s->ac3_num; i++) {
-				fprintf(f, "+%i", s->ac3_pid[i]);
+				ob_putc(f, '+');
+				ob_putd(f, s->ac3_pid[i]);
 			}
 			if (s->audio_pid[0])
-				fprintf(f, "%s", "+");
+				ob_putc(f, '+');
 		}
 		// standard audio pids follow.
 		if (s->audio_pid[0]) {
-			fprintf(f, "%i", s->audio_pid[0]);
+			ob_putd(f, s->audio_pid[0]);
 			for (i = 1; i < s->audio_num; i++) {
-				fprintf(f, "+%i", s->audio_pid[i]);
+				ob_putc(f, '+');
+				ob_putd(f, s->audio_pid[i]);
 			}
 		}
 	}
 
 	else
 		// no audio or ac3 audio pids found.
-		fprintf(f, "%i", 0);
+		ob_putc(f, '0');
 
-	fprintf(f, ":%i\n", s->service_id);
+	ob_putc(f, ':');
+	ob_putd(f, s->service_id);
+	ob_putc(f, '\n');
 }
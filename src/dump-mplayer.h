@@ -27,8 +27,9 @@
 #include <stdint.h>
 #include "extended_frontend.h"
 #include "scan.h"
+#include "output-buffer.h"
 
-extern void mplayer_dump_service_parameter_set(FILE * f,
+extern void mplayer_dump_service_parameter_set(struct output_buffer *f,
 					       struct service *s,
 					       struct transponder *t,
 					       struct w_scan_flags *flags);
@@ -458,26 +458,36 @@ const char *vdr_delsys_name(int delsys)
  * print "frequency:<params>:symbolrate:" to 'f' in vdr >= 1.7.4 format
  * NOTE: 1.7.0 .. 1.7.3 not supported here.
  *****************************************************************************/
-#define vdrprint(fd, Param, Default, ID, Value) if (Param != Default) fprintf(fd,"%s%s", ID, Value)
+#define vdrprint(fd, Param, Default, ID, Value) if (Param != Default) { ob_puts(fd, ID); ob_puts(fd, Value); }
 
-void dump_param_vdr(FILE * f, struct transponder *t, struct w_scan_flags *flags)
+void dump_param_vdr(struct output_buffer *f, struct transponder *t, struct w_scan_flags *flags)
 {
 
 	switch (flags->scantype) {
 	case SCAN_TERRCABLE_ATSC:
-		fprintf(f, ":%i:", t->frequency / 1000);
-		fprintf(f, "M%s:A:", vdr_modulation_name(t->modulation));
-		fprintf(f, "%i:", t->symbolrate / 1000);
+		ob_putc(f, ':');
+		ob_putd(f, t->frequency / 1000);
+		ob_puts(f, ":M");
+		ob_puts(f, vdr_modulation_name(t->modulation));
+		ob_puts(f, ":A:");
+		ob_putd(f, t->symbolrate / 1000);
+		ob_putc(f, ':');
 		break;
 
 	case SCAN_CABLE:
-		fprintf(f, ":%i:", t->frequency / 1000);
-		fprintf(f, "M%s:C:", vdr_modulation_name(t->modulation));
-		fprintf(f, "%i:", t->symbolrate / 1000);
+		ob_putc(f, ':');
+		ob_putd(f, t->frequency / 1000);
+		ob_puts(f, ":M");
+		ob_puts(f, vdr_modulation_name(t->modulation));
+		ob_puts(f, ":C:");
+		ob_putd(f, t->symbolrate / 1000);
+		ob_putc(f, ':');
 		break;
 
 	case SCAN_TERRESTRIAL:
-		fprintf(f, ":%i:", t->frequency / 1000);
+		ob_putc(f, ':');
+		ob_putd(f, t->frequency / 1000);
+		ob_putc(f, ':');
 		vdrprint(f, t->bandwidth, 0, "B",
 			 vdr_bandwidth_name(t->bandwidth));
 		vdrprint(f, t->coderate, FEC_AUTO, "C",
@@ -496,60 +506,75 @@ void dump_param_vdr(FILE * f, struct transponder *t, struct w_scan_flags *flags)
 			 vdr_transmission_mode_name(t->transmission));
 		vdrprint(f, t->hierarchy, HIERARCHY_AUTO, "Y",
 			 vdr_hierarchy_name(t->hierarchy));
-		if (t->delsys == SYS_DVBT2)
-			fprintf(f, "P%u", t->plp_id);
-		fprintf(f, ":T:27500:");
+		if (t->delsys == SYS_DVBT2) {
+			ob_putc(f, 'P');
+			ob_putu(f, t->plp_id);
+		}
+		ob_puts(f, ":T:27500:");
 		break;
 
 	case SCAN_SATELLITE:
-		fprintf(f, ":%i:", t->frequency / 1000);
+		ob_putc(f, ':');
+		ob_putd(f, t->frequency / 1000);
+		ob_putc(f, ':');
 		switch (t->polarization) {
 		case POLARIZATION_HORIZONTAL:
-			fprintf(f, "h");
+			ob_putc(f, 'h');
 			break;
 		case POLARIZATION_VERTICAL:
-			fprintf(f, "v");
+			ob_putc(f, 'v');
 			break;
 		case POLARIZATION_CIRCULAR_LEFT:
-			fprintf(f, "l");
+			ob_putc(f, 'l');
 			break;
 		case POLARIZATION_CIRCULAR_RIGHT:
-			fprintf(f, "r");
+			ob_putc(f, 'r');
 			break;
 		default:
 			fatal("Unknown Polarization %d\n", t->polarization);
 		}
-		fprintf(f, "C%s", vdr_fec_name(t->coderate));
+		ob_putc(f, 'C');
+		ob_puts(f, vdr_fec_name(t->coderate));
 		switch (t->delsys) {
 		case SYS_DVBS2:
-			fprintf(f, "M%sO%sS1:",
-				vdr_modulation_name(t->modulation),
-				vdr_rolloff_name(t->rolloff));
+			ob_putc(f, 'M');
+			ob_puts(f, vdr_modulation_name(t->modulation));
+			ob_putc(f, 'O');
+			ob_puts(f, vdr_rolloff_name(t->rolloff));
+			ob_puts(f, "S1:");
 			break;
 		default:
 			/* DVB-S always r = 0.35 according to specs
 			 * but vdr specifies 'O0' here (should be O35),
 			 * modulation is fix QPSK = 'M2'.
 			 */
-			fprintf(f, "M2O0S0:");
+			ob_puts(f, "M2O0S0:");
 		}
 
-		fprintf(f, "%s:",
-			short_name_to_vdr_name(satellite_to_short_name
-					       (flags->list_id)));
-		fprintf(f, "%i:", t->symbolrate / 1000);
+		ob_puts(f, short_name_to_vdr_name(satellite_to_short_name
+						  (flags->list_id)));
+		ob_putc(f, ':');
+		ob_putd(f, t->symbolrate / 1000);
+		ob_putc(f, ':');
 		break;
 
 	default:;
 	};
 }
 
+/* vdr writes languages as "%.4s". */
+static void vdr_lang(struct output_buffer *f, const char *lang)
+{
+	ob_putc(f, '=');
+	ob_write(f, lang, strnlen(lang, 4));
+}
+
 /******************************************************************************
  * print complete vdr channels.conf line from service params.
  *
  *****************************************************************************/
 
-void vdr_dump_service_parameter_set(FILE * f,
+void vdr_dump_service_parameter_set(struct output_buffer *f,
 				    struct service *s,
 				    struct transponder *t,
 				    struct w_scan_flags *flags)
@@ -558,78 +583,97 @@ void vdr_dump_service_parameter_set(FILE * f,
 
 	if (!flags->ca_select && s->scrambled)
 		return;
-	fprintf(f, "%s", s->service_name);
+	/* ':' is field separator in vdr service lists */
+	ob_puts_escaped(f, s->service_name, ESCAPE_VDR);
 
-	if (flags->dump_provider)
-		fprintf(f, ";%s", s->provider_name);
+	if (flags->dump_provider) {
+		ob_putc(f, ';');
+		ob_puts_escaped(f, s->provider_name, ESCAPE_VDR);
+	}
 
 	dump_param_vdr(f, t, flags);
 
-	fprintf(f, "%i", s->video_pid);
+	ob_putd(f, s->video_pid);
 
-	if (s->video_pid && (s->pcr_pid != s->video_pid))
-		fprintf(f, "+%i", s->pcr_pid);
-	if (s->video_stream_type)
-		fprintf(f, "=%u", s->video_stream_type);
+	if (s->video_pid && (s->pcr_pid != s->video_pid)) {
+		ob_putc(f, '+');
+		ob_putd(f, s->pcr_pid);
+	}
+	if (s->video_stream_type) {
+		ob_putc(f, '=');
+		ob_putu(f, s->video_stream_type);
+	}
 
-	fprintf(f, ":");
+	ob_putc(f, ':');
 
-	fprintf(f, "%i", s->audio_pid[0]);
+	ob_putd(f, s->audio_pid[0]);
 	if (s->audio_lang && s->audio_lang[0][0])
-		fprintf(f, "=%.4s", s->audio_lang[0]);
-	if (s->audio_stream_type[0])
-		fprintf(f, "@%u", s->audio_stream_type[0]);
+		vdr_lang(f, s->audio_lang[0]);
+	if (s->audio_stream_type[0]) {
+		ob_putc(f, '@');
+		ob_putu(f, s->audio_stream_type[0]);
+	}
 	for (i = 1; i < s->audio_num; i++) {
-		fprintf(f, ",%i", s->audio_pid[i]);
+		ob_putc(f, ',');
+		ob_putd(f, s->audio_pid[i]);
 		if (s->audio_lang && s->audio_lang[i][0])
-			fprintf(f, "=%.4s", s->audio_lang[i]);
+			vdr_lang(f, s->audio_lang[i]);
 		if (flags->vdr_version > 7)
-			if (s->audio_stream_type[i])
-				fprintf(f, "@%u", s->audio_stream_type[i]);
+			if (s->audio_stream_type[i]) {
+				ob_putc(f, '@');
+				ob_putu(f, s->audio_stream_type[i]);
+			}
 	}
 
 	if (s->ac3_num) {
-		fprintf(f, "%s", ";");
+		ob_putc(f, ';');
 		for (i = 0; i < s->ac3_num; i++) {
 			if (i > 0)
-				fprintf(f, "%s", ",");
-			fprintf(f, "%i", s->ac3_pid[i]);
+				ob_putc(f, ',');
+			ob_putd(f, s->ac3_pid[i]);
 			if (flags->vdr_version > 7)
 				if (s->ac3_lang && s->ac3_lang[i][0])
-					fprintf(f, "=%.4s", s->ac3_lang[i]);
+					vdr_lang(f, s->ac3_lang[i]);
 
 		}
 	}
 
-	fprintf(f, ":%d", s->teletext_pid);
+	ob_putc(f, ':');
+	ob_putd(f, s->teletext_pid);
 
 	// add subtitling here
 	if (s->subtitling_num) {
-		fprintf(f, "%s", ";");
+		ob_putc(f, ';');
 		for (i = 0; i < s->subtitling_num; i++) {
 			if (i > 0)
-				fprintf(f, "%s", ",");
-			fprintf(f, "%i", s->subtitling_pid[i]);
+				ob_putc(f, ',');
+			ob_putd(f, s->subtitling_pid[i]);
 			if (s->subtitling_lang && s->subtitling_lang[i][0])
-				fprintf(f, "=%.4s", s->subtitling_lang[i]);
+				vdr_lang(f, s->subtitling_lang[i]);
 		}
 	}
 
-	fprintf(f, ":%X", s->ca_id[0]);
+	ob_putc(f, ':');
+	ob_putX(f, s->ca_id[0]);
 	for (i = 1; i < s->ca_num; i++) {
 		if (s->ca_id[i] == 0)
 			continue;
-		fprintf(f, ",%X", s->ca_id[i]);
+		ob_putc(f, ',');
+		ob_putX(f, s->ca_id[i]);
 	}
 
-	fprintf(f, ":%d:%d:%d:0",
-		s->service_id,
-		(t->transport_stream_id > 0) ? t->original_network_id : 0,
-		t->transport_stream_id);
+	ob_putc(f, ':');
+	ob_putd(f, s->service_id);
+	ob_putc(f, ':');
+	ob_putd(f, (t->transport_stream_id > 0) ? t->original_network_id : 0);
+	ob_putc(f, ':');
+	ob_putd(f, t->transport_stream_id);
+	ob_puts(f, ":0");
 
 	if (flags->print_pmt) {
-		fprintf(f, ":%d", s->pmt_pid);
+		ob_putc(f, ':');
+		ob_putd(f, s->pmt_pid);
 	}
 
-	fprintf(f, "%s", "\n");
+	ob_putc(f, '\n');
 }
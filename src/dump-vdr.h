@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include "scan.h"
+#include "output-buffer.h"
 #include "extended_frontend.h"
 #include "si_types.h"
 
@@ -39,7 +40,7 @@ const char *vdr_guard_name(int guard_interval);
 const char *vdr_hierarchy_name(int hierarchy);
 const char *vdr_name_to_short_name(const char *satname);
 
-void vdr_dump_service_parameter_set(FILE * f,
+void vdr_dump_service_parameter_set(struct output_buffer *f,
 				    struct service *s,
 				    struct transponder *t,
 				    struct w_scan_flags *flags);
@@ -38,20 +38,48 @@
  *       2) check all values for system, modulation, fec, ..        <- done.
  *       3) enshure UTF-8 compliance of service names (should be the easiest task) <- wrong. It's the hardest task. Names are converted by iconv to UTF8 and still probs..
  *****************************************************************************/
-static int idx = 1;
-
 #define T1 "\t"
 #define T2 "\t\t"
 #define T3 "\t\t\t"
 #define T4 "\t\t\t\t"
 #define T5 "\t\t\t\t\t"
-#define fprintf_tab0(v) fprintf(f, "%s", v)
-#define fprintf_tab1(v) fprintf(f, "%s%s", T1, v)
-#define fprintf_tab2(v) fprintf(f, "%s%s", T2, v)
-#define fprintf_tab3(v) fprintf(f, "%s%s", T3, v)
-#define fprintf_tab4(v) fprintf(f, "%s%s", T4, v)
-#define fprintf_tab5(v) fprintf(f, "%s%s", T5, v)
-#define fprintf_pair(p,v) fprintf(f, "%s=%c%s%c", p,34,v,34)
+#define fprintf_tab0(v) ob_puts(f, v)
+#define fprintf_tab1(v) (ob_puts(f, T1), ob_puts(f, v))
+#define fprintf_tab2(v) (ob_puts(f, T2), ob_puts(f, v))
+#define fprintf_tab3(v) (ob_puts(f, T3), ob_puts(f, v))
+#define fprintf_tab4(v) (ob_puts(f, T4), ob_puts(f, v))
+#define fprintf_tab5(v) (ob_puts(f, T5), ob_puts(f, v))
+#define fprintf_pair(p,v) (ob_puts(f, p), ob_puts(f, "=\""), ob_puts(f, v), ob_putc(f, '"'))
+
+/* T4 "<vlc:option>name=value</vlc:option>\n", written once per service. */
+static void vlc_option_s(struct output_buffer *f, const char *name,
+			 const char *value)
+{
+	fprintf_tab4("<vlc:option>");
+	ob_puts(f, name);
+	ob_putc(f, '=');
+	ob_puts(f, value);
+	ob_puts(f, "</vlc:option>\n");
+}
+
+static void vlc_option_d(struct output_buffer *f, const char *name, long value)
+{
+	fprintf_tab4("<vlc:option>");
+	ob_puts(f, name);
+	ob_putc(f, '=');
+	ob_putd(f, value);
+	ob_puts(f, "</vlc:option>\n");
+}
+
+static void vlc_option_u(struct output_buffer *f, const char *name,
+			 unsigned long value)
+{
+	fprintf_tab4("<vlc:option>");
+	ob_puts(f, name);
+	ob_putc(f, '=');
+	ob_putu(f, value);
+	ob_puts(f, "</vlc:option>\n");
+}
 
 int vlc_inversion(int inversion)
 {
@@ -204,7 +232,7 @@ int vlc_rolloff(int rolloff)
 	}
 }
 
-void vlc_xspf_prolog(FILE * f, uint16_t adapter, uint16_t frontend,
+void vlc_xspf_prolog(struct output_buffer *f, uint16_t adapter, uint16_t frontend,
 		     struct w_scan_flags *flags, struct lnb_types_st *lnbp)
 {
 	fprintf_tab0("<?");
@@ -220,16 +248,14 @@ void vlc_xspf_prolog(FILE * f, uint16_t adapter, uint16_t frontend,
 	fprintf_pair("version", "1");
 	fprintf_tab0(">\n");
 	fprintf_tab1("<title>DVB Playlist</title>\n");
-	fprintf(f, "%s<creator>%s-%s</creator>\n", T1, PACKAGE_NAME,
+	ob_printf(f, "%s<creator>%s-%s</creator>\n", T1, PACKAGE_NAME,
 		PACKAGE_VERSION);
 	fprintf_tab1
 	    ("<info>https://github.com/stefantalpalaru/w_scan2</info>\n");
 	fprintf_tab1("<trackList>\n");
-
-	idx = 1;
 }
 
-void vlc_xspf_epilog(FILE * f)
+void vlc_xspf_epilog(struct output_buffer *f)
 {
 	fprintf_tab1("</trackList>\n");
 	fprintf_tab0("</playlist>\n");
@@ -241,99 +267,77 @@ void vlc_xspf_epilog(FILE * f)
  * So, i try to save data in a VALID xspf syntax, but still READABLE BY VLC.
  */
 
-void vlc_dump_dvb_parameters_as_xspf(FILE * f, struct transponder *t,
+void vlc_dump_dvb_parameters_as_xspf(struct output_buffer *f, struct transponder *t,
 				     struct w_scan_flags *flags,
 				     struct lnb_types_st *lnbp)
 {
-	fprintf(f, "%s%s", T3, "<location>");
+	fprintf_tab3("<location>");
 	switch (flags->scantype) {
 	case SCAN_TERRCABLE_ATSC:
-		fprintf(f, "%s", "atsc://");
-		fprintf(f, "frequency=%i", t->frequency);
-		fprintf(f, "%s\n", "</location>");
+		ob_puts(f, "atsc://frequency=");
+		ob_putd(f, (int)t->frequency);
+		ob_puts(f, "</location>\n");
 
 		fprintf_tab3("<extension ");
 		fprintf_pair("application",
 			     "http://www.videolan.org/vlc/playlist/0");
 		fprintf_tab0(">\n");
 		if (t->modulation != QAM_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-modulation=%s</vlc:option>\n",
-				T4, vlc_modulation(t->modulation));
+			vlc_option_s(f, "dvb-modulation", vlc_modulation(t->modulation));
 		break;
 
 	case SCAN_CABLE:	//<location>dvb-c:frequency=522000000:modulation=64QAM:srate=6900000</location>
-		fprintf(f, "%s://", vlc_delsys(t->delsys));
-		fprintf(f, "frequency=%i", t->frequency);
-		fprintf(f, "%s\n", "</location>");
+		ob_puts(f, vlc_delsys(t->delsys));
+		ob_puts(f, "://frequency=");
+		ob_putd(f, (int)t->frequency);
+		ob_puts(f, "</location>\n");
 
 		fprintf_tab3("<extension ");
 		fprintf_pair("application",
 			     "http://www.videolan.org/vlc/playlist/0");
 		fprintf_tab0(">\n");
 
-		fprintf(f, "%s<vlc:option>dvb-srate=%i</vlc:option>\n", T4,
-			t->symbolrate);
-		fprintf(f, "%s<vlc:option>dvb-ts-id=%i</vlc:option>\n", T4,
-			t->transport_stream_id);
+		vlc_option_d(f, "dvb-srate", t->symbolrate);
+		vlc_option_d(f, "dvb-ts-id", t->transport_stream_id);
 
 		if (t->modulation != QAM_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-modulation=%s</vlc:option>\n",
-				T4, vlc_modulation(t->modulation));
+			vlc_option_s(f, "dvb-modulation", vlc_modulation(t->modulation));
 		if (t->inversion != INVERSION_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-inversion=%i</vlc:option>\n",
-				T4, vlc_inversion(t->inversion));
+			vlc_option_d(f, "dvb-inversion", vlc_inversion(t->inversion));
 		break;
 
 	case SCAN_TERRESTRIAL:
-		fprintf(f, "%s://", vlc_delsys(t->delsys));
-		fprintf(f, "frequency=%i", t->frequency);
-		fprintf(f, "%s\n", "</location>");
+		ob_puts(f, vlc_delsys(t->delsys));
+		ob_puts(f, "://frequency=");
+		ob_putd(f, (int)t->frequency);
+		ob_puts(f, "</location>\n");
 
 		fprintf_tab3("<extension ");
 		fprintf_pair("application",
 			     "http://www.videolan.org/vlc/playlist/0");
 		fprintf_tab0(">\n");
 
-		fprintf(f, "%s<vlc:option>dvb-bandwidth=%i</vlc:option>\n", T4,
-			vlc_bandwidth(t->bandwidth));
-		fprintf(f, "%s<vlc:option>dvb-ts-id=%i</vlc:option>\n", T4,
-			t->transport_stream_id);
+		vlc_option_d(f, "dvb-bandwidth", vlc_bandwidth(t->bandwidth));
+		vlc_option_d(f, "dvb-ts-id", t->transport_stream_id);
 
 		if (t->plp_id != 0)
-			fprintf(f, "%s<vlc:option>dvb-plp-id=%i</vlc:option>\n",
-				T4, t->plp_id);
+			vlc_option_d(f, "dvb-plp-id", t->plp_id);
 		if (t->inversion != INVERSION_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-inversion=%i</vlc:option>\n",
-				T4, vlc_inversion(t->inversion));
+			vlc_option_d(f, "dvb-inversion", vlc_inversion(t->inversion));
 		if (t->coderate != FEC_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-code-rate-hp=%s</vlc:option>\n",
-				T4, vlc_fec(t->coderate));
+			vlc_option_s(f, "dvb-code-rate-hp", vlc_fec(t->coderate));
 		if ((t->coderate_LP != FEC_AUTO)
 		    && (t->coderate_LP != FEC_NONE))
-			fprintf(f,
-				"%s<vlc:option>dvb-code-rate-lp=%s</vlc:option>\n",
-				T4, vlc_fec(t->coderate_LP));
+			vlc_option_s(f, "dvb-code-rate-lp", vlc_fec(t->coderate_LP));
 		if (t->modulation != QAM_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-modulation=%s</vlc:option>\n",
-				T4, vlc_modulation(t->modulation));
+			vlc_option_s(f, "dvb-modulation", vlc_modulation(t->modulation));
 		if (t->transmission != TRANSMISSION_MODE_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-transmission=%i</vlc:option>\n",
-				T4, vlc_transmission(t->transmission));
+			vlc_option_d(f, "dvb-transmission", vlc_transmission(t->transmission));
 		if (t->guard != GUARD_INTERVAL_AUTO)
-			fprintf(f, "%s<vlc:option>dvb-guard=%s</vlc:option>\n",
-				T4, vlc_guard(t->guard));
+			vlc_option_s(f, "dvb-guard", vlc_guard(t->guard));
 		if ((t->hierarchy != HIERARCHY_AUTO)
 		    && (t->hierarchy != HIERARCHY_NONE))
-			fprintf(f,
-				"%s<vlc:option>dvb-hierarchy=%i</vlc:option>\n",
-				T4, vlc_hierarchy(t->hierarchy));
+			vlc_option_d(f, "dvb-hierarchy", vlc_hierarchy(t->hierarchy));
 		break;
 
 	case SCAN_SATELLITE:
@@ -345,9 +349,10 @@ void vlc_dump_dvb_parameters_as_xspf(FILE * f, struct transponder *t,
 		 *       - obsoleting options
 		 *       - still NO FILE DOCUMENTATION for this dvb xspf format. :-(
 		 */
-		fprintf(f, "%s://", vlc_delsys(t->delsys));
-		fprintf(f, "frequency=%i", t->frequency);
-		fprintf(f, "%s\n", "</location>");
+		ob_puts(f, vlc_delsys(t->delsys));
+		ob_puts(f, "://frequency=");
+		ob_putd(f, (int)t->frequency);
+		ob_puts(f, "</location>\n");
 
 		fprintf_tab3("<extension ");
 		fprintf_pair("application",
@@ -357,50 +362,33 @@ void vlc_dump_dvb_parameters_as_xspf(FILE * f, struct transponder *t,
 		switch (t->polarization) {
 		case POLARIZATION_HORIZONTAL:
 		case POLARIZATION_CIRCULAR_LEFT:
-			fprintf(f,
-				"%s<vlc:option>dvb-polarization=H</vlc:option>\n",
-				T4);
+			vlc_option_s(f, "dvb-polarization", "H");
 			break;
 		default:
-			fprintf(f,
-				"%s<vlc:option>dvb-polarization=V</vlc:option>\n",
-				T4);
+			vlc_option_s(f, "dvb-polarization", "V");
 			break;
 		}
 
-		fprintf(f, "%s<vlc:option>dvb-srate=%i</vlc:option>\n", T4,
-			t->symbolrate);
-		fprintf(f, "%s<vlc:option>dvb-ts-id=%i</vlc:option>\n", T4,
-			t->transport_stream_id);
+		vlc_option_d(f, "dvb-srate", t->symbolrate);
+		vlc_option_d(f, "dvb-ts-id", t->transport_stream_id);
 
 		if (t->delsys != SYS_DVBS) {
-			fprintf(f,
-				"%s<vlc:option>dvb-modulation=%s</vlc:option>\n",
-				T4, vlc_modulation(t->modulation));
+			vlc_option_s(f, "dvb-modulation", vlc_modulation(t->modulation));
 			if (t->rolloff != ROLLOFF_AUTO)
-				fprintf(f,
-					"%s<vlc:option>dvb-rolloff=%i</vlc:option>\n",
-					T4, vlc_rolloff(t->rolloff));
+				vlc_option_d(f, "dvb-rolloff", vlc_rolloff(t->rolloff));
 		}
 
 		if (t->inversion != INVERSION_AUTO)
-			fprintf(f,
-				"%s<vlc:option>dvb-inversion=%i</vlc:option>\n",
-				T4, vlc_inversion(t->inversion));
+			vlc_option_d(f, "dvb-inversion", vlc_inversion(t->inversion));
 		if (t->coderate != FEC_AUTO)
-			fprintf(f, "%s<vlc:option>dvb-fec=%s</vlc:option>\n",
-				T4, vlc_fec(t->coderate));
+			vlc_option_s(f, "dvb-fec", vlc_fec(t->coderate));
 
-		fprintf(f, "%s<vlc:option>dvb-lnb-low=%lu</vlc:option>\n", T4,
-			lnbp->low_val);
-		fprintf(f, "%s<vlc:option>dvb-lnb-high=%lu</vlc:option>\n", T4,
-			lnbp->high_val);
-		fprintf(f, "%s<vlc:option>dvb-lnb-switch=%lu</vlc:option>\n",
-			T4, lnbp->switch_val);
+		vlc_option_u(f, "dvb-lnb-low", lnbp->low_val);
+		vlc_option_u(f, "dvb-lnb-high", lnbp->high_val);
+		vlc_option_u(f, "dvb-lnb-switch", lnbp->switch_val);
 
 		if ((flags->sw_pos & 0xF) < 0xF)
-			fprintf(f, "%s<vlc:option>dvb-satno=%i</vlc:option>\n",
-				T4, flags->sw_pos & 0xF);
+			vlc_option_d(f, "dvb-satno", flags->sw_pos & 0xF);
 		break;
 
 	default:
@@ -408,91 +396,37 @@ void vlc_dump_dvb_parameters_as_xspf(FILE * f, struct transponder *t,
 	};
 }
 
-/* TODO: THIS IS TEMPORAL && UGLY SOLUTION ONLY.
- *
- *       - REWORK LOGIC BEHIND SERVICE NAME;
- *       - MOVE TO GENERAL XML FUNC IN CHAR_CODING.C/.H && DEFINE ENTITIES;
- *       - ADD CONVERSION TO 8859-1.
- *       IN GENERAL, THERE WILL BE NEVER A COMPLETE SOLUTION POSSIBLE,
- *       SINCE INPUT CHAR CODING IS VERY OFTEN WRONG CODED BY SERVICE
- *       PROVIDERS. :(
+/* NOTE: IN GENERAL, THERE WILL BE NEVER A COMPLETE SOLUTION POSSIBLE FOR
+ *       SERVICE NAMES, SINCE INPUT CHAR CODING IS VERY OFTEN WRONG CODED BY
+ *       SERVICE PROVIDERS. :(  8bit chars are written as ISO8859-1 numeric
+ *       character references, see ESCAPE_XSPF in output-buffer.c.
  */
-void vlc_dump_service_parameter_set_as_xspf(FILE * f, struct service *s,
+void vlc_dump_service_parameter_set_as_xspf(struct output_buffer *f, int track,
+					    struct service *s,
 					    struct transponder *t,
 					    struct w_scan_flags *flags,
 					    struct lnb_types_st *lnbp)
 {
-	char buf[256];
-	int i, j, len = s->service_name ? strlen(s->service_name) : 0;
-	for (i = 0, j = 0; i < len; i++) {
-		uint8_t u = (unsigned)s->service_name[i];
-		if (u < 0x7F) {
-			if (range(u, 0x09, 0x09)) {
-				buf[j++] = ' ';
-			} else if (range(u, 0x20, 0x21) ||
-				   range(u, 0x23, 0x25) ||
-				   range(u, 0x28, 0x3B) ||
-				   range(u, 0x3D, 0x3D) ||
-				   range(u, 0x3F, 0x7E)) {
-				buf[j++] = (char)u;
-			} else if (range(u, 0x22, 0x22)) {	// double quotation mark
-				buf[j++] = '&';
-				buf[j++] = 'q';
-				buf[j++] = 'u';
-				buf[j++] = 'o';
-				buf[j++] = 't';
-				buf[j++] = ';';
-			} else if (range(u, 0x26, 0x26)) {	// double quotation mark
-				buf[j++] = '&';
-				buf[j++] = 'a';
-				buf[j++] = 'm';
-				buf[j++] = 'p';
-				buf[j++] = ';';
-			} else if (range(u, 0x27, 0x27)) {	// apostrophe
-				buf[j++] = '&';
-				buf[j++] = 'a';
-				buf[j++] = 'p';
-				buf[j++] = 'o';
-				buf[j++] = 's';
-				buf[j++] = ';';
-			} else if (range(u, 0x3C, 0x3C)) {	// less-than sign
-				buf[j++] = '&';
-				buf[j++] = 'l';
-				buf[j++] = 't';
-				buf[j++] = ';';
-			} else if (range(u, 0x3E, 0x3E)) {	// greater-than sign
-				buf[j++] = '&';
-				buf[j++] = 'g';
-				buf[j++] = 't';
-				buf[j++] = ';';
-			}
-		} else {
-			// threat them as ISO8859-1: SOME HACK ANYWAY AS INPUT CHAR SET MAY BE WRONG.
-			if (u >= 0xA1) {	// skip unused and NBSP: 0x7F .. 0xA0
-				// numeric character reference "&#xhhhh;"
-				uint8_t ca = u >> 4;	// A .. F
-				uint8_t cb = u & 0xF;	// 1 .. F
-				buf[j++] = '&';
-				buf[j++] = '#';
-				buf[j++] = 'x';
-				buf[j++] = '0';
-				buf[j++] = '0';
-				buf[j++] = ca < 10 ? '0' + ca : 'A' + (ca - 10);
-				buf[j++] = cb < 10 ? '0' + cb : 'A' + (cb - 10);
-				buf[j++] = ';';
-			}
-		}
-	}
-	buf[j++] = 0;
+	int n;
 
 	fprintf_tab2("<track>\n");
-	fprintf(f, "%s%s%.4d. %s%s\n", T3, "<title>", idx++, buf, "</title>");
+	fprintf_tab3("<title>");
+	for (n = 1000; (n > 1) && (track < n); n /= 10)
+		ob_putc(f, '0');	// "%.4d"
+	ob_putd(f, track);
+	ob_puts(f, ". ");
+	if (s->service_name)
+		ob_puts_escaped(f, s->service_name, ESCAPE_XSPF);
+	ob_puts(f, "</title>\n");
 
 	vlc_dump_dvb_parameters_as_xspf(f, t, flags, lnbp);
 
-	fprintf(f, "%s%s%d%s\n", T4, "<vlc:id>", idx, "</vlc:id>");
-	fprintf(f, "%s%s%d%s\n", T4, "<vlc:option>program=", s->service_id,
-		"</vlc:option>");
+	fprintf_tab4("<vlc:id>");
+	ob_putd(f, track + 1);
+	ob_puts(f, "</vlc:id>\n");
+	fprintf_tab4("<vlc:option>program=");
+	ob_putd(f, s->service_id);
+	ob_puts(f, "</vlc:option>\n");
 	fprintf_tab3("</extension>\n");
 	fprintf_tab2("</track>\n");
 }
@@ -28,19 +28,22 @@
 #include "extended_frontend.h"
 #include "si_types.h"
 #include "scan.h"
+#include "output-buffer.h"
 #include "lnb.h"
 
-void vlc_xspf_prolog(FILE * f,
+void vlc_xspf_prolog(struct output_buffer *f,
 		     uint16_t adapter,
 		     uint16_t frontend,
 		     struct w_scan_flags *flags, struct lnb_types_st *lnbp);
 
-void vlc_dump_service_parameter_set_as_xspf(FILE * f,
+/* 'track': number of this service in the playlist, starting with 1. */
+void vlc_dump_service_parameter_set_as_xspf(struct output_buffer *f,
+					    int track,
 					    struct service *s,
 					    struct transponder *t,
 					    struct w_scan_flags *flags,
 					    struct lnb_types_st *lnbp);
 
-void vlc_xspf_epilog(FILE * f);
+void vlc_xspf_epilog(struct output_buffer *f);
 
 #endif
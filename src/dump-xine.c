@@ -48,80 +48,100 @@ const char *xine_bandwidth_name(int bandwidth)
 	}
 }
 
-void xine_dump_dvb_parameters(FILE * f, struct transponder *t,
+void xine_dump_dvb_parameters(struct output_buffer *f, struct transponder *t,
 			      struct w_scan_flags *flags)
 {
 
 	switch (flags->scantype) {
 	case SCAN_TERRCABLE_ATSC:
-		fprintf(f, "%i:", t->frequency);
-		fprintf(f, "%s", modulation_name(t->modulation));
+		ob_putd(f, t->frequency);
+		ob_putc(f, ':');
+		ob_puts(f, modulation_name(t->modulation));
 		break;
 	case SCAN_CABLE:
-		fprintf(f, "%i:", t->frequency);
-		fprintf(f, "%s:", inversion_name(t->inversion));
-		fprintf(f, "%i:", t->symbolrate);
-		fprintf(f, "%s:", coderate_name(t->coderate));
-		fprintf(f, "%s", modulation_name(t->modulation));
+		ob_putd(f, t->frequency);
+		ob_putc(f, ':');
+		ob_puts(f, inversion_name(t->inversion));
+		ob_putc(f, ':');
+		ob_putd(f, t->symbolrate);
+		ob_putc(f, ':');
+		ob_puts(f, coderate_name(t->coderate));
+		ob_putc(f, ':');
+		ob_puts(f, modulation_name(t->modulation));
 		break;
 	case SCAN_TERRESTRIAL:
-		fprintf(f, "%i:", t->frequency);
-		fprintf(f, "%s:", inversion_name(t->inversion));
-		fprintf(f, "%s:", xine_bandwidth_name(t->bandwidth));
-		fprintf(f, "%s:", coderate_name(t->coderate));
-		fprintf(f, "%s:", coderate_name(t->coderate_LP));
-		fprintf(f, "%s:", modulation_name(t->modulation));
-		fprintf(f, "%s:", transmission_mode_name(t->transmission));
-		fprintf(f, "%s:", guard_interval_name(t->guard));
-		fprintf(f, "%s", hierarchy_name(t->hierarchy));
+		ob_putd(f, t->frequency);
+		ob_putc(f, ':');
+		ob_puts(f, inversion_name(t->inversion));
+		ob_putc(f, ':');
+		ob_puts(f, xine_bandwidth_name(t->bandwidth));
+		ob_putc(f, ':');
+		ob_puts(f, coderate_name(t->coderate));
+		ob_putc(f, ':');
+		ob_puts(f, coderate_name(t->coderate_LP));
+		ob_putc(f, ':');
+		ob_puts(f, modulation_name(t->modulation));
+		ob_putc(f, ':');
+		ob_puts(f, transmission_mode_name(t->transmission));
+		ob_putc(f, ':');
+		ob_puts(f, guard_interval_name(t->guard));
+		ob_putc(f, ':');
+		ob_puts(f, hierarchy_name(t->hierarchy));
 		break;
 	case SCAN_SATELLITE:
-		fprintf(f, "%i:", t->frequency / 1000);
+		ob_putd(f, t->frequency / 1000);
+		ob_putc(f, ':');
 		switch (t->polarization) {
 		case POLARIZATION_HORIZONTAL:
-			fprintf(f, "h:");
+			ob_puts(f, "h:");
 			break;
 		case POLARIZATION_VERTICAL:
-			fprintf(f, "v:");
+			ob_puts(f, "v:");
 			break;
 		case POLARIZATION_CIRCULAR_LEFT:
-			fprintf(f, "l:");
+			ob_puts(f, "l:");
 			break;
 		case POLARIZATION_CIRCULAR_RIGHT:
-			fprintf(f, "r:");
+			ob_puts(f, "r:");
 			break;
 		default:
 			fatal("Unknown Polarization %d\n", t->polarization);
 		}
 
-		if (flags->rotor_position > 0)
-			fprintf(f, "%i:", flags->rotor_position);
-		else
-			fprintf(f, "0:");
+		if (flags->rotor_position > 0) {
+			ob_putd(f, flags->rotor_position);
+			ob_putc(f, ':');
+		} else
+			ob_puts(f, "0:");
 
-		fprintf(f, "%i", t->symbolrate / 1000);
+		ob_putd(f, t->symbolrate / 1000);
 		break;
 	default:
 		fatal("Unknown scantype %d\n", flags->scantype);
 	};
 }
 
-void xine_dump_service_parameter_set(FILE * f,
+void xine_dump_service_parameter_set(struct output_buffer *f,
 				     struct service *s,
 				     struct transponder *t,
 				     struct w_scan_flags *flags)
 {
 	if (s->video_pid || s->audio_pid[0]) {
-		if (s->provider_name)
-			fprintf(f, "%s(%s):", s->service_name,
-				s->provider_name);
-		else
-			fprintf(f, "%s:", s->service_name);
+		ob_puts_escaped(f, s->service_name, ESCAPE_VDR);
+		if (s->provider_name) {
+			ob_putc(f, '(');
+			ob_puts_escaped(f, s->provider_name, ESCAPE_VDR);
+			ob_putc(f, ')');
+		}
+		ob_putc(f, ':');
 		xine_dump_dvb_parameters(f, t, flags);
-		fprintf(f, ":%i:%i:%i", s->video_pid,
-			s->ac3_pid[0] ? s->ac3_pid[0] : s->audio_pid[0],
-			s->service_id);
+		ob_putc(f, ':');
+		ob_putd(f, s->video_pid);
+		ob_putc(f, ':');
+		ob_putd(f, s->ac3_pid[0] ? s->ac3_pid[0] : s->audio_pid[0]);
+		ob_putc(f, ':');
+		ob_putd(f, s->service_id);
 		/* what about AC3 audio here && multiple audio pids? see also: dump_mplayer.c/h */
-		fprintf(f, "\n");
+		ob_putc(f, '\n');
 	}
 }
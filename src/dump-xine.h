@@ -28,11 +28,12 @@
 #include "extended_frontend.h"
 #include "si_types.h"
 #include "scan.h"
+#include "output-buffer.h"
 
-void xine_dump_dvb_parameters(FILE * f, struct transponder *t,
+void xine_dump_dvb_parameters(struct output_buffer *f, struct transponder *t,
 			      struct w_scan_flags *flags);
 
-void xine_dump_service_parameter_set(FILE * f,
+void xine_dump_service_parameter_set(struct output_buffer *f,
 				     struct service *s,
 				     struct transponder *t,
 				     struct w_scan_flags *flags);
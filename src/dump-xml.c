@@ -25,103 +25,125 @@
 
 #include "si_types.h"
 #include "dump-xml.h"
+#include "dvbscan.h"
+
+/* xml_params[] index, in the order the parameters are written. */
+enum __xml_param {
+	XML_MODULATION,
+	XML_BANDWIDTH,
+	XML_CODERATE,
+	XML_SYMBOLRATE,
+	XML_POLARIZATION,
+	XML_TRANSMISSION,
+	XML_GUARD,
+	XML_HIERARCHY,
+	XML_ALPHA,
+	XML_INTERLEAVER,
+	XML_CODERATE_LP,
+	XML_PRIORITY,
+	XML_MPE_FEC,
+	XML_TIME_SLICING,
+	XML_SYSTEM_ID,
+	XML_PLP_ID,
+	XML_OTHER_FREQUENCY_FLAG,
+	XML_EXTENDED_INFO,
+	XML_SISO_MISO,
+	XML_TFS_FLAG,
+	XML_ORBITAL_POSITION,
+	XML_WEST_EAST_FLAG,
+	XML_ROLLOFF,
+	XML_MULTIPLE_INPUT_STREAM_FLAG,
+	XML_SCRAMBLING_SEQUENCE_SELECTOR,
+	XML_SCRAMBLING_SEQUENCE_INDEX,
+	XML_INPUT_STREAM_ID,
+	XML_PILOT,
+	XML_INTERLEAVE,
+	XML_DATA_SLICE_ID,
+	XML_C2_SYSTEM_TUNING_FREQUENCY_TYPE,
+	XML_ACTIVE_OFDM_SYMBOL_DURATION,
+	NUM_XML_PARAMS
+};
 
 typedef struct {
-	char name[32];
-	uint8_t delsys[32];
+	const char *name;
+	uint64_t delsys;	// DS() bits: delivery systems using this param
+	uint64_t always;	// DS() bits: written even if xml_default
 	uint16_t xml_default;
+	uint8_t hierarchical;	// only if hierarchy is used
 } xml_param;
 
+#define DS(d) (1ULL << (d))
 #define NO_AUTO (1<<15)
 
-const xml_param xml_params[] = {
+#define DS_TERR    (DS(SYS_DVBT) | DS(SYS_DVBT2))
+#define DS_SAT     (DS(SYS_DVBS) | DS(SYS_DVBS2) | DS(SYS_DSS) | DS(SYS_TURBO))
+#define DS_CABLE   (DS(SYS_DVBC_ANNEX_A) | DS(SYS_DVBC_ANNEX_B) | DS(SYS_DVBC_ANNEX_C))
+
+static const xml_param xml_params[NUM_XML_PARAMS] = {
+	[XML_MODULATION] = {"modulation", DS_CABLE | DS_TERR | DS_SAT |
+			    DS(SYS_DVBH) | DS(SYS_ISDBT) | DS(SYS_ISDBS) |
+			    DS(SYS_ISDBC) | DS(SYS_ATSC) | DS(SYS_ATSCMH) |
+			    DS(SYS_DTMB) | DS(SYS_CMMB) | DS(SYS_DAB),
+			    DS_TERR | DS(SYS_DVBS) | DS(SYS_DVBS2), QAM_AUTO},
 	// terrestrial_delivery_system_descriptor
-	{"bandwidth", {SYS_DVBT, SYS_DVBT2, 0}, NO_AUTO},
-	{"priority", {SYS_DVBT, SYS_DVBT2, 0}, true},
-	{"time_slicing", {SYS_DVBT, 0}, false},	// EN 301 192
-	{"mpe_fec", {SYS_DVBT, SYS_DVBT2, 0}, false},
-	{"modulation", {SYS_DVBC_ANNEX_A, SYS_DVBC_ANNEX_B, SYS_DVBC_ANNEX_C,
-			SYS_DVBT, SYS_DVBT2,
-			SYS_DVBS, SYS_DVBS2, SYS_DSS, SYS_TURBO,
-			SYS_DVBH,
-			SYS_ISDBT, SYS_ISDBS, SYS_ISDBC,
-			SYS_ATSC, SYS_ATSCMH,
-			SYS_DTMB, SYS_CMMB, SYS_DAB, 0}, QAM_AUTO},
-	{"hierarchy", {SYS_DVBT, SYS_DVBT2, 0}, HIERARCHY_NONE},
-	{"alpha", {SYS_DVBT, SYS_DVBT2, 0}, NO_AUTO},	//Table 46: Signalling format for the avalues and the used interleaver
-	{"interleaver", {SYS_DVBT, SYS_DVBT2, 0}, INTERLEAVE_AUTO},	//Table 46: Signalling format for the avalues and the used interleaver
-	{"coderate", {SYS_DVBT, SYS_DVBT2,
-		      SYS_DVBS, SYS_DVBS2, SYS_DSS, SYS_TURBO,
-		      SYS_DVBC_ANNEX_A, SYS_DVBC_ANNEX_B, SYS_DVBC_ANNEX_C,
-		      SYS_DTMB, 0}, FEC_AUTO},
-	{"coderate_LP", {SYS_DVBT, SYS_DVBT2, 0}, FEC_NONE},
-	{"guard", {SYS_DVBT, SYS_DVBT2, SYS_DTMB, 0}, GUARD_INTERVAL_AUTO},
-	{"transmission", {SYS_DVBT, SYS_DVBT2, SYS_DTMB, 0},
-	 TRANSMISSION_MODE_AUTO},
-	{"other_frequency_flag", {SYS_DVBT, SYS_DVBT2, 0}, 0},
+	[XML_BANDWIDTH] = {"bandwidth", DS_TERR, 0, NO_AUTO},
+	[XML_CODERATE] = {"coderate", DS_TERR | DS_SAT | DS_CABLE | DS(SYS_DTMB),
+			  DS(SYS_DVBS) | DS(SYS_DVBS2), FEC_AUTO},
+	[XML_SYMBOLRATE] = {"symbolrate", DS_SAT | DS_CABLE, 0, NO_AUTO},
+	[XML_POLARIZATION] = {"polarization", DS_SAT, 0, NO_AUTO},
+	[XML_TRANSMISSION] = {"transmission", DS_TERR | DS(SYS_DTMB), 0,
+			      TRANSMISSION_MODE_AUTO},
+	[XML_GUARD] = {"guard", DS_TERR | DS(SYS_DTMB), 0, GUARD_INTERVAL_AUTO},
+	[XML_HIERARCHY] = {"hierarchy", DS_TERR, 0, HIERARCHY_NONE, 1},
+	//Table 46: Signalling format for the avalues and the used interleaver
+	[XML_ALPHA] = {"alpha", DS_TERR, 0, NO_AUTO, 1},
+	[XML_INTERLEAVER] = {"terr_interleaver", DS_TERR, 0, INTERLEAVE_AUTO, 1},
+	[XML_CODERATE_LP] = {"coderate_LP", DS_TERR, 0, FEC_NONE, 1},
+	[XML_PRIORITY] = {"priority", DS_TERR, 0, true, 1},
+	[XML_MPE_FEC] = {"mpe_fec", DS_TERR, 0, false},
+	[XML_TIME_SLICING] = {"time_slicing", DS(SYS_DVBT), 0, false},	// EN 301 192
 	// T2_delivery_system_descriptor
-	{"plp_id", {SYS_DVBT2, SYS_DVBC2, 0}, 0},
-	{"system_id", {SYS_DVBT2, SYS_DVBC2, 0}, 0},
-	{"extended_info", {SYS_DVBT2, 0}, 1},	// T2 delivery system descriptor: 'if (descriptor_length > 4){'
-	{"siso_miso", {SYS_DVBT2, 0}, 0},
-	{"tfs_flag", {SYS_DVBT2, 0}, 0},
-
+	[XML_SYSTEM_ID] = {"system_id", DS(SYS_DVBT2) | DS(SYS_DVBC2), 0, 0},
+	[XML_PLP_ID] = {"plp_id", DS(SYS_DVBT2) | DS(SYS_DVBC2), 0, 0},
+	[XML_OTHER_FREQUENCY_FLAG] = {"other_frequency_flag", DS_TERR, 0, 0},
+	// T2 delivery system descriptor: 'if (descriptor_length > 4){'
+	[XML_EXTENDED_INFO] = {"extended_info", DS(SYS_DVBT2), 0, 1},
+	[XML_SISO_MISO] = {"siso_miso", DS(SYS_DVBT2), 0, 0},
+	[XML_TFS_FLAG] = {"tfs_flag", DS(SYS_DVBT2), 0, 0},
 	// satellite_delivery_system_descriptor
-	{"orbital_position", {SYS_DVBS, SYS_DVBS2, SYS_DSS, SYS_TURBO, 0},
-	 0x0192},
-	{"west_east_flag", {SYS_DVBS, SYS_DVBS2, SYS_DSS, SYS_TURBO, 0}, 'E'},
-	{"polarization", {SYS_DVBS, SYS_DVBS2, SYS_DSS, SYS_TURBO, 0}, NO_AUTO},
-	{"rolloff", {SYS_DVBS2, 0}, ROLLOFF_AUTO},
-	{"symbolrate", {SYS_DVBS, SYS_DVBS2, SYS_DSS, SYS_TURBO,
-			SYS_DVBC_ANNEX_A, SYS_DVBC_ANNEX_B, SYS_DVBC_ANNEX_C,
-			0},
-	 NO_AUTO},
-
+	[XML_ORBITAL_POSITION] = {"orbital_position", DS_SAT, 0, 0x0192},
+	[XML_WEST_EAST_FLAG] = {"west_east_flag", DS_SAT, 0, 'E'},
+	[XML_ROLLOFF] = {"rolloff", DS(SYS_DVBS2), 0, ROLLOFF_AUTO},
 	// see S2_satellite_delivery_system_descriptor
-	{"multiple_input_stream_flag", {SYS_DVBS2, 0}, 0},
-	{"scrambling_sequence_selector", {SYS_DVBS2, 0}, 0},
-	{"scrambling_sequence_index", {SYS_DVBS2, 0}, 0},
-	{"input_stream_id", {SYS_DVBS2, 0}, NO_AUTO},
-	{"pilot", {SYS_DVBS2, 0}, PILOT_AUTO},
-
+	[XML_MULTIPLE_INPUT_STREAM_FLAG] = {"multiple_input_stream_flag",
+					    DS(SYS_DVBS2), 0, 0},
+	[XML_SCRAMBLING_SEQUENCE_SELECTOR] = {"scrambling_sequence_selector",
+					      DS(SYS_DVBS2), 0, 0},
+	[XML_SCRAMBLING_SEQUENCE_INDEX] = {"scrambling_sequence_index",
+					   DS(SYS_DVBS2), 0, 0},
+	[XML_INPUT_STREAM_ID] = {"input_stream_id", DS(SYS_DVBS2), 0, NO_AUTO},
+	[XML_PILOT] = {"pilot", DS(SYS_DVBS2), 0, PILOT_AUTO},
 	//
-	{"interleave", {SYS_DTMB, 0}, INTERLEAVING_AUTO},
-
+	[XML_INTERLEAVE] = {"interleave", DS(SYS_DTMB), 0, INTERLEAVING_AUTO},
 	// C2_delivery_system_descriptor
-	{"data_slice_id", {SYS_DVBC2, 0}, 0},
-	{"C2_System_tuning_frequency_type", {SYS_DVBC2, 0},
-	 C2_SYSTEM_CENTER_FREQUENCY},
-	{"active_OFDM_symbol_duration", {SYS_DVBC2, 0}, FFT_4K_8MHZ},
-	{"", {0}, NO_AUTO},
+	[XML_DATA_SLICE_ID] = {"data_slice_id", DS(SYS_DVBC2), 0, 0},
+	[XML_C2_SYSTEM_TUNING_FREQUENCY_TYPE] = {"C2_System_tuning_frequency_type",
+						 DS(SYS_DVBC2), 0,
+						 C2_SYSTEM_CENTER_FREQUENCY},
+	[XML_ACTIVE_OFDM_SYMBOL_DURATION] = {"active_OFDM_symbol_duration",
+					     DS(SYS_DVBC2), 0, FFT_4K_8MHZ},
 };
 
-#define NUM_XML_PARAMS (sizeof(xml_params) / sizeof(xml_params[0]))
-
-static bool want_to_print(const char *param, uint8_t delsys, uint16_t value)
+static bool want_to_print(enum __xml_param param, uint8_t delsys,
+			  uint32_t value)
 {
-	uint16_t i;
-	uint8_t j;
-	bool found_param = false;
-
-	for (i = 0; i < NUM_XML_PARAMS - 1; i++) {
-		if (strcmp(xml_params[i].name, param))
-			continue;
-		found_param = true;
-		for (j = 0; j < 32; j++) {
-			if (xml_params[i].delsys[j] == 0)
-				break;
-			if (xml_params[i].delsys[j] == delsys) {
-				if (value != xml_params[i].xml_default)
-					return true;
-				else
-					return false;
-			}
-		}
-	}
+	const xml_param *p = &xml_params[param];
 
-	if (!found_param)
-		warning("could not find \"%s\" in list of xml_params\n", param);
-	return false;
+	if (!(p->delsys & DS(delsys)))
+		return false;
+	if (p->always & DS(delsys))
+		return true;
+	return value != p->xml_default;
 }
 
 /*
@@ -163,201 +185,235 @@ static bool want_to_print(const char *param, uint8_t delsys, uint16_t value)
   uint8_t                    data_slice_id;                  // DVB-C2                                              36    //
 */
 
-#define needs_param(p) (want_to_print(#p, t->delsys, t->p))
+#define MAX_INDENT 8
 
 static const char *get_indent(int indent)
 {
-	static char buf[256];
-	memset(&buf[0], ' ', 255);
-	buf[255] = 0;
-	buf[3 * indent] = 0;
-	return &buf[0];
+	static const char spaces[3 * MAX_INDENT + 1] =
+	    "                        ";
+	return &spaces[3 * (MAX_INDENT - indent)];
+}
+
+/******************************************************************************
+ * value and text of a transponder parameter. Returns NULL for params which
+ * are known, but not (yet) written to XML.
+ *****************************************************************************/
+
+static const char *xml_param_text(enum __xml_param param,
+				  struct transponder *t, uint32_t * value,
+				  char *buf, size_t size)
+{
+	switch (param) {
+	case XML_MODULATION:
+		*value = t->modulation;
+		return modulation_name(t->modulation);
+	case XML_BANDWIDTH:
+		*value = t->bandwidth;
+		snprintf(buf, size, "%.3f", (double)t->bandwidth / 1e6);
+		return buf;
+	case XML_CODERATE:
+		*value = t->coderate;
+		return coderate_name(t->coderate);
+	case XML_SYMBOLRATE:
+		*value = t->symbolrate;
+		snprintf(buf, size, "%u", t->symbolrate / 1000);
+		return buf;
+	case XML_POLARIZATION:
+		*value = t->polarization;
+		return sat_pol_to_txt(t->polarization);
+	case XML_TRANSMISSION:
+		*value = t->transmission;
+		return transmission_mode_name(t->transmission);
+	case XML_GUARD:
+		*value = t->guard;
+		return guard_interval_name(t->guard);
+	case XML_HIERARCHY:
+		*value = t->hierarchy;
+		return hierarchy_name(t->hierarchy);
+	case XML_ALPHA:
+		*value = t->alpha;
+		return alpha_name(t->alpha);
+	case XML_INTERLEAVER:
+		*value = t->terr_interleaver;
+		return interleaver_name(t->terr_interleaver);
+	case XML_CODERATE_LP:
+		*value = t->coderate_LP;
+		return coderate_name(t->coderate_LP);
+	case XML_PRIORITY:
+		*value = t->priority;
+		return bool_name(t->priority);
+	case XML_MPE_FEC:
+		*value = t->mpe_fec;
+		return bool_name(t->mpe_fec);
+	case XML_TIME_SLICING:
+		*value = t->time_slicing;
+		return bool_name(t->time_slicing);
+	case XML_SYSTEM_ID:
+		*value = t->system_id;
+		snprintf(buf, size, "%d", t->system_id);
+		return buf;
+	case XML_PLP_ID:
+		*value = t->plp_id;
+		snprintf(buf, size, "%d", t->plp_id);
+		return buf;
+	default:
+		return NULL;
+	}
+}
+
+/******************************************************************************
+ * per transponder and service output, without printf().
+ *****************************************************************************/
+
+/* "<indent><tag" */
+static void xml_open(struct output_buffer *dest, int indent, const char *tag)
+{
+	ob_puts(dest, get_indent(indent));
+	ob_putc(dest, '<');
+	ob_puts(dest, tag);
+}
+
+/* ' name="value"' */
+static void xml_attr_u(struct output_buffer *dest, const char *name,
+		       unsigned long value)
+{
+	ob_putc(dest, ' ');
+	ob_puts(dest, name);
+	ob_puts(dest, "=\"");
+	ob_putu(dest, value);
+	ob_putc(dest, '"');
+}
+
+static void xml_attr_s(struct output_buffer *dest, const char *name,
+		       const char *value)
+{
+	ob_putc(dest, ' ');
+	ob_puts(dest, name);
+	ob_puts(dest, "=\"");
+	ob_puts(dest, value);
+	ob_putc(dest, '"');
+}
+
+/* "<indent><tag>value</tag>\n" */
+static void xml_element(struct output_buffer *dest, int indent,
+			const char *tag, const char *value)
+{
+	xml_open(dest, indent, tag);
+	ob_putc(dest, '>');
+	ob_puts(dest, value);
+	ob_puts(dest, "</");
+	ob_puts(dest, tag);
+	ob_puts(dest, ">\n");
+}
+
+/* "<indent>text\n" */
+static void xml_line(struct output_buffer *dest, int indent, const char *text)
+{
+	ob_puts(dest, get_indent(indent));
+	ob_puts(dest, text);
+	ob_putc(dest, '\n');
+}
+
+/******************************************************************************
+ * write all params of t, which are used by its delivery system, either as
+ * '<param name="value"/>' or as '<name>value</name>'.
+ *****************************************************************************/
+
+static void xml_dump_params(struct output_buffer *dest, struct transponder *t,
+			    int indent, bool as_attribute)
+{
+	uint64_t ds = DS(t->delsys);
+	char buf[32];
+	int i;
+
+	for (i = 0; i < NUM_XML_PARAMS; i++) {
+		const char *text;
+		uint32_t value;
+
+		if (!(xml_params[i].delsys & ds))
+			continue;
+		if (xml_params[i].hierarchical
+		    && (t->hierarchy == HIERARCHY_NONE))
+			continue;	// print those only if hierarchy is used.
+		text = xml_param_text(i, t, &value, buf, sizeof(buf));
+		if ((text == NULL) || !want_to_print(i, t->delsys, value))
+			continue;
+		if (as_attribute) {
+			xml_open(dest, indent, "param");
+			xml_attr_s(dest, xml_params[i].name, text);
+			ob_puts(dest, "/>\n");
+		} else
+			xml_element(dest, indent, xml_params[i].name, text);
+	}
+
+	if ((t->other_frequency_flag != false) && ((t->cells)->count > 0)
+	    && want_to_print(XML_OTHER_FREQUENCY_FLAG, t->delsys, true)) {
+		struct cell *f;
+
+		if (as_attribute) {
+			xml_open(dest, indent, "param");
+			xml_attr_s(dest, "other_frequency_flag", bool_name(true));
+			ob_puts(dest, "/>\n");
+		} else
+			xml_element(dest, indent, "other_frequency_flag",
+				    bool_name(true));
+		xml_line(dest, indent, "<frequency_list>");
+		indent++;
+		for (f = t->cells->first; f; f = f->next) {
+			if (t->tfs_flag)
+				xml_line(dest, indent, "<tfs_center>");
+		}
+		indent--;
+		xml_line(dest, indent, "</frequency_list>");
+	}
 }
 
-void xml_dump(FILE * dest, pList transponders)
+
+void xml_dump(struct output_buffer *dest, pList transponders)
 {
 	struct transponder *t;
 	int indent = 0;
 
-	fprintf(dest, "<?xml version=\"1.0\" ?>\n");
-	fprintf(dest,
+	ob_printf(dest, "<?xml version=\"1.0\" ?>\n");
+	ob_printf(dest,
 		"<!DOCTYPE service_list SYSTEM \"https://raw.githubusercontent.com/stefantalpalaru/w_scan2/master/doc/service_list.dtd\">\n");
-	fprintf(dest, "\n");
-	fprintf(dest, "<!-- NOTE:\n");
-	fprintf(dest, "     if reading or writing w_scan2 XML file format:\n");
-	fprintf(dest, "        - please validate XML against DTD above.\n");
-	fprintf(dest, "        - indent each XML element\n");
-	fprintf(dest,
+	ob_printf(dest, "\n");
+	ob_printf(dest, "<!-- NOTE:\n");
+	ob_printf(dest, "     if reading or writing w_scan2 XML file format:\n");
+	ob_printf(dest, "        - please validate XML against DTD above.\n");
+	ob_printf(dest, "        - indent each XML element\n");
+	ob_printf(dest,
 		"        - indent using three spaces, dont use <TAB> char to indent.\n");
-	fprintf(dest,
+	ob_printf(dest,
 		"        - conform to requirements mentionend in DTD file.\n");
-	fprintf(dest, " -->\n\n");
-	fprintf(dest, "%s<service_list>\n", get_indent(indent));
+	ob_printf(dest, " -->\n\n");
+	ob_printf(dest, "%s<service_list>\n", get_indent(indent));
 
 	indent++;
-	fprintf(dest, "%s<transponders>\n", get_indent(indent));
+	ob_printf(dest, "%s<transponders>\n", get_indent(indent));
 	for (t = transponders->first; t; t = t->next) {
 		indent++;
-		fprintf(dest,
+		ob_printf(dest,
 			"%s<transponder ONID=\"%d\" NID=\"%d\" TSID=\"%d\">\n",
 			get_indent(indent), t->original_network_id,
 			t->network_id, t->transport_stream_id);
 		indent++;
-		fprintf(dest,
+		ob_printf(dest,
 			"%s<params delsys=\"%s\" center_frequency=\"%.3f\">\n",
 			get_indent(indent), delivery_system_name(t->delsys),
 			(double)t->frequency / 1e6);
 		indent++;
-
-		switch (t->delsys) {
-		case SYS_DVBT:
-		case SYS_DVBT2:
-			{
-				if needs_param
-					(modulation)
-					    fprintf(dest,
-						    "%s<param modulation=\"%s\"/>\n",
-						    get_indent(indent),
-						    modulation_name
-						    (t->modulation));
-				if needs_param
-					(bandwidth)
-					    fprintf(dest,
-						    "%s<param bandwidth=\"%.3f\"/>\n",
-						    get_indent(indent),
-						    (double)t->bandwidth / 1e6);
-				if needs_param
-					(coderate)
-					    fprintf(dest,
-						    "%s<param coderate=\"%s\"/>\n",
-						    get_indent(indent),
-						    coderate_name(t->coderate));
-				if needs_param
-					(transmission)
-					    fprintf(dest,
-						    "%s<param transmission=\"%s\"/>\n",
-						    get_indent(indent),
-						    transmission_mode_name
-						    (t->transmission));
-				if needs_param
-					(guard)
-					    fprintf(dest,
-						    "%s<param guard=\"%s\"/>\n",
-						    get_indent(indent),
-						    guard_interval_name
-						    (t->guard));
-				if (t->hierarchy != HIERARCHY_NONE) {
-					// print those only if hierarchy is used.
-					if needs_param
-						(hierarchy)
-						    fprintf(dest,
-							    "%s<param hierarchy=\"%s\"/>\n",
-							    get_indent(indent),
-							    hierarchy_name
-							    (t->hierarchy));
-					if needs_param
-						(alpha)
-						    fprintf(dest,
-							    "%s<param alpha=\"%s\"/>\n",
-							    get_indent(indent),
-							    alpha_name
-							    (t->alpha));
-					if needs_param
-						(terr_interleaver)
-						    fprintf(dest,
-							    "%s<param terr_interleaver=\"%s\"/>\n",
-							    get_indent(indent),
-							    interleaver_name
-							    (t->
-							     terr_interleaver));
-					if needs_param
-						(coderate_LP)
-						    fprintf(dest,
-							    "%s<param coderate_LP=\"%s\"/>\n",
-							    get_indent(indent),
-							    coderate_name
-							    (t->coderate_LP));
-					if needs_param
-						(priority)
-						    fprintf(dest,
-							    "%s<param priority=\"%s\"/>\n",
-							    get_indent(indent),
-							    bool_name
-							    (t->priority));
-				}
-				if needs_param
-					(mpe_fec)
-					    fprintf(dest,
-						    "%s<param mpe_fec=\"%s\"/>\n",
-						    get_indent(indent),
-						    bool_name(t->mpe_fec));
-				if needs_param
-					(time_slicing)
-					    fprintf(dest,
-						    "%s<param time_slicing=\"%s\"/>\n",
-						    get_indent(indent),
-						    bool_name(t->time_slicing));
-				if needs_param
-					(system_id)
-					    fprintf(dest,
-						    "%s<param system_id=\"%d\"/>\n",
-						    get_indent(indent),
-						    t->system_id);
-				if needs_param
-					(plp_id)
-					    fprintf(dest,
-						    "%s<param plp_id=\"%d\"/>\n",
-						    get_indent(indent),
-						    t->plp_id);
-				if ((t->other_frequency_flag != false)
-				    && ((t->cells)->count > 0)) {
-					struct cell *f;
-					if needs_param
-						(other_frequency_flag) {
-						fprintf(dest,
-							"%s<param other_frequency_flag=\"%s\"/>\n",
-							get_indent(indent),
-							bool_name(true));
-						fprintf(dest,
-							"%s<frequency_list>\n",
-							get_indent(indent));
-						indent++;
-						for (f = t->cells->first; f;
-						     f = f->next) {
-							if (t->tfs_flag) {
-								fprintf(dest,
-									"%s<tfs_center>\n",
-									get_indent
-									(indent));
-
-							}
-						}
-
-						indent--;
-						fprintf(dest,
-							"%s</frequency_list>\n",
-							get_indent(indent));
-						}
-				}
-				break;
-			}
-		default:
-			fatal
-			    ("unimplemented delivery system \"%s\"for %s XML output\n",
-			     delivery_system_name(t->delsys), PACKAGE_NAME);
-
-		}
-
+		xml_dump_params(dest, t, indent, true);
 		indent--;
-		fprintf(dest, "%s</params>\n", get_indent(indent));
+		ob_printf(dest, "%s</params>\n", get_indent(indent));
 		indent--;
-		fprintf(dest, "%s</transponder>\n", get_indent(indent));
+		ob_printf(dest, "%s</transponder>\n", get_indent(indent));
 		indent--;
 	}
-	fprintf(dest, "%s</transponders>\n", get_indent(indent));
+	ob_printf(dest, "%s</transponders>\n", get_indent(indent));
 	indent--;
 
-	fprintf(dest, "%s<service_list>\n", get_indent(indent));
+	ob_printf(dest, "%s<service_list>\n", get_indent(indent));
 
 /*
 
@@ -398,163 +454,71 @@ void xml_dump(FILE * dest, pList transponders)
 }
 
 
-void xml_dump_transponders(FILE* dest, pList transponders) {
+void xml_dump_transponders(struct output_buffer *dest, pList transponders) {
 
   struct transponder * t;
   int indent = 1;
 
-  fprintf(dest, "%s<transponders>\n", get_indent(indent));  
+  xml_line(dest, indent, "<transponders>");
 
   for(t = transponders->first; t; t = t->next) {
 		indent++;
-		fprintf(dest, "%s<transponder ONID=\"%d\" NID=\"%d\" TSID=\"%d\">\n",
-					get_indent(indent),
-					t->original_network_id,
-					t->network_id,
-					t->transport_stream_id
-				);
+		xml_open(dest, indent, "transponder");
+		xml_attr_u(dest, "ONID", t->original_network_id);
+		xml_attr_u(dest, "NID", t->network_id);
+		xml_attr_u(dest, "TSID", t->transport_stream_id);
+		ob_puts(dest, ">\n");
 		indent++;
-		fprintf(dest, "%s<delivery_system>%s</delivery_system>\n", get_indent(indent), delivery_system_name(t->delsys));
-		fprintf(dest, "%s<frequency>%.3f</frequency>\n", get_indent(indent), (double) t->frequency/1e6);
+		xml_element(dest, indent, "delivery_system", delivery_system_name(t->delsys));
+		// "%.3f" of frequency / 1e6
+		xml_open(dest, indent, "frequency");
+		ob_putc(dest, '>');
+		ob_putu(dest, (t->frequency + 500) / 1000000);
+		ob_putc(dest, '.');
+		ob_putc(dest, '0' + ((t->frequency + 500) / 100000) % 10);
+		ob_putc(dest, '0' + ((t->frequency + 500) / 10000) % 10);
+		ob_putc(dest, '0' + ((t->frequency + 500) / 1000) % 10);
+		ob_puts(dest, "</frequency>\n");
 	 // fprintf(dest, "%s<params delsys=\"%s\" center_frequency=\"%.3f\">\n",
 	 //		get_indent(indent), delivery_system_name(t->delsys), (double) t->frequency/1e6);
 		//indent++;
 	
-		switch(t->delsys) {
-			case SYS_DVBT:
-			case SYS_DVBT2:
-			{
-			//		   if needs_param(modulation)
-				fprintf(dest, "%s<modulation>%s</modulation>\n", get_indent(indent), modulation_name(t->modulation));
-				
-				if needs_param(bandwidth)
-					fprintf(dest, "%s<bandwidth>%.3f</bandwidth>\n", get_indent(indent), (double) t->bandwidth/1e6);  
-				if needs_param(coderate)
-					fprintf(dest, "%s<coderate>%s</coderate>\n", get_indent(indent), coderate_name(t->coderate)); 
-				if needs_param(symbolrate)
-					fprintf(dest, "%s<symbolrate>%ui</symbolrate>\n", get_indent(indent), t->symbolrate); 
-				if needs_param(transmission)
-					fprintf(dest, "%s<transmission>%s</transmission>\n", get_indent(indent), transmission_mode_name(t->transmission)); 
-				if needs_param(guard)
-					fprintf(dest, "%s<guard>%s</guard>\n", get_indent(indent), guard_interval_name(t->guard)); 
-				if (t->hierarchy != HIERARCHY_NONE) {
-               // print those only if hierarchy is used.
-               if needs_param(hierarchy)
-               fprintf(dest, "%s<hierarchy>%s</hierarchy>\n", get_indent(indent), hierarchy_name(t->hierarchy));
-               
-               if needs_param(alpha)
-                  fprintf(dest, "%s<alpha>%s</alpha>\n", get_indent(indent), alpha_name(t->alpha));
-               if needs_param(terr_interleaver)
-                  fprintf(dest, "%s<terr_interleaver>%s</terr_interleaver>\n", get_indent(indent), interleaver_name(t->terr_interleaver));
-               if needs_param(coderate_LP)
-                  fprintf(dest, "%s<coderate_LP>%s</coderate_LP>\n", get_indent(indent), coderate_name(t->coderate_LP));
-               if needs_param(priority)
-                  fprintf(dest, "%s<priority>%s</priority>\n", get_indent(indent), bool_name(t->priority));
-				}
-				if needs_param(mpe_fec)
-					fprintf(dest, "%s<mpe_fec>%s</mpe_fec>\n", get_indent(indent), bool_name(t->mpe_fec));
-				if needs_param(time_slicing)
-					fprintf(dest, "%s<time_slicing>%s</time_slicing>\n", get_indent(indent), bool_name(t->time_slicing)); 
-				if needs_param(system_id)
-					fprintf(dest, "%s<system_id>%d</system_id>\n", get_indent(indent), t->system_id);
-				if needs_param(plp_id)
-					fprintf(dest, "%s<plp_id>%d</plp_id>\n", get_indent(indent), t->plp_id); 
-	 
-				if ((t->other_frequency_flag != false) && ((t->cells)->count > 0)) {
-					struct cell* f;
-					
-					if needs_param(other_frequency_flag) {
-						fprintf(dest, "%s<other_frequency_flag>%s</other_frequency_flag>\n", get_indent(indent), bool_name(true));
-						fprintf(dest, "%s<frequency_list>\n", get_indent(indent));
-						indent++;
-						for(f = t->cells->first; f; f = f->next) {
-							
-							if (t->tfs_flag) {
-								 fprintf(dest, "%s<tfs_center>\n", get_indent(indent));
-							}
-							else {
-								 //for(g = f->transposers->first; g; g = g->next) {
-								 //   }
-							}
-						}
-		
-						indent--;
-						fprintf(dest, "%s</frequency_list>\n", get_indent(indent));
-					}
-				}
-				break;
-			}
-			case SYS_DVBS2:
-			case SYS_DVBS:
-			{
-				char pol = 0;
- //		   if needs_param(modulation)
-				fprintf(dest, "%s<modulation>%s</modulation>\n", get_indent(indent), modulation_name(t->modulation));            
-				if needs_param(bandwidth)
-					fprintf(dest, "%s<bandwidth>%.3f</bandwidth>\n", get_indent(indent), (double) t->bandwidth/1e6);  
-				//if needs_param(coderate)
-				fprintf(dest, "%s<coderate>%s</coderate>\n", get_indent(indent), coderate_name(t->coderate)); 
-	//		   if needs_param(symbolrate)
-				fprintf(dest, "%s<symbolrate>%u</symbolrate>\n", get_indent(indent), t->symbolrate/1000); 
-	//		   if needs_param(polarization) {
-			 
-				switch (t->polarization) {
-					case POLARIZATION_HORIZONTAL:
-						pol = 'H';
-						break;
-					case POLARIZATION_VERTICAL:
-						pol = 'V';
-						break;
-					default:
-						break;
-			 }
-			 
-			 fprintf(dest, "%s<polarization>%c</polarization>\n", get_indent(indent), pol); 
-	//		   }
-				break;
-			}
-				 
-			default:
-				//fatal("unimplemented delivery system \"%s\"for w_scan XML output\n",
-				//	 delivery_system_name(t->delsys));
-				error("unimplemented delivery system for w_scan XML output\n");
-		} 
-	
-	
-	
-		indent--;     
-		fprintf(dest, "%s</transponder>\n", get_indent(indent));
+		if (!(DS(t->delsys) & (DS_TERR | DS_SAT | DS_CABLE)))
+			error("unimplemented delivery system for w_scan XML output\n");
+		else
+			xml_dump_params(dest, t, indent, false);
+
+		indent--;
+		xml_line(dest, indent, "</transponder>");
 		indent--;
 	}
 
-  fprintf(dest, "%s</transponders>\n", get_indent(indent));
+  xml_line(dest, indent, "</transponders>");
 }
 
-void xml_dump_prolog(FILE* dest) {
+void xml_dump_prolog(struct output_buffer *dest) {
   
-  fprintf(dest, "<?xml version=\"1.0\" encoding=\"iso-8859-1\" standalone=\"yes\"?>\n");
-  fprintf(dest, "<service_list>\n");
+  ob_printf(dest, "<?xml version=\"1.0\" encoding=\"iso-8859-1\" standalone=\"yes\"?>\n");
+  ob_printf(dest, "<service_list>\n");
 /*
-  fprintf(dest, "<!DOCTYPE service_list SYSTEM \"http://wirbel.htpc-forum.de/w_scan/dtd/service_list.dtd\">\n");
-  fprintf(dest, "\n");
-  fprintf(dest, "<!-- NOTE:\n");
-  fprintf(dest, "     if reading or writing w_scan XML file format:\n");
-  fprintf(dest, "        - please validate XML against DTD above.\n");
-  fprintf(dest, "        - indent each XML element\n");
-  fprintf(dest, "        - indent using three spaces, dont use <TAB> char to indent.\n");
-  fprintf(dest, "        - conform to requirements mentionend in DTD file.\n");
-  fprintf(dest, " -->\n\n");
+  ob_printf(dest, "<!DOCTYPE service_list SYSTEM \"http://wirbel.htpc-forum.de/w_scan/dtd/service_list.dtd\">\n");
+  ob_printf(dest, "\n");
+  ob_printf(dest, "<!-- NOTE:\n");
+  ob_printf(dest, "     if reading or writing w_scan XML file format:\n");
+  ob_printf(dest, "        - please validate XML against DTD above.\n");
+  ob_printf(dest, "        - indent each XML element\n");
+  ob_printf(dest, "        - indent using three spaces, dont use <TAB> char to indent.\n");
+  ob_printf(dest, "        - conform to requirements mentionend in DTD file.\n");
+  ob_printf(dest, " -->\n\n");
 */
 }
 
-void xml_dump_epilog(FILE* dest) {
-  fprintf(dest, "</service_list>\n");
+void xml_dump_epilog(struct output_buffer *dest) {
+  ob_printf(dest, "</service_list>\n");
 }
 
-void xml_dump_service_parameter_set (FILE * f, struct service * s, struct transponder * t, struct w_scan_flags * flags)
+void xml_dump_service_parameter_set (struct output_buffer *f, struct service * s, struct transponder * t, struct w_scan_flags * flags)
 {
-  char buffer[1024] = { 0 };
-  
 	  int indent = 2;
 	  
 		//if (s->video_pid || s->audio_pid[0]) {
@@ -568,77 +532,96 @@ void xml_dump_service_parameter_set (FILE * f, struct service * s, struct transp
 		//        fprintf (f, "\n");
 		//        }
 	  
-	  fprintf(f, "%s<service ONID=\"%u\" TSID=\"%u\" SID=\"%u\">\n",
-         get_indent(indent), t->original_network_id, t->transport_stream_id, s->service_id);
+	  xml_open(f, indent, "service");
+	  xml_attr_u(f, "ONID", t->original_network_id);
+	  xml_attr_u(f, "TSID", t->transport_stream_id);
+	  xml_attr_u(f, "SID", s->service_id);
+	  ob_puts(f, ">\n");
 	  indent++;
 	  
 	//   fprintf(f, "%s<network_id>%u</network_id>\n", get_indent(indent), t->original_network_id);
 	//   fprintf(f, "%s<stream_id>%u</stream_id>\n", get_indent(indent), t->transport_stream_id);
 	//   fprintf(f, "%s<service_id>%u</service_id>\n", get_indent(indent), s->service_id);
 
-	  xml_encode_entities(s->service_name, buffer);
 	  //fprintf(f, "%s<name char256=\"%s\"/>\n", get_indent(indent), s->service_name);
-	  fprintf(f, "%s<name char256=\"%s\"/>\n", get_indent(indent), buffer);
-	  fprintf(f, "%s<provider char256=\"%s\"/>\n", get_indent(indent), s->provider_name);
-	  fprintf(f, "%s<pcr pid=\"%u\"/>\n", get_indent(indent), s->pcr_pid);
-	  fprintf(f, "%s<logical channel_number=\"%u\"/>\n", get_indent(indent), s->logical_channel_number);
-
-      fprintf(f, "%s<streams>\n", get_indent(indent));
+	  ob_puts(f, get_indent(indent));
+	  ob_puts(f, "<name char256=\"");
+	  ob_puts_escaped(f, s->service_name, ESCAPE_XML);
+	  ob_puts(f, "\"/>\n");
+	  ob_puts(f, get_indent(indent));
+	  ob_puts(f, "<provider char256=\"");
+	  ob_puts_escaped(f, s->provider_name, ESCAPE_XML);
+	  ob_puts(f, "\"/>\n");
+	  xml_open(f, indent, "pcr");
+	  xml_attr_u(f, "pid", s->pcr_pid);
+	  ob_puts(f, "/>\n");
+	  xml_open(f, indent, "logical");
+	  xml_attr_u(f, "channel_number", s->logical_channel_number);
+	  ob_puts(f, "/>\n");
+
+      xml_line(f, indent, "<streams>");
       indent++;
       // Video Stream
-      fprintf(f, "%s<stream type=\"%u\" pid=\"%u\" description=\"%s\"/>\n",
-         get_indent(indent),
-         s->video_stream_type,
-         s->video_pid,
-         get_stream_type_description(s->video_stream_type));
+      xml_open(f, indent, "stream");
+      xml_attr_u(f, "type", s->video_stream_type);
+      xml_attr_u(f, "pid", s->video_pid);
+      xml_attr_s(f, "description", get_stream_type_description(s->video_stream_type));
+      ob_puts(f, "/>\n");
       // Audio Streams
       for (int i=0; i<AUDIO_CHAN_MAX; i++) {
-         if (s->audio_stream_type[i])
-            fprintf(f, "%s<stream type=\"%u\" pid=\"%u\" description=\"%s\" language_code=\"%s\"/>\n",
-               get_indent(indent),
-               s->audio_stream_type[i],
-               s->audio_pid[i],
-               get_stream_type_description(s->audio_stream_type[i]),
-               s->audio_lang[i]);
+         if (s->audio_stream_type[i]) {
+            xml_open(f, indent, "stream");
+            xml_attr_u(f, "type", s->audio_stream_type[i]);
+            xml_attr_u(f, "pid", s->audio_pid[i]);
+            xml_attr_s(f, "description", get_stream_type_description(s->audio_stream_type[i]));
+            xml_attr_s(f, "language_code", s->audio_lang[i]);
+            ob_puts(f, "/>\n");
+         }
       }
       // AC3 Streams
       for (int i=0; i<AC3_CHAN_MAX; i++) {
-         if (s->ac3_stream_type[i])
-            fprintf(f, "%s<stream type=\"%u\" pid=\"%u\" description=\"%s\" language_code=\"%s\"/>\n",
-               get_indent(indent),
-               s->ac3_stream_type[i],
-               s->ac3_pid[i],
-               get_stream_type_description(s->ac3_stream_type[i]),
-               s->ac3_lang[i]);
+         if (s->ac3_stream_type[i]) {
+            xml_open(f, indent, "stream");
+            xml_attr_u(f, "type", s->ac3_stream_type[i]);
+            xml_attr_u(f, "pid", s->ac3_pid[i]);
+            xml_attr_s(f, "description", get_stream_type_description(s->ac3_stream_type[i]));
+            xml_attr_s(f, "language_code", s->ac3_lang[i]);
+            ob_puts(f, "/>\n");
+         }
       }
       indent--;
-      fprintf(f, "%s</streams>\n", get_indent(indent));
-      fprintf(f, "%s<subtitles>\n", get_indent(indent));
+      xml_line(f, indent, "</streams>");
+      xml_line(f, indent, "<subtitles>");
       indent++;
       // Subtitles
       for (int i=0; i<SUBTITLES_MAX; i++) {
-         if (s->subtitling_pid[i])
-            fprintf(f, "%s<subtitle pid=\"%u\" type=\"%u\" composition_page=\"%u\" ancillary_page=\"%u\" language_code=\"%s\"/>\n",
-               get_indent(indent),
-               s->subtitling_pid[i],
-               s->subtitling_type[i],
-               s->composition_page_id[i],
-               s->ancillary_page_id[i],
-               s->subtitling_lang[i]);
+         if (s->subtitling_pid[i]) {
+            xml_open(f, indent, "subtitle");
+            xml_attr_u(f, "pid", s->subtitling_pid[i]);
+            xml_attr_u(f, "type", s->subtitling_type[i]);
+            xml_attr_u(f, "composition_page", s->composition_page_id[i]);
+            xml_attr_u(f, "ancillary_page", s->ancillary_page_id[i]);
+            xml_attr_s(f, "language_code", s->subtitling_lang[i]);
+            ob_puts(f, "/>\n");
+         }
       }
       indent--;
-      fprintf(f, "%s</subtitles>\n", get_indent(indent));
-      fprintf(f, "%s<CA_systems>\n", get_indent(indent));
+      xml_line(f, indent, "</subtitles>");
+      xml_line(f, indent, "<CA_systems>");
       indent++;
       for (int i=0; i<CA_SYSTEM_ID_MAX; i++) {
-         if (s->ca_id[i])
-            fprintf(f, "%sCA_system name=\"CA_System_Dummy\" ca_id=\"%u\"\n", get_indent(indent),s->ca_id[i]);
+         if (s->ca_id[i]) {
+            ob_puts(f, get_indent(indent));
+            ob_puts(f, "CA_system name=\"CA_System_Dummy\"");
+            xml_attr_u(f, "ca_id", s->ca_id[i]);
+            ob_putc(f, '\n');
+         }
       }
       indent--;
-      fprintf(f, "%s</CA_systems>\n", get_indent(indent));
-      fprintf(f, "%s<comment char256=\"\"/>\n", get_indent(indent));
+      xml_line(f, indent, "</CA_systems>");
+      xml_line(f, indent, "<comment char256=\"\"/>");
 	  indent--;
-	  fprintf(f, "%s</service>\n", get_indent(indent));
+	  xml_line(f, indent, "</service>");
 }
 
 
@@ -663,47 +646,5 @@ void xml_dump_service_parameter_set (FILE * f, struct service * s, struct transp
    </services>
 </service_list>
 */
-void xml_dump_services_open(FILE* dest) { fprintf(dest, "%s<services>\n", get_indent(1)); }
-void xml_dump_services_close(FILE* dest) { fprintf(dest, "%s</services>\n", get_indent(1)); }
-
-void xml_encode_entities(char *src, char *dst)
-{
-  if (src != NULL) {
-    
-    int len = 0;
-    int i   = 0;
-    int a   = 0;
-    
-    len = strlen(src);
-    
-    for (i=0;i<len;i++) {
-      
-      switch ( src[i] ) {
-        case '"':
-          sprintf(&dst[a], "&quot;");
-          a += 6;
-          break;
-        case '\'':
-          sprintf(&dst[a], "&apos;");
-          a += 6;
-          break;
-        case '<':
-          sprintf(&dst[a], "&lt;");
-          a += 4;
-          break;
-        case '>':
-          sprintf(&dst[a], "&gt;");
-          a += 4;
-          break;
-        case '&':
-          sprintf(&dst[a], "&amp;");
-          a += 5;
-          break;
-        default:
-          dst[a] = src[i];
-          a++;
-          break;
-      }
-    }
-  }
-}
+void xml_dump_services_open(struct output_buffer *dest) { xml_line(dest, 1, "<services>"); }
+void xml_dump_services_close(struct output_buffer *dest) { xml_line(dest, 1, "</services>"); }
@@ -24,17 +24,17 @@
 /* 20140628 --wk */
 #include <stdio.h>
 #include "tools.h"
+#include "output-buffer.h"
 
 extern struct w_scan_flags;
 
-void xml_dump(FILE * dest, pList transponders);
-void xml_dump_transponders(FILE* dest, pList transponders);
-void xml_dump_prolog(FILE* dest);
-void xml_dump_epilog(FILE* dest);
+void xml_dump(struct output_buffer *dest, pList transponders);
+void xml_dump_transponders(struct output_buffer *dest, pList transponders);
+void xml_dump_prolog(struct output_buffer *dest);
+void xml_dump_epilog(struct output_buffer *dest);
 
-void xml_dump_services_open(FILE* dest);
-void xml_dump_service_parameter_set (FILE * f, struct service * s, struct transponder * t, struct w_scan_flags * flags);
-void xml_dump_services_close(FILE* dest);
-void xml_encode_entities(char *src, char *dst);
+void xml_dump_services_open(struct output_buffer *dest);
+void xml_dump_service_parameter_set (struct output_buffer *f, struct service * s, struct transponder * t, struct w_scan_flags * flags);
+void xml_dump_services_close(struct output_buffer *dest);
 
 #endif
@@ -10,6 +10,7 @@
 #include "dump-xine.h"		// debugging transponder.
 #include "dvbscan.h"		// debugging transponder.
 #include "tools.h"		// hexdump
+#include "stats.h"
 
 #define Hz   1
 #define kHz (1000 * Hz)
@@ -42,8 +43,8 @@ typedef struct {
  /*
   * list of DVB SI data and list of running demux filters.
   */
-cList __em_buf1, *em_runningfilters = &__em_buf1;
-cList __em_buf2, *em_sidata = &__em_buf2;
+static __thread cList __em_buf1, *em_runningfilters = NULL;
+static __thread cList __em_buf2, *em_sidata = NULL;
 
  /*
   * drivers DVB API.
@@ -51,7 +52,7 @@ cList __em_buf2, *em_sidata = &__em_buf2;
   *   - API defaults to 5.3
   *   - if not overwritten from log -> bug.
   */
-struct {
+static __thread struct {
 	unsigned major;
 	unsigned minor;
 } em_api = {
@@ -63,7 +64,7 @@ struct {
   *   - state is set by em_setproperty and returned by em_getproperty
   *   - not to be exposed outside this file.
   */
-static struct {
+static __thread struct {
 	unsigned w_scan_version;
 	uint32_t w_scan_flags;
 	fe_delivery_system_t delsys;
@@ -118,6 +119,8 @@ extern void parse_psip_vct(const unsigned char *buf, uint16_t section_length,
   */
 void em_init(const char *log)
 {
+	em_runningfilters = &__em_buf1;
+	em_sidata = &__em_buf2;
 	NewList(em_runningfilters, "em_runningfilters");
 	NewList(em_sidata, "em_sidata");
 	memset(&em_device, 0, sizeof(em_device));
@@ -507,6 +510,7 @@ void em_readfilters(int *result)
 			}
 			EM_INFO(" -> OK.\n");
 			data_found = true;
+			stats_section(filter->table_id);
 
 			switch (filter->table_id) {
 			case TABLE_PAT:
@@ -576,8 +580,10 @@ void em_readfilters(int *result)
 				info("%spid %u after %lld seconds\n", intro,
 				     filter->pid, (long long)filter->timeout);
 			}
+			stats_filter_timeout(filter->table_id);
 			*result = 0;
-		}
+		} else
+			stats_filter_done(filter->table_id);
 		UnlinkItem(em_runningfilters, filter,
 			   filter->flags & SECTION_FLAG_FREE ? true : false);
 	}
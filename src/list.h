@@ -0,0 +1,63 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __LIST_H__
+#define __LIST_H__
+
+#include <stdint.h>
+
+#ifndef bool
+typedef int bool;
+#define false 0
+#define true  !(false)
+#endif
+
+/*******************************************************************************
+/* double linked list.
+ ******************************************************************************/
+
+typedef int (*cmp_func) (void *a, void *b);
+typedef bool(*fnd_func) (void *a);
+
+typedef struct {
+	void *first;
+	void *last;
+	uint32_t count;
+	char *name;
+	bool lock;
+} cList, *pList;
+
+typedef struct {
+	void *prev;
+	void *next;
+	uint32_t index;
+} cItem, *pItem;
+
+void NewList(pList const list, const char *name);
+void ClearList(pList list);
+void SortList(pList list, cmp_func compare);
+void AddItem(pList list, void *item);
+void DeleteItem(pList list, void *item);
+void SwapItem(pList list, pItem a, pItem b);
+void UnlinkItem(pList list, void *item, bool freemem);
+void InsertItem(pList list, void *item, uint32_t index);
+void *GetItem(pList list, uint32_t index);
+bool IsMember(pList list, void *item);
+
+#endif
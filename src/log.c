@@ -0,0 +1,251 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sched.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "tools.h"
+
+/******************************************************************************
+ * asynchronous logging: dprintf() and friends format into a ring buffer,
+ * a writer thread copies it to stderr. Producers, i.e. concurrent scans
+ * with their own scan_context, claim space by advancing 'reserved' and
+ * publish by advancing 'head' in the same order. All three counters count
+ * bytes and never wrap, the ring position is 'counter & LOG_RING_MASK'.
+ *
+ * An idle writer sleeps on a futex and is woken by the next log_write(),
+ * log_flush() and a full ring sleep until the writer advanced 'tail'.
+ * Wakeups are only sent if someone set the matching '*_waiting' flag.
+ *
+ * Until log_init() and after log_sync() all output is written directly.
+ *****************************************************************************/
+
+#define LOG_RING_SIZE  (1 << 20)
+#define LOG_RING_MASK  (LOG_RING_SIZE - 1)
+#define LOG_LINE_SIZE  1024
+
+static char ring[LOG_RING_SIZE];
+static atomic_size_t reserved;	// claimed by producers
+static atomic_size_t head;	// published by producers
+static atomic_size_t tail;	// written by writer thread
+static atomic_int running;	// writer thread active
+static atomic_int stopping;
+static pthread_t writer;
+static atomic_uint head_seq;	// futex: bumped on new data for idle writer
+static atomic_uint tail_seq;	// futex: bumped when writer advanced 'tail'
+static atomic_int writer_waiting;
+static atomic_int tail_waiting;
+
+static void futex_wait(atomic_uint * addr, unsigned val)
+{
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint * addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+static void wake_writer(void)
+{
+	if (atomic_exchange(&writer_waiting, 0)) {
+		atomic_fetch_add(&head_seq, 1);
+		futex_wake(&head_seq);
+	}
+}
+
+/* sleep until the writer wrote everything before 'pos'. */
+static void wait_tail(size_t pos)
+{
+	unsigned seq;
+
+	while (atomic_load(&tail) < pos) {
+		atomic_store(&tail_waiting, 1);
+		seq = atomic_load(&tail_seq);
+		if (atomic_load(&tail) >= pos)
+			break;
+		futex_wait(&tail_seq, seq);
+	}
+}
+
+static void write_all(const char *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = write(STDERR_FILENO, buf, len)) < 0) {
+			if (errno == EINTR)
+				continue;
+			return;	// nowhere to report.
+		}
+		buf += n;
+		len -= n;
+	}
+}
+
+static void *writer_thread(void *arg)
+{
+	size_t t, h, n;
+	unsigned seq;
+
+	for (;;) {
+		t = atomic_load_explicit(&tail, memory_order_relaxed);
+		h = atomic_load_explicit(&head, memory_order_acquire);
+		if (h == t) {
+			if (atomic_load(&stopping))
+				break;
+			// announce the sleep, then check once more for new data.
+			atomic_store(&writer_waiting, 1);
+			seq = atomic_load(&head_seq);
+			if ((atomic_load(&head) == t) && !atomic_load(&stopping))
+				futex_wait(&head_seq, seq);
+			continue;
+		}
+		// up to the end of the ring, rest in next round.
+		n = min(h - t, LOG_RING_SIZE - (t & LOG_RING_MASK));
+		write_all(ring + (t & LOG_RING_MASK), n);
+		atomic_store(&tail, t + n);
+		if (atomic_exchange(&tail_waiting, 0)) {
+			atomic_fetch_add(&tail_seq, 1);
+			futex_wake(&tail_seq);
+		}
+	}
+	return NULL;
+}
+
+/* signals, i.e. SIGINT, are handled by the scanning thread only. */
+static void start_writer(void)
+{
+	sigset_t all, old;
+
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	atomic_store(&stopping, 0);
+	if (pthread_create(&writer, NULL, writer_thread, NULL) == 0)
+		atomic_store(&running, 1);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+/* fork() copies only the calling thread: flush before, restart in child. */
+static void before_fork(void)
+{
+	log_flush();
+}
+
+static void child_after_fork(void)
+{
+	if (atomic_load(&running))
+		start_writer();
+}
+
+void log_init(void)
+{
+	static int initialized = 0;
+
+	if (initialized++)
+		return;
+	pthread_atfork(before_fork, NULL, child_after_fork);
+	atexit(log_sync);	// fatal() and every other exit()
+	start_writer();
+}
+
+void log_write(const char *buf, size_t len)
+{
+	size_t h, pos, n;
+
+	if (!atomic_load_explicit(&running, memory_order_relaxed)
+	    || (len > LOG_RING_SIZE / 2)) {
+		log_flush();
+		write_all(buf, len);
+		return;
+	}
+
+	h = atomic_fetch_add_explicit(&reserved, len, memory_order_relaxed);
+	// ring full: wait for the writer.
+	if (h + len - atomic_load_explicit(&tail, memory_order_acquire) >
+	    LOG_RING_SIZE)
+		wait_tail(h + len - LOG_RING_SIZE);
+
+	pos = h & LOG_RING_MASK;
+	n = min(len, (size_t) LOG_RING_SIZE - pos);
+	memcpy(ring + pos, buf, n);
+	memcpy(ring, buf + n, len - n);
+	// publish after all earlier claims.
+	while (atomic_load_explicit(&head, memory_order_acquire) != h)
+		sched_yield();
+	atomic_store(&head, h + len);
+	wake_writer();
+}
+
+void log_printf(const char *fmt, ...)
+{
+	char line[LOG_LINE_SIZE];
+	char *p;
+	va_list ap;
+	int len;
+
+	va_start(ap, fmt);
+	len = vsnprintf(line, sizeof(line), fmt, ap);
+	va_end(ap);
+	if (len < 0)
+		return;
+	if ((size_t) len < sizeof(line)) {
+		log_write(line, len);
+		return;
+	}
+
+	// rare: long line.
+	if ((p = malloc(len + 1)) == NULL)
+		return;
+	va_start(ap, fmt);
+	vsnprintf(p, len + 1, fmt, ap);
+	va_end(ap);
+	log_write(p, len);
+	free(p);
+}
+
+/* wait until everything logged so far is written. */
+void log_flush(void)
+{
+	if (!atomic_load(&running))
+		return;
+	wait_tail(atomic_load(&head));
+}
+
+/* write pending output and continue synchronously, i.e. on exit or signal. */
+void log_sync(void)
+{
+	if (!atomic_load(&running))
+		return;
+	atomic_store(&stopping, 1);
+	atomic_store(&writer_waiting, 1);	// wake it in any case.
+	wake_writer();
+	pthread_join(writer, NULL);
+	atomic_store(&running, 0);
+}
@@ -0,0 +1,42 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <signal.h>
+#include <unistd.h>
+#include "w_scan2.h"
+
+static struct scan_context *scan;
+
+/* first SIGINT: stop and write the partial result, second one: give up. */
+static void handle_sigint(int sig)
+{
+	static volatile sig_atomic_t count;
+
+	(void)sig;
+	if (count++)
+		_exit(2);
+	scan_interrupt(scan);
+}
+
+int main(int argc, char **argv)
+{
+	scan = scan_context_new();
+	signal(SIGINT, handle_sigint);
+	return scan_run(scan, argc, argv);
+}
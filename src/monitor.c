@@ -0,0 +1,467 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "tools.h"
+#include "descriptors.h"
+#include "scan.h"
+#include "monitor.h"
+
+/******************************************************************************
+ * a table with a new version is parsed into the same transponder and
+ * services as before. monitor_version() keeps a copy of what the table
+ * describes and resets the fields the parser only adds to, so that
+ * monitor_table_done() can compare old and new state.
+ *****************************************************************************/
+
+struct snapshot {
+	void *prev;
+	void *next;
+	uint32_t index;
+	int table_id;
+	int table_id_ext;
+	int count;
+	struct service *services;	// copies, with own names.
+	char *network_name;
+	network_change_t network_change;
+};
+
+// per scan thread, as the scan_context in scan.c.
+static __thread int monitor_fd = -1;
+static __thread cList _snapshots, *snapshots = NULL;
+
+/******************************************************************************
+ * JSON output, one write() per event.
+ *****************************************************************************/
+
+static void emit(const char *buf, int len)
+{
+	if (write(monitor_fd, buf, len) != len) {
+		warning("could not write monitor events, stopped.\n");
+		if (monitor_fd > 2)
+			close(monitor_fd);
+		monitor_fd = -1;
+	}
+}
+
+static int json_string(char *buf, size_t size, const char *s)
+{
+	size_t len = 0;
+
+	if (size < 3)
+		return 0;
+	buf[len++] = '"';
+	for (; s && *s && (len + 8 < size); s++) {
+		unsigned char c = *s;
+		if ((c == '"') || (c == '\\')) {
+			buf[len++] = '\\';
+			buf[len++] = c;
+		} else if (c < 0x20)
+			len += sprintf(buf + len, "\\u%04x", c);
+		else
+			buf[len++] = c;
+	}
+	buf[len++] = '"';
+	buf[len] = 0;
+	return len;
+}
+
+static int json_pids(char *buf, size_t size, const char *key,
+		     const uint16_t * pids, int count)
+{
+	int i, len = snprintf(buf, size, ",\"%s\":[", key);
+
+	for (i = 0; i < count; i++)
+		len += snprintf(buf + len, size - len, "%s%u", i ? "," : "",
+				pids[i]);
+	return len + snprintf(buf + len, size - len, "]");
+}
+
+static int json_service_pids(char *buf, size_t size, struct service *s)
+{
+	int len = snprintf(buf, size,
+			   "{\"pmt\":%u,\"pcr\":%u,\"video\":%u,\"teletext\":%u",
+			   s->pmt_pid, s->pcr_pid, s->video_pid,
+			   s->teletext_pid);
+
+	len += json_pids(buf + len, size - len, "audio", s->audio_pid,
+			 s->audio_num);
+	len += json_pids(buf + len, size - len, "ac3", s->ac3_pid, s->ac3_num);
+	len += json_pids(buf + len, size - len, "subtitling",
+			 s->subtitling_pid, s->subtitling_num);
+	return len + snprintf(buf + len, size - len, "}");
+}
+
+/* fmt adds fields after time, event and transponder, starting with ','. */
+static void event(struct transponder *t, const char *name, const char *fmt,
+		  ...)
+{
+	char buf[4096];
+	struct tm tm;
+	time_t now = time(NULL);
+	int len;
+	va_list ap;
+
+	if (monitor_fd < 0)
+		return;
+	gmtime_r(&now, &tm);
+	len = strftime(buf, sizeof(buf), "{\"time\":\"%Y-%m-%dT%H:%M:%SZ\"", &tm);
+	len += snprintf(buf + len, sizeof(buf) - len,
+			",\"event\":\"%s\",\"frequency\":%u,\"onid\":%u,"
+			"\"tsid\":%u", name, t->frequency,
+			t->original_network_id, t->transport_stream_id);
+	va_start(ap, fmt);
+	len += vsnprintf(buf + len, sizeof(buf) - len, fmt, ap);
+	va_end(ap);
+	if (len > (int)sizeof(buf) - 3)
+		len = sizeof(buf) - 3;
+	len += sprintf(buf + len, "}\n");
+	emit(buf, len);
+}
+
+static void service_event(struct transponder *t, const char *name,
+			  struct service *s, const char *fmt, ...)
+{
+	char args[3072], str[1024];
+	int len;
+	va_list ap;
+
+	json_string(str, sizeof(str), s->service_name);
+	len = snprintf(args, sizeof(args), ",\"sid\":%u,\"name\":%s",
+		       s->service_id, str);
+	va_start(ap, fmt);
+	vsnprintf(args + len, sizeof(args) - len, fmt, ap);
+	va_end(ap);
+	event(t, name, "%s", args);
+}
+
+static const char *table_name(int table_id)
+{
+	switch (table_id) {
+	case TABLE_PAT:
+		return "PAT";
+	case TABLE_PMT:
+		return "PMT";
+	case TABLE_NIT_ACT:
+		return "NIT(actual)";
+	case TABLE_SDT_ACT:
+		return "SDT(actual)";
+	default:
+		return "table";
+	}
+}
+
+void monitor_open(const char *file)
+{
+	if (strcmp(file, "-") == 0)
+		monitor_fd = STDOUT_FILENO;
+	else
+		monitor_fd = open(file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (monitor_fd < 0)
+		fatal("could not open monitor file '%s'\n", file);
+	snapshots = &_snapshots;
+	NewList(snapshots, "monitor_snapshots");
+}
+
+bool monitor_enabled(void)
+{
+	return monitor_fd >= 0;
+}
+
+void monitor_start(struct transponder *t)
+{
+	event(t, "monitor_start", ",\"delsys\":%u,\"services\":%u",
+	      t->delsys, t->services->count);
+}
+
+void monitor_lock(struct transponder *t, bool locked)
+{
+	event(t, locked ? "lock" : "lock_lost", "");
+}
+
+/******************************************************************************
+ * snapshots.
+ *****************************************************************************/
+
+static struct snapshot *find_snapshot(int table_id, int table_id_ext)
+{
+	struct snapshot *p;
+
+	for (p = snapshots->first; p; p = p->next)
+		if ((p->table_id == table_id)
+		    && (p->table_id_ext == table_id_ext))
+			return p;
+	return NULL;
+}
+
+static void free_network_change(network_change_t *nc)
+{
+	int i;
+
+	for (i = 0; i < nc->num_networks; i++)
+		free(nc->network[i].loop);
+	free(nc->network);
+	nc->num_networks = 0;
+	nc->network = NULL;
+}
+
+static void free_snapshot(struct snapshot *p)
+{
+	int i;
+
+	for (i = 0; i < p->count; i++) {
+		free(p->services[i].service_name);
+		free(p->services[i].provider_name);
+	}
+	free(p->services);
+	free(p->network_name);
+	free_network_change(&p->network_change);
+	UnlinkItem(snapshots, p, true);
+}
+
+static struct service *old_service(struct snapshot *p, uint16_t service_id)
+{
+	int i;
+
+	for (i = 0; i < p->count; i++)
+		if (p->services[i].service_id == service_id)
+			return &p->services[i];
+	return NULL;
+}
+
+static void copy_service(struct service *dest, struct service *s)
+{
+	*dest = *s;
+	dest->service_name = s->service_name ? strdup(s->service_name) : NULL;
+	dest->provider_name =
+	    s->provider_name ? strdup(s->provider_name) : NULL;
+}
+
+/* fields parse_pmt() only sets if unset or appends to. */
+static void reset_pids(struct service *s)
+{
+	s->video_pid = 0;
+	s->teletext_pid = 0;
+	s->audio_num = 0;
+	s->ac3_num = 0;
+	s->subtitling_num = 0;
+}
+
+void monitor_version(struct transponder *t, int table_id, int table_id_ext,
+		     int old_version, int new_version)
+{
+	struct snapshot *p;
+	struct service *s;
+
+	if (monitor_fd < 0)
+		return;
+	if (old_version >= 0)
+		event(t, "version", ",\"table\":\"%s\",\"table_id_ext\":%d,"
+		      "\"old\":%d,\"new\":%d", table_name(table_id),
+		      table_id_ext, old_version, new_version);
+
+	// changed again before complete: compare with the older state.
+	if ((p = find_snapshot(table_id, table_id_ext)) == NULL) {
+		if ((p = calloc(1, sizeof(*p))) == NULL)
+			fatal("out of memory\n");
+		p->table_id = table_id;
+		p->table_id_ext = table_id_ext;
+		p->services = calloc(t->services->count + 1, sizeof(*s));
+		if (p->services == NULL)
+			fatal("out of memory\n");
+		for (s = t->services->first; s; s = s->next)
+			if ((table_id != TABLE_PMT)
+			    || (s->service_id == table_id_ext))
+				copy_service(&p->services[p->count++], s);
+		p->network_name =
+		    t->network_name ? strdup(t->network_name) : NULL;
+		if (table_id == TABLE_NIT_ACT) {
+			// moved: NIT fills a new one into t.
+			p->network_change = t->network_change;
+			t->network_change.num_networks = 0;
+			t->network_change.network = NULL;
+		}
+		AddItem(snapshots, p);
+	} else if (table_id == TABLE_NIT_ACT) {
+		network_change_t nc = t->network_change;	// incomplete version.
+
+		free_network_change(&nc);
+		t->network_change = nc;
+	}
+
+	switch (table_id) {
+	case TABLE_PAT:
+		for (s = t->services->first; s; s = s->next)
+			s->pmt_pid = 0;
+		break;
+	case TABLE_PMT:
+		if ((s = find_service(t, table_id_ext)) != NULL)
+			reset_pids(s);
+		break;
+	default:;
+	}
+}
+
+static bool same_pids(struct service *a, struct service *b)
+{
+	return (a->pmt_pid == b->pmt_pid) && (a->pcr_pid == b->pcr_pid) &&
+	    (a->video_pid == b->video_pid) &&
+	    (a->teletext_pid == b->teletext_pid) &&
+	    (a->audio_num == b->audio_num) &&
+	    !memcmp(a->audio_pid, b->audio_pid,
+		    a->audio_num * sizeof(a->audio_pid[0])) &&
+	    (a->ac3_num == b->ac3_num) &&
+	    !memcmp(a->ac3_pid, b->ac3_pid,
+		    a->ac3_num * sizeof(a->ac3_pid[0])) &&
+	    (a->subtitling_num == b->subtitling_num) &&
+	    !memcmp(a->subtitling_pid, b->subtitling_pid,
+		    a->subtitling_num * sizeof(a->subtitling_pid[0]));
+}
+
+static bool same_string(const char *a, const char *b)
+{
+	return strcmp(a ? a : "", b ? b : "") == 0;
+}
+
+static bool same_network_change(network_change_t * a, network_change_t * b)
+{
+	int i, j;
+
+	if (a->num_networks != b->num_networks)
+		return false;
+	for (i = 0; i < a->num_networks; i++) {
+		changed_network_t *x = &a->network[i], *y = &b->network[i];
+		if ((x->ofdm_cell_id != y->ofdm_cell_id)
+		    || (x->num_changes != y->num_changes))
+			return false;
+		for (j = 0; j < x->num_changes; j++)
+			if ((x->loop[j].network_change_id !=
+			     y->loop[j].network_change_id)
+			    || (x->loop[j].network_change_version !=
+				y->loop[j].network_change_version))
+				return false;
+	}
+	return true;
+}
+
+static void network_change_event(struct transponder *t)
+{
+	network_change_t change = t->network_change, *nc = &change;
+	char args[3072];
+	int i, j, len = 0;
+
+	len += snprintf(args + len, sizeof(args) - len, ",\"changes\":[");
+	for (i = 0; i < nc->num_networks; i++) {
+		changed_network_t *cn = &nc->network[i];
+		for (j = 0; j < cn->num_changes; j++) {
+			network_change_loop_t *l = &cn->loop[j];
+			len += snprintf(args + len, sizeof(args) - len,
+					"%s{\"cell_id\":%u,\"id\":%u,"
+					"\"version\":%u,\"start\":%lld,"
+					"\"duration\":%lld,\"type\":%u}",
+					(i || j) ? "," : "", cn->ofdm_cell_id,
+					l->network_change_id,
+					l->network_change_version,
+					(long long)l->start_time_of_change,
+					(long long)l->change_duration,
+					l->change_type);
+			if (len >= (int)sizeof(args) - 128)
+				break;
+		}
+	}
+	snprintf(args + len, sizeof(args) - len, "]");
+	event(t, "network_change_notify", "%s", args);
+}
+
+void monitor_table_done(struct transponder *t, int table_id,
+			int table_id_ext)
+{
+	struct snapshot *p;
+	struct service *s, *old;
+	network_change_t change;
+	char a[1024], b[1024], c[1024];
+
+	if ((monitor_fd < 0)
+	    || (p = find_snapshot(table_id, table_id_ext)) == NULL)
+		return;
+
+	switch (table_id) {
+	case TABLE_PAT:
+		for (s = t->services->first; s; s = s->next) {
+			old = old_service(p, s->service_id);
+			if (((old == NULL) || (old->pmt_pid == 0))
+			    && s->pmt_pid)
+				service_event(t, "service_added", s,
+					      ",\"pmt_pid\":%u", s->pmt_pid);
+			else if (old && old->pmt_pid && (s->pmt_pid == 0))
+				service_event(t, "service_removed", s, "");
+			else if (old && (old->pmt_pid != s->pmt_pid))
+				service_event(t, "pmt_pid_changed", s,
+					      ",\"old\":%u,\"new\":%u",
+					      old->pmt_pid, s->pmt_pid);
+		}
+		break;
+	case TABLE_PMT:
+		s = find_service(t, table_id_ext);
+		old = old_service(p, table_id_ext);
+		if (s && old && !same_pids(old, s)) {
+			json_service_pids(a, sizeof(a), old);
+			json_service_pids(b, sizeof(b), s);
+			service_event(t, "pids_changed", s,
+				      ",\"old\":%s,\"new\":%s", a, b);
+		}
+		break;
+	case TABLE_SDT_ACT:
+		for (s = t->services->first; s; s = s->next) {
+			old = old_service(p, s->service_id);
+			if ((old == NULL) || (old->service_name == NULL))
+				continue;	// not (yet) in SDT.
+			if (same_string(old->service_name, s->service_name)
+			    && same_string(old->provider_name,
+					   s->provider_name))
+				continue;
+			json_string(a, sizeof(a), old->service_name);
+			json_string(b, sizeof(b), old->provider_name);
+			json_string(c, sizeof(c), s->provider_name);
+			service_event(t, "service_renamed", s,
+				      ",\"old_name\":%s,\"old_provider\":%s,"
+				      "\"provider\":%s", a, b, c);
+		}
+		break;
+	case TABLE_NIT_ACT:
+		if (!same_string(p->network_name, t->network_name)) {
+			json_string(a, sizeof(a), p->network_name);
+			json_string(b, sizeof(b), t->network_name);
+			event(t, "network_renamed", ",\"old\":%s,\"new\":%s",
+			      a, b);
+		}
+		change = t->network_change;
+		if (!same_network_change(&p->network_change, &change))
+			network_change_event(t);
+		break;
+	default:;
+	}
+	free_snapshot(p);
+}
@@ -0,0 +1,48 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __MONITOR_H__
+#define __MONITOR_H__
+
+#include <stdint.h>
+#include "si_types.h"
+
+/******************************************************************************
+ * continuous SI monitoring, events written by '--monitor <file>'.
+ *
+ * One JSON object per line: lock changes, table version changes and the
+ * resulting service added/removed/renamed, PIDs changed and network change
+ * events. All hooks are no-ops unless monitor_open() was called.
+ *****************************************************************************/
+
+void monitor_open(const char *file);
+bool monitor_enabled(void);
+
+void monitor_start(struct transponder *t);
+void monitor_lock(struct transponder *t, bool locked);
+
+/* a table got a new version: called before its first section is parsed
+ * and after the last one.
+ */
+void monitor_version(struct transponder *t, int table_id, int table_id_ext,
+		     int old_version, int new_version);
+void monitor_table_done(struct transponder *t, int table_id,
+			int table_id_ext);
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "tools.h"
+#include "output-buffer.h"
+
+void ob_init(struct output_buffer *b, int fd)
+{
+	b->fd = fd;
+	b->len = 0;
+}
+
+static void write_all(int fd, const char *s, size_t len)
+{
+	ssize_t n;
+
+	while (len) {
+		if ((n = write(fd, s, len)) < 0) {
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		s += n;
+		len -= n;
+	}
+}
+
+void ob_flush(struct output_buffer *b)
+{
+	log_flush();		// keep order with log messages on a terminal.
+	if (b->fd == STDOUT_FILENO)
+		fflush(stdout);	// anything printf()'ed before goes first.
+	if (b->len && (b->fd >= 0))
+		write_all(b->fd, b->data, b->len);
+	b->len = 0;
+}
+
+void ob_write(struct output_buffer *b, const char *s, size_t len)
+{
+	if (b->len + len > OUTPUT_BUFFER_SIZE) {
+		ob_flush(b);
+		if (len > OUTPUT_BUFFER_SIZE) {
+			if (b->fd >= 0)
+				write_all(b->fd, s, len);
+			return;
+		}
+	}
+	memcpy(b->data + b->len, s, len);
+	b->len += len;
+}
+
+void ob_puts(struct output_buffer *b, const char *s)
+{
+	// same as printf("%s", NULL), keeps output identical.
+	ob_write(b, s ? s : "(null)", strlen(s ? s : "(null)"));
+}
+
+void ob_putu(struct output_buffer *b, unsigned long v)
+{
+	char buf[24];
+	char *p = buf + sizeof(buf);
+
+	do {
+		*--p = '0' + v % 10;
+		v /= 10;
+	} while (v);
+	ob_write(b, p, buf + sizeof(buf) - p);
+}
+
+void ob_putd(struct output_buffer *b, long v)
+{
+	if (v < 0) {
+		ob_putc(b, '-');
+		ob_putu(b, -(unsigned long)v);
+	} else
+		ob_putu(b, v);
+}
+
+void ob_putX(struct output_buffer *b, unsigned long v)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	char buf[16];
+	char *p = buf + sizeof(buf);
+
+	do {
+		*--p = hex[v & 0xF];
+		v >>= 4;
+	} while (v);
+	ob_write(b, p, buf + sizeof(buf) - p);
+}
+
+static const char *xml_entity(unsigned char c)
+{
+	switch (c) {
+	case '"':
+		return "&quot;";
+	case '\'':
+		return "&apos;";
+	case '<':
+		return "&lt;";
+	case '>':
+		return "&gt;";
+	case '&':
+		return "&amp;";
+	default:
+		return NULL;
+	}
+}
+
+/******************************************************************************
+ * write 's', escaped for the target format. Unescaped runs are copied in one
+ * go, the source string is never modified.
+ *****************************************************************************/
+
+void ob_puts_escaped(struct output_buffer *b, const char *s, int mode)
+{
+	const char *run;
+
+	if (s == NULL || mode == ESCAPE_NONE) {
+		ob_puts(b, s);
+		return;
+	}
+	for (run = s; *s; s++) {
+		unsigned char c = (unsigned char)*s;
+		const char *e = NULL;
+
+		switch (mode) {
+		case ESCAPE_VDR:
+			if (c == ':')
+				e = " ";
+			break;
+		case ESCAPE_XML:
+			e = xml_entity(c);
+			break;
+		case ESCAPE_XSPF:
+			if (c == '\t')
+				e = " ";
+			else if ((e = xml_entity(c)) == NULL
+				 && (c < 0x20 || c >= 0x7F))
+				e = "";	// dropped, unless ISO-8859-1 below.
+			break;
+		default:;
+		}
+		if (e == NULL)
+			continue;
+		ob_write(b, run, s - run);
+		if (mode == ESCAPE_XSPF && c >= 0xA1) {
+			// numeric character reference "&#x00HH;"
+			ob_write(b, "&#x00", 5);
+			ob_putX(b, c);
+			ob_putc(b, ';');
+		} else
+			ob_puts(b, e);
+		run = s + 1;
+	}
+	ob_write(b, run, s - run);
+}
+
+/******************************************************************************
+ * printf() fallback for everything not on the hot path: format directly into
+ * the free space of the buffer, flush and retry if it does not fit.
+ *****************************************************************************/
+
+void ob_printf(struct output_buffer *b, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	va_start(ap, fmt);
+	n = vsnprintf(b->data + b->len, OUTPUT_BUFFER_SIZE - b->len, fmt, ap);
+	va_end(ap);
+	if (n < 0)
+		return;
+	if ((size_t) n < OUTPUT_BUFFER_SIZE - b->len) {
+		b->len += n;
+		return;
+	}
+	ob_flush(b);
+	va_start(ap, fmt);
+	if (n < OUTPUT_BUFFER_SIZE) {
+		vsnprintf(b->data, OUTPUT_BUFFER_SIZE, fmt, ap);
+		b->len = n;
+	} else if (b->fd >= 0)
+		vdprintf(b->fd, fmt, ap);
+	va_end(ap);
+}
@@ -0,0 +1,67 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __OUTPUT_BUFFER_H__
+#define __OUTPUT_BUFFER_H__
+
+#include <stdio.h>
+#include <stddef.h>
+
+/******************************************************************************
+ * buffered output for the dump-*.c writers: everything is collected in a
+ * fixed buffer and written with one write() to the file descriptor per
+ * chunk, no stdio in between. Numbers and escaped strings are formatted in
+ * place without printf() or temporary allocations.
+ *****************************************************************************/
+
+#define OUTPUT_BUFFER_SIZE 65536
+
+struct output_buffer {
+	int fd;
+	size_t len;
+	char data[OUTPUT_BUFFER_SIZE];
+};
+
+/* ob_puts_escaped() modes. */
+enum __output_escape {
+	ESCAPE_NONE,
+	ESCAPE_VDR,		// ':' is field separator in vdr/xine/mplayer lists
+	ESCAPE_XML,		// " ' < > & as XML entities
+	ESCAPE_XSPF,		// as XML, plus TAB to space, 8bit as ISO-8859-1 char refs
+};
+
+void ob_init(struct output_buffer *b, int fd);
+void ob_flush(struct output_buffer *b);
+void ob_write(struct output_buffer *b, const char *s, size_t len);
+void ob_puts(struct output_buffer *b, const char *s);
+void ob_puts_escaped(struct output_buffer *b, const char *s, int mode);
+void ob_putd(struct output_buffer *b, long v);
+void ob_putu(struct output_buffer *b, unsigned long v);
+void ob_putX(struct output_buffer *b, unsigned long v);
+void ob_printf(struct output_buffer *b, const char *fmt, ...)
+    __attribute__ ((format(printf, 2, 3)));
+
+static inline void ob_putc(struct output_buffer *b, char c)
+{
+	if (b->len == OUTPUT_BUFFER_SIZE)
+		ob_flush(b);
+	b->data[b->len++] = c;
+}
+
+#endif
@@ -37,6 +37,7 @@
 #include "parse-dvbscan.h"
 #include "dvbscan.h"
 #include "satellites.h"
+#include "diseqc.h"
 #include "dump-vdr.h"
 
 #define MAX_LINE_LENGTH 1024	// paranoia, but still possible
@@ -85,15 +86,16 @@ enum __extflags {
 void parse_w_scan_flags(const char *input_buffer, struct w_scan_flags *flags)
 {
 	char *copy = (char *)malloc(strlen(input_buffer) + 1);
-	char *token = strtok(copy, DELIMITERS);
+	char *token, *save;
 	enum __extflags arg = ignore;
 
 	strcpy(copy, input_buffer);
+	token = strtok_r(copy, DELIMITERS, &save);
 	if (NULL == token) {
 		free(copy);
 		return;
 	}
-	while (NULL != (token = strtok(0, DELIMITERS))) {
+	while (NULL != (token = strtok_r(NULL, DELIMITERS, &save))) {
 		if (0 == strcasecmp(token, "<w_scan>")) {
 			arg = wscan_version;
 			continue;
@@ -156,7 +158,7 @@ int dvbscan_parse_tuningdata(const char *tuningdata, struct w_scan_flags *flags)
 
 	while (fgets(buf, MAX_LINE_LENGTH, initdata) != NULL) {
 		char *copy = (char *)calloc(sizeof(char), strlen(buf) + 1);
-		char *token;
+		char *token, *save;
 
 		if (copy == NULL) {
 			fatal("Could not allocate memory.\n");
@@ -164,11 +166,11 @@ int dvbscan_parse_tuningdata(const char *tuningdata, struct w_scan_flags *flags)
 		memset(&tn, 0, sizeof(tn));
 		/* strtok will modify it's first argument, but working
 		 * on a copy is safe. Be really careful here -
-		 * 'copy' should NOT be referred to after usage of strtok()
+		 * 'copy' should NOT be referred to after usage of strtok_r()
 		 * -wk-
 		 */
 		strcpy(copy, buf);
-		token = strtok(copy, DELIMITERS);
+		token = strtok_r(copy, DELIMITERS, &save);
 		if (NULL == token)
 			continue;
 		switch (toupper(token[0])) {
@@ -265,7 +267,7 @@ int dvbscan_parse_tuningdata(const char *tuningdata, struct w_scan_flags *flags)
 			return 0;	// err
 		}
 
-		while (NULL != (token = strtok(0, DELIMITERS))) {
+		while (NULL != (token = strtok_r(NULL, DELIMITERS, &save))) {
 			switch (arg++) {
 			case sat_frequency:
 			case cable_frequency:
@@ -523,13 +525,13 @@ int dvbscan_parse_rotor_positions(const char *positiondata)
 
 	while (fgets(buf, MAX_LINE_LENGTH, data) != NULL) {
 		char *copy = (char *)calloc(sizeof(char), strlen(buf) + 1);
-		char *token;
+		char *token, *save;
 
 		if (copy == NULL)
 			fatal("Could not allocate memory.\n");
 
 		strcpy(copy, buf);
-		token = strtok(copy, ROTOR_DELIMITERS);
+		token = strtok_r(copy, ROTOR_DELIMITERS, &save);
 		if (NULL == token)
 			continue;
 
@@ -559,7 +561,7 @@ int dvbscan_parse_rotor_positions(const char *positiondata)
 			goto err;
 		}
 
-		while (NULL != (token = strtok(0, DELIMITERS))) {
+		while (NULL != (token = strtok_r(NULL, DELIMITERS, &save))) {
 			switch (arg++) {
 			case rotor_position:
 				switch (toupper(token[0])) {
@@ -628,8 +630,8 @@ int dvbscan_parse_rotor_positions(const char *positiondata)
 				     item.position);
 				goto err;
 			}
-			sat_list[txt_to_satellite(item.id)].rotor_position =
-			    item.position;
+			set_sat_rotor_position(txt_to_satellite(item.id),
+					       item.position);
 			count++;
 			info("\trotor position %3d = %6s\n", item.position,
 			     item.id);
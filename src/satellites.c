@@ -93,20 +93,6 @@ const char *satellite_to_full_name(int idx)
 	return "??";
 }
 
-/******************************************************************************
- * return index number
- * from rotor position
- *
- *****************************************************************************/
-int rotor_position_to_sat_list_index(int rotor_position)
-{
-	unsigned int i;
-	for (i = 0; i < SAT_COUNT(sat_list); i++)
-		if (rotor_position == sat_list[i].rotor_position)
-			return i;
-	return 0;
-}
-
 /******************************************************************************
  * print list of
  * all satellites
@@ -35,7 +35,6 @@ int txt_to_satellite(const char *id);
 int sat_count();
 const char *satellite_to_short_name(int idx);
 const char *satellite_to_full_name(int idx);
-int rotor_position_to_sat_list_index(int rotor_position);
 void print_satellites(void);
 //int get_frontend_param(uint16_t satellite, uint16_t table_index,
 //                       struct tuning_parameters * param);
@@ -63,12 +62,12 @@ struct cSat {
 	const int item_count;
 	const fe_west_east_flag_t west_east_flag;
 	const uint16_t orbital_position;
-	int rotor_position;	// Note: *not* const
+	const int rotor_position;	// unused, see sat_rotor_position() in diseqc.c
 	const char *source_id;	// VDR sources.conf
 	const int skew;
 };
 #define SAT_COUNT(x) (sizeof(x)/sizeof(struct cSat))
 
-extern struct cSat sat_list[];
+extern const struct cSat sat_list[];
 
 #endif
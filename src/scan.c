@@ -46,6 +46,8 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -61,6 +63,17 @@
 #include "dump-mplayer.h"
 #include "dump-vlc-m3u.h"
 #include "dump-xml.h"
+#include "dump-chdb.h"
+#include "chdb.h"
+#include "stats.h"
+#include "trace.h"
+#include "daemon.h"
+#include "si-cache.h"
+#include "dead-cache.h"
+#include "monitor.h"
+#include "verify.h"
+#include "diff.h"
+#include "checkpoint.h"
 #include "dvbscan.h"
 #include "parse-dvbscan.h"
 #include "countries.h"
@@ -76,16 +89,14 @@
 
 #define USE_EMUL
 #ifdef USE_EMUL
-#define EMUL(fname, fargs...) if (flags.emulate) fname(fargs); else
+#define EMUL(fname, fargs...) if (ctx->flags.emulate) fname(fargs); else
 #define em_static
 #else
 #define EMUL(fname, fargs...)
 #define em_static static
 #endif
 
-static char demux_devname[80];
-
-struct w_scan_flags flags = {
+static const struct w_scan_flags default_flags = {
 	PACKAGE_VERSION,	// readback value w_scan2 version
 	SCAN_TERRESTRIAL,	// scan type
 	ATSC_VSB,		// default for ATSC scan
@@ -107,42 +118,11 @@ struct w_scan_flags flags = {
 	0,			// emulate
 	0,			// delete duplicate transponders
 	SYS_UNDEFINED, // delivery system not defined
+	0,			// stream output
 };
 
-static unsigned int delsys_min = 0;	// initialization of delsys loop. 0 = delsys legacy.
-static unsigned int delsys_max = 0;	// initialization of delsys loop. 0 = delsys legacy.
-static unsigned int modulation_min = 0;	// initialization of modulation loop. QAM64  if FE_QAM
-static unsigned int modulation_max = 1;	// initialization of modulation loop. QAM256 if FE_QAM
-static unsigned int dvbc_symbolrate_min = 0;	// initialization of symbolrate loop. 6900
-static unsigned int dvbc_symbolrate_max = 1;	// initialization of symbolrate loop. 6875
-static unsigned int plp_id_min = 0; // initialization of plp_id loop.
-static unsigned int plp_id_max = 0; // initialization of plp_id loop.
-static unsigned int freq_offset_min = 0;	// initialization of freq offset loop. 0 == offset (0), 1 == offset(+), 2 == offset(-), 3 == offset1(+), 4 == offset2(+)
-static unsigned int freq_offset_max = 4;	// initialization of freq offset loop.
-static int this_channellist = DVBT_DE;	// w_scan2 uses by default DVB-t
-static unsigned int ATSC_type = ATSC_VSB;	// 20090227: flag type vars shouldnt be signed.
-static unsigned int no_ATSC_PSIP = 0;	// 20090227: initialization was missing, signed -> unsigned
-static unsigned int serv_select = 3;	// 20080106: radio and tv as default (no service/other). 20090227: flag type vars shouldnt be signed.
-static int this_rotor_pos = -1;	// 20090320: DVB-S/S2, current rotor position
-static int committed_switch = 0;	// 20090320: DVB-S/S2, DISEQC committed switch position
-static int uncommitted_switch = 0;	// 20090320: DVB-S/S2, DISEQC uncommitted switch position
-static struct lnb_types_st this_lnb;	// 20090320: DVB-S/S2, LNB type, initialized in main to 'UNIVERSAL'
-static struct scr scr_config = {	// 20140101: DVB-S/S2, satellite channel routing. (EN50494)
-	0, 0, 0, 0xFFFF, 0, 0
-};
 
-struct timespec start_time = { 0, 0 };
 
-static bool bandwidth_auto = true;
-static enum fe_spectral_inversion caps_inversion = INVERSION_AUTO;
-static enum fe_code_rate caps_fec = FEC_AUTO;
-static enum fe_modulation caps_qam = QAM_AUTO;
-static enum fe_modulation this_qam = QAM_64;
-static enum fe_modulation this_atsc = VSB_8;
-static enum fe_transmit_mode caps_transmission_mode = TRANSMISSION_MODE_AUTO;
-static enum fe_guard_interval caps_guard_interval = GUARD_INTERVAL_AUTO;
-static enum fe_hierarchy caps_hierarchy = HIERARCHY_AUTO;
-static struct dvb_frontend_info fe_info;
 
 enum __output_format {
 	OUTPUT_VDR,
@@ -153,17 +133,163 @@ enum __output_format {
 	OUTPUT_MPLAYER,
 	OUTPUT_VLC_M3U,
 	OUTPUT_XML,
+	OUTPUT_CHDB,
+	OUTPUT_SHARD_RESULT,
+};
+
+/* where to write which output format, all rendered in one pass. */
+#define MAX_OUTPUT_SINKS 8
+struct output_sink {
+	enum __output_format format;
+	const char *format_name;
+	uint8_t print_pmt;
+	char *name;
+	int fd;
+	off_t epilog_pos;	// streaming output: where to continue writing.
+	int index;
+	uint16_t codepage;	// if != flags.codepage: names are recoded.
+	struct output_buffer out;
+};
+
+static const struct {
+	const char *name;
+	enum __output_format format;
+} output_format_names[] = {
+	{"vdr", OUTPUT_VDR},
+	{"gstreamer", OUTPUT_GSTREAMER},
+	{"xine", OUTPUT_XINE},
+	{"mplayer", OUTPUT_MPLAYER},
+	{"initial", OUTPUT_DVBSCAN_TUNING_DATA},
+	{"vlc", OUTPUT_VLC_M3U},
+	{"xml", OUTPUT_XML},
+	{"db", OUTPUT_CHDB},
+	{"shard", OUTPUT_SHARD_RESULT},
+};
+#define NUM_OUTPUT_FORMATS (sizeof(output_format_names) / sizeof(output_format_names[0]))
+
+#define MAX_SATELLITES 32
+
+/* parallel scan: one process per frontend, each using its own SCR user band. */
+#define MAX_SCR_FRONTENDS 8
+#define MAX_SCR_CLAIMS 4096
+struct scr_frontend {
+	int adapter;
+	int frontend;
+	uint8_t slot;
+	uint16_t user_frequency;
+	pid_t pid;
+	FILE *output;
+};
+
+struct scr_claims {		// shared between processes: who scans which tp.
+	volatile int lock;
+	uint32_t count;
+	struct {
+		uint32_t frequency;
+		uint8_t polarization;
+		uint8_t worker;	// scan_context.scr_worker of the claimant
+	} tp[MAX_SCR_CLAIMS];
+};
+
+/* tune cost model, see tune_to_next_transponder(). */
+typedef uint32_t(*tune_cost_func) (struct transponder * from,
+				   struct transponder * to);
+
+// see http://www.linuxtv.org/pipermail/linux-dvb/2005-October/005577.html:
+// #define MAX_RUNNING 32
+#define MAX_RUNNING 27
+
+/* all state of one scan. Every thread scans with its own context, see
+ * scan_context_use(); the parallel SCR scan forks, each child continues with
+ * its copy.
+ */
+struct scan_context {
+	struct w_scan_flags flags;
+	char demux_devname[80];
+	struct dvb_frontend_info fe_info;
+
+	unsigned int delsys_min;	// initialization of delsys loop. 0 = delsys legacy.
+	unsigned int delsys_max;	// initialization of delsys loop. 0 = delsys legacy.
+	unsigned int modulation_min;	// initialization of modulation loop. QAM64  if FE_QAM
+	unsigned int modulation_max;	// initialization of modulation loop. QAM256 if FE_QAM
+	unsigned int dvbc_symbolrate_min;	// initialization of symbolrate loop. 6900
+	unsigned int dvbc_symbolrate_max;	// initialization of symbolrate loop. 6875
+	unsigned int plp_id_min;	// initialization of plp_id loop.
+	unsigned int plp_id_max;	// initialization of plp_id loop.
+	unsigned int freq_offset_min;	// initialization of freq offset loop. 0 == offset (0), 1 == offset(+), 2 == offset(-), 3 == offset1(+), 4 == offset2(+)
+	unsigned int freq_offset_max;	// initialization of freq offset loop.
+	int this_channellist;	// w_scan2 uses by default DVB-t
+	unsigned int ATSC_type;
+	unsigned int no_ATSC_PSIP;
+	unsigned int serv_select;	// radio and tv as default (no service/other).
+
+	int this_rotor_pos;	// DVB-S/S2, current rotor position
+	int committed_switch;	// DVB-S/S2, DISEQC committed switch position
+	int uncommitted_switch;	// DVB-S/S2, DISEQC uncommitted switch position
+	struct lnb_types_st this_lnb;	// DVB-S/S2, LNB type, initialized in main to 'UNIVERSAL'
+	struct scr scr_config;	// DVB-S/S2, satellite channel routing. (EN50494)
+	int satellites[MAX_SATELLITES];	// multi satellite scan: sat_list indices, in rotor order.
+	int satellites_count;
+
+	bool bandwidth_auto;
+	enum fe_spectral_inversion caps_inversion;
+	enum fe_code_rate caps_fec;
+	enum fe_modulation caps_qam;
+	enum fe_modulation this_qam;
+	enum fe_modulation this_atsc;
+	enum fe_transmit_mode caps_transmission_mode;
+	enum fe_guard_interval caps_guard_interval;
+	enum fe_hierarchy caps_hierarchy;
+
+	enum __output_format output_format;
+	struct output_sink output_sinks[MAX_OUTPUT_SINKS];
+	int output_sinks_count;
+
+	cList _scanned_transponders, *scanned_transponders;
+	cList _new_transponders, *new_transponders;
+	cList _satellite_transponders, *satellite_transponders;
+	struct transponder *current_tp;
+	tune_cost_func tune_cost;
+
+	cList _running_filters, *running_filters;
+	cList _waiting_filters, *waiting_filters;
+	int n_running;
+	struct pollfd poll_fds[MAX_RUNNING];
+	struct section_buf *poll_section_bufs[MAX_RUNNING];
+
+	struct scan_callbacks callbacks;	// library clients, see w_scan2.h
+	struct si_cache *si_cache;	// incremental rescan, see scan_tp_dvb()
+	struct dead_cache *dead_cache;	// no lock, see tune_to_transponder()
+	struct diseqc_context diseqc;	// rotor model, SCR bus lock, see diseqc.h
+
+	struct scr_frontend scr_frontends[MAX_SCR_FRONTENDS];
+	int scr_frontends_count;	// additional frontends, without the main one.
+	int scr_worker;		// 0 == main process
+	struct scr_claims *scr_claims;	// MAP_SHARED, see scr_parallel_scan()
+	volatile sig_atomic_t interrupted;	// see scan_interrupt()
+	int warm_start;		// transponders known from a previous scan
+	bool fill_gaps;		// warm start: blind scan for other transponders
+	struct verify *verify;	// '--verify': PAT and SDT only, see verify.c
+	pList diff_before;	// '--diff': result of a previous scan
+	cList _diff_before;
+	char *checkpoint;	// '--checkpoint', '--resume': file, see checkpoint.c
+	struct checkpoint_state cp;	// progress, as written to checkpoint
+	struct checkpoint_state resume;	// progress of the resumed scan
+	bool resumed;
+	time_t checkpoint_time;
+	struct transponder *scanning;	// tuned, but services not read yet
+	uint32_t shard;		// '--shard i/n': i - 1
+	uint32_t shard_count;	// '--shard i/n': n, 0 if not sharded
+	int merged;		// '--merge': number of results merged
 };
-static enum __output_format output_format = OUTPUT_VDR;
 
-cList _scanned_transponders, *scanned_transponders = &_scanned_transponders;
-cList _new_transponders, *new_transponders = &_new_transponders;
-static struct transponder *current_tp;
+static __thread struct scan_context *ctx = NULL;
 
 static void setup_filter(struct section_buf *s, const char *dmx_devname,
 			 int pid, int table_id, int table_id_ext, int run_once,
 			 int segmented, uint32_t filter_flags);
 static void add_filter(struct section_buf *s);
+static void remove_filter(struct section_buf *s);
 static void copy_fe_params(struct transponder *dest,
 			   struct transponder *source);
 
@@ -186,6 +312,7 @@ struct transponder *alloc_transponder(uint32_t frequency, unsigned delsys,
 	t->locks_with_params = false;
 	t->delsys = delsys;
 	t->polarization = polarization;
+	t->list_id = ctx->this_channellist;
 
 	switch (delsys) {
 	case SYS_DVBT:
@@ -218,7 +345,7 @@ struct transponder *alloc_transponder(uint32_t frequency, unsigned delsys,
 	t->network_name = NULL;
 
 	if (frequency > 0) {	//dont check, if we dont yet know freq.
-		for (tn = new_transponders->first; tn; tn = tn->next) {
+		for (tn = ctx->new_transponders->first; tn; tn = tn->next) {
 			if (tn->delsys != t->delsys)
 				continue;
 			if (tn->frequency == frequency) {
@@ -232,7 +359,7 @@ struct transponder *alloc_transponder(uint32_t frequency, unsigned delsys,
 	}
 
 	if (known == false) {
-		AddItem(new_transponders, t);
+		AddItem(ctx->new_transponders, t);
 	}
 	return t;
 }
@@ -499,20 +626,20 @@ static struct transponder *find_transponder_by_freq(struct transponder
 
 	verbose("        %s(%s)", __FUNCTION__, buffer);
 
-	if ((tn->type != flags.scantype)
+	if ((tn->type != ctx->flags.scantype)
 	    || ((tn->frequency < 1) && (!tn->cells->count))) {
 		free(buffer);
 		verbose("          -> not found. (line %d)\n", __LINE__);
 		return NULL;	// delsys doesnt match
 	}
 
-	for (t = scanned_transponders->first; t; t = t->next) {
+	for (t = ctx->scanned_transponders->first; t; t = t->next) {
 		if (t->delsys != tn->delsys)
 			continue;
-		if ((flags.scantype == SCAN_SATELLITE)
+		if ((ctx->flags.scantype == SCAN_SATELLITE)
 		    && (t->polarization != tn->polarization))
 			continue;
-		if (flags.scantype == SCAN_TERRESTRIAL) {
+		if (ctx->flags.scantype == SCAN_TERRESTRIAL) {
 			struct cell *c;
 			int i;
 
@@ -562,13 +689,13 @@ static struct transponder *find_transponder_by_freq(struct transponder
 		}
 	}
 
-	for (t = new_transponders->first; t; t = t->next) {
+	for (t = ctx->new_transponders->first; t; t = t->next) {
 		if (t->delsys != tn->delsys)
 			continue;
-		if ((flags.scantype == SCAN_SATELLITE)
+		if ((ctx->flags.scantype == SCAN_SATELLITE)
 		    && (t->polarization != tn->polarization))
 			continue;
-		if (flags.scantype == SCAN_TERRESTRIAL) {
+		if (ctx->flags.scantype == SCAN_TERRESTRIAL) {
 			struct cell *c;
 			int i;
 
@@ -614,16 +741,16 @@ static struct transponder *find_transponder_by_freq(struct transponder
 	}
 
 	// handle the case of current_tp not being in scanned_transponders or in new_transponders
-	if (!((flags.scantype == SCAN_SATELLITE)
-	      && (current_tp->polarization != tn->polarization))) {
+	if (!((ctx->flags.scantype == SCAN_SATELLITE)
+	      && (ctx->current_tp->polarization != tn->polarization))) {
 		if (is_nearly_same_frequency
-		    (current_tp->frequency, tn->frequency, tn->type)) {
+		    (ctx->current_tp->frequency, tn->frequency, tn->type)) {
 			verbose("          -> found current_tp'  %s\n", buffer);
 			t = calloc(1, sizeof(*t));
 			copy_transponder(t, tn);
-			AddItem(scanned_transponders, t);
+			AddItem(ctx->scanned_transponders, t);
 			free(buffer);
-			return current_tp;
+			return ctx->current_tp;
 		}
 	}
 
@@ -652,7 +779,7 @@ static struct transponder *find_transponder(uint16_t
 		return NULL;
 
 	if (original_network_id != 0) {
-		for (t = scanned_transponders->first; t; t = t->next) {
+		for (t = ctx->scanned_transponders->first; t; t = t->next) {
 			if (check_onid && t->original_network_id) {
 				if (t->original_network_id !=
 				    original_network_id)
@@ -668,7 +795,7 @@ static struct transponder *find_transponder(uint16_t
 				return t;
 			}
 		}
-		for (t = new_transponders->first; t; t = t->next) {
+		for (t = ctx->new_transponders->first; t; t = t->next) {
 			if (check_onid && t->original_network_id) {
 				if (t->original_network_id !=
 				    original_network_id)
@@ -695,7 +822,7 @@ static int is_known_initial_transponder(struct transponder *tn,
 {
 	struct transponder *t;
 
-	for (t = new_transponders->first; t; t = t->next) {
+	for (t = ctx->new_transponders->first; t; t = t->next) {
 		switch (tn->type) {
 		case SCAN_TERRESTRIAL:
 		case SCAN_CABLE:
@@ -792,16 +919,16 @@ void list_transponders()
 	verbose
 	    ("          ================= %s() =======================\n",
 	     __FUNCTION__);
-	for (t = scanned_transponders->first; t; t = t->next) {
+	for (t = ctx->scanned_transponders->first; t; t = t->next) {
 		print_transponder(buf, t);
 		verbose("          %s(%.3u): %s\n",
-			scanned_transponders->name, t->index, buf);
+			ctx->scanned_transponders->name, t->index, buf);
 	}
 
-	for (t = new_transponders->first; t; t = t->next) {
+	for (t = ctx->new_transponders->first; t; t = t->next) {
 		print_transponder(buf, t);
 		verbose("          %s(%.3u): %s\n",
-			new_transponders->name, t->index, buf);
+			ctx->new_transponders->name, t->index, buf);
 	}
 	verbose
 	    ("          =============================================================\n");
@@ -829,8 +956,8 @@ static void copy_duplicate_tp(struct transponder *t, struct transponder *t2)
 		}
 	}
 	// enshure that current_tp points to valid tp.
-	if (current_tp == t2)
-		current_tp = t;
+	if (ctx->current_tp == t2)
+		ctx->current_tp = t;
 }
 
 void check_duplicate_transponders()
@@ -839,7 +966,7 @@ void check_duplicate_transponders()
 	char buf[128];
 
 	verbose("          %s()\n", __FUNCTION__);
-	for (t = scanned_transponders->first; t; t = t->next) {
+	for (t = ctx->scanned_transponders->first; t; t = t->next) {
 		for (t2 = t->next; t2; t2 = t2->next) {
 			if (t->delsys != t2->delsys)
 				continue;
@@ -856,12 +983,12 @@ void check_duplicate_transponders()
 			print_transponder(buf, t2);
 			verbose
 			    ("          DELETING DUPLICATE TRANSPONDER %s(%.3u): %s (line:%d)\n",
-			     scanned_transponders->name, t2->index, buf,
+			     ctx->scanned_transponders->name, t2->index, buf,
 			     __LINE__);
-			DeleteItem(scanned_transponders, t2);
+			DeleteItem(ctx->scanned_transponders, t2);
 			return;
 		}
-		for (t2 = new_transponders->first; t2; t2 = t2->next) {
+		for (t2 = ctx->new_transponders->first; t2; t2 = t2->next) {
 			if (t->delsys != t2->delsys)
 				continue;
 			if (t->original_network_id && t2->original_network_id) {
@@ -877,12 +1004,12 @@ void check_duplicate_transponders()
 			print_transponder(buf, t2);
 			verbose
 			    ("          DELETING DUPLICATE TRANSPONDER %s(%.3u): %s (line:%d)\n",
-			     new_transponders->name, t2->index, buf, __LINE__);
-			DeleteItem(new_transponders, t2);
+			     ctx->new_transponders->name, t2->index, buf, __LINE__);
+			DeleteItem(ctx->new_transponders, t2);
 			return;
 		}
 	}
-	for (t = new_transponders->first; t; t = t->next) {
+	for (t = ctx->new_transponders->first; t; t = t->next) {
 		for (t2 = t->next; t2; t2 = t2->next) {
 			if (t->delsys != t2->delsys)
 				continue;
@@ -899,8 +1026,8 @@ void check_duplicate_transponders()
 			print_transponder(buf, t2);
 			verbose
 			    ("          DELETING DUPLICATE TRANSPONDER %s(%.3u): %s (line:%d)\n",
-			     new_transponders->name, t2->index, buf, __LINE__);
-			DeleteItem(new_transponders, t2);
+			     ctx->new_transponders->name, t2->index, buf, __LINE__);
+			DeleteItem(ctx->new_transponders, t2);
 			return;
 		}
 	}
@@ -1001,14 +1128,14 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 			    && ((t == TABLE_NIT_ACT)
 				|| (t == TABLE_NIT_OTH)))
 				parse_satellite_delivery_system_descriptor
-				    (buf, data, caps_inversion);
+				    (buf, data, ctx->caps_inversion);
 			break;
 		case cable_delivery_system_descriptor:
 			if ((scantype == SCAN_CABLE)
 			    && ((t == TABLE_NIT_ACT)
 				|| (t == TABLE_NIT_OTH)))
 				parse_cable_delivery_system_descriptor
-				    (buf, data, caps_inversion);
+				    (buf, data, ctx->caps_inversion);
 			break;
 		case vbi_data_descriptor:
 		case vbi_teletext_descriptor:
@@ -1018,7 +1145,7 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 			if ((t == TABLE_SDT_ACT)
 			    || (t == TABLE_SDT_OTH))
 				parse_service_descriptor(buf, data,
-							 flags.codepage);
+							 ctx->flags.codepage);
 			break;
 		case country_availability_descriptor:
 		case linkage_descriptor:
@@ -1049,7 +1176,7 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 			    && ((t == TABLE_NIT_ACT)
 				|| (t == TABLE_NIT_OTH)))
 				parse_terrestrial_delivery_system_descriptor
-				    (buf, data, caps_inversion);
+				    (buf, data, ctx->caps_inversion);
 			break;
 		case extension_descriptor:	// 6.2.16 Extension descriptor
 			switch (buf[2]) {	// descriptor_tag_extension;
@@ -1060,7 +1187,7 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 					|| (t == TABLE_NIT_OTH))) {
 					parse_C2_delivery_system_descriptor(buf,
 									    data,
-									    caps_inversion);
+									    ctx->caps_inversion);
 				}
 				break;
 			case T2_delivery_system_descriptor:
@@ -1069,7 +1196,7 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 					|| (t == TABLE_NIT_OTH))) {
 					parse_T2_delivery_system_descriptor(buf,
 									    data,
-									    caps_inversion);
+									    ctx->caps_inversion);
 				}
 				break;
 			case SH_delivery_system_descriptor:
@@ -1078,7 +1205,7 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 				    && ((t == TABLE_NIT_ACT)
 					|| (t == TABLE_NIT_OTH))) {
 					parse_SH_delivery_system_descriptor
-					    (buf, data, caps_inversion);
+					    (buf, data, ctx->caps_inversion);
 				}
 				break;
 			case network_change_notify_descriptor:
@@ -1142,7 +1269,7 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 			if ((scantype == SCAN_SATELLITE)
 			    && ((t == TABLE_NIT_ACT)
 				|| (t == TABLE_NIT_OTH))
-			    && (fe_info.caps & FE_CAN_2G_MODULATION))
+			    && (ctx->fe_info.caps & FE_CAN_2G_MODULATION))
 				parse_S2_satellite_delivery_system_descriptor
 				    (buf, data);
 			break;
@@ -1167,6 +1294,41 @@ static void parse_descriptors(enum table_id t, const unsigned char *buf,
 	}
 }
 
+static bool on_default_nit_pid(struct section_buf *s)
+{
+	return ((s->table_id == TABLE_NIT_ACT) || (s->table_id == TABLE_NIT_OTH))
+	    && (s->pid == PID_NIT_ST) && (s->section_version_number == -1)
+	    && !(s->flags & SECTION_FLAG_MONITOR);
+}
+
+/* scan_tp_dvb() starts NIT filters on PID 0x10, together with PAT. If PAT
+ * signals another network_PID, restart those without data on this PID.
+ */
+static void follow_network_PID(uint16_t network_PID)
+{
+	struct section_buf *s, *next, *n;
+
+	if ((network_PID == PID_NIT_ST) || ctx->flags.emulate)
+		return;
+
+	for (s = ctx->waiting_filters->first; s; s = s->next)
+		if (on_default_nit_pid(s))
+			s->pid = network_PID;
+
+	for (s = ctx->running_filters->first; s; s = next) {
+		next = s->next;
+		if (!on_default_nit_pid(s))
+			continue;
+		if ((n = calloc(1, sizeof(*n))) == NULL)
+			fatal("out of memory\n");
+		setup_filter(n, s->dmx_devname, network_PID, s->table_id, -1,
+			     s->run_once, s->segmented,
+			     s->flags | SECTION_FLAG_FREE);
+		remove_filter(s);
+		add_filter(n);
+	}
+}
+
 /* EN 13818-1 p.43 Table 2-25 - Program association section
  */
 em_static void parse_pat(const unsigned char *buf,
@@ -1176,22 +1338,22 @@ em_static void parse_pat(const unsigned char *buf,
 	verbose("PAT (xxxx:xxxx:%u)\n", transport_stream_id);
 	hexdump(__FUNCTION__, buf, section_length);
 
-	if (current_tp->transport_stream_id != transport_stream_id) {
-		if (current_tp->type == SCAN_TERRESTRIAL) {
+	if (ctx->current_tp->transport_stream_id != transport_stream_id) {
+		if (ctx->current_tp->type == SCAN_TERRESTRIAL) {
 			char buffer[128];
-			print_transponder(buffer, current_tp);
-			info("        %s : updating transport_stream_id: -> (%u:%u:%u)\n", buffer, current_tp->original_network_id, current_tp->network_id, transport_stream_id);
-			current_tp->transport_stream_id = transport_stream_id;
-			if (flags.delete_duplicate_transponders) {
+			print_transponder(buffer, ctx->current_tp);
+			info("        %s : updating transport_stream_id: -> (%u:%u:%u)\n", buffer, ctx->current_tp->original_network_id, ctx->current_tp->network_id, transport_stream_id);
+			ctx->current_tp->transport_stream_id = transport_stream_id;
+			if (ctx->flags.delete_duplicate_transponders) {
 				check_duplicate_transponders();
 			}
 			if (verbosity > 1)
 				list_transponders();
-		} else if (current_tp->transport_stream_id)
+		} else if (ctx->current_tp->transport_stream_id)
 			verbose
 			    ("unexpected transport_stream_id %d, expected %d\n",
 			     transport_stream_id,
-			     current_tp->transport_stream_id);
+			     ctx->current_tp->transport_stream_id);
 	}
 
 	while (section_length > 0) {
@@ -1204,19 +1366,20 @@ em_static void parse_pat(const unsigned char *buf,
 		if (service_id == 0) {
 			if (program_number != 16)
 				info("        %s: network_PID = %d (transport_stream_id %d)\n", __FUNCTION__, program_number, transport_stream_id);
-			current_tp->network_PID = program_number;
+			ctx->current_tp->network_PID = program_number;
+			follow_network_PID(program_number);
 			continue;
 		}
 		// SDT might have been parsed first...
-		s = find_service(current_tp, service_id);
+		s = find_service(ctx->current_tp, service_id);
 		if (s == NULL)
-			s = alloc_service(current_tp, service_id);
+			s = alloc_service(ctx->current_tp, service_id);
 		s->pmt_pid = program_number;
 
 		if (!(section_flags & SECTION_FLAG_INITIAL)) {
 			if (s->priv == NULL) {	//  && s->pmt_pid) {  pmt_pid is by spec: 0x0010 .. 0x1FFE . see EN13818-1 p.19 Table 2-3 - PID table
 				s->priv = calloc(1, sizeof(struct section_buf));
-				setup_filter(s->priv, demux_devname,
+				setup_filter(s->priv, ctx->demux_devname,
 					     s->pmt_pid, TABLE_PMT, -1,
 					     1, 0, SECTION_FLAG_FREE);
 				add_filter(s->priv);
@@ -1235,7 +1398,7 @@ em_static void parse_pmt(const unsigned char *buf,
 	int i;
 
 	hexdump(__FUNCTION__, buf, section_length);
-	s = find_service(current_tp, service_id);
+	s = find_service(ctx->current_tp, service_id);
 	if (s == NULL) {
 		error("PMT for service_id 0x%04x was not in PAT\n", service_id);
 		return;
@@ -1251,7 +1414,7 @@ em_static void parse_pmt(const unsigned char *buf,
 	while (program_info_len > 0) {
 		int descriptor_length = ((int)buf[1]) + 2;
 		parse_descriptors(TABLE_PMT, buf, section_length, s,
-				  flags.scantype);
+				  ctx->flags.scantype);
 		buf += descriptor_length;
 		section_length -= descriptor_length;
 		program_info_len -= descriptor_length;
@@ -1283,7 +1446,7 @@ em_static void parse_pmt(const unsigned char *buf,
 				s->audio_num++;
 				parse_descriptors(TABLE_PMT, buf + 5,
 						  ES_info_len, s,
-						  flags.scantype);
+						  ctx->flags.scantype);
 			} else
 				warning
 				    ("more than %i audio channels, truncating\n",
@@ -1327,7 +1490,7 @@ em_static void parse_pmt(const unsigned char *buf,
 					parse_descriptors(TABLE_PMT,
 							  buf + 5,
 							  ES_info_len,
-							  s, flags.scantype);
+							  s, ctx->flags.scantype);
 				} else
 					warning
 					    ("more than %i ac3 audio channels, truncating\n",
@@ -1347,7 +1510,7 @@ em_static void parse_pmt(const unsigned char *buf,
 					parse_descriptors(TABLE_PMT,
 							  buf + 5,
 							  ES_info_len,
-							  s, flags.scantype);
+							  s, ctx->flags.scantype);
 				} else
 					warning
 					    ("more than %i eac3 audio channels, truncating\n",
@@ -1418,7 +1581,7 @@ em_static void parse_pmt(const unsigned char *buf,
 			moreverbose
 			    ("  ADTS Audio Stream (usually AAC) : PID %d (stream type 0x%x)\n",
 			     elementary_pid, buf[0]);
-			if ((output_format == OUTPUT_VDR) && (flags.vdr_version != 2))	// CHECK!
+			if ((ctx->output_format == OUTPUT_VDR) && (ctx->flags.vdr_version != 2))	// CHECK!
 				break;	/* not supported by VDR-1.2..1.7.?? */
 			if (s->audio_num < AUDIO_CHAN_MAX) {
 				s->audio_pid[s->audio_num] = elementary_pid;
@@ -1426,7 +1589,7 @@ em_static void parse_pmt(const unsigned char *buf,
 				s->audio_num++;
 				parse_descriptors(TABLE_PMT, buf + 5,
 						  ES_info_len, s,
-						  flags.scantype);
+						  ctx->flags.scantype);
 			} else
 				warning
 				    ("more than %i audio channels, truncating\n",
@@ -1441,7 +1604,7 @@ em_static void parse_pmt(const unsigned char *buf,
 			moreverbose
 			    ("  ISO/IEC 14496-3 Audio with LATM transport syntax as def. in ISO/IEC 14496-3/AMD1 : PID %d (stream type 0x%x)\n",
 			     elementary_pid, buf[0]);
-			if ((output_format == OUTPUT_VDR) && (flags.vdr_version != 2))	// CHECK!
+			if ((ctx->output_format == OUTPUT_VDR) && (ctx->flags.vdr_version != 2))	// CHECK!
 				break;	/* not supported by VDR-1.2..1.7.?? */
 			if (s->audio_num < AUDIO_CHAN_MAX) {
 				s->audio_pid[s->audio_num] = elementary_pid;
@@ -1449,7 +1612,7 @@ em_static void parse_pmt(const unsigned char *buf,
 				s->audio_num++;
 				parse_descriptors(TABLE_PMT, buf + 5,
 						  ES_info_len, s,
-						  flags.scantype);
+						  ctx->flags.scantype);
 			} else
 				warning
 				    ("more than %i audio channels, truncating\n",
@@ -1528,7 +1691,7 @@ em_static void parse_pmt(const unsigned char *buf,
 				s->ac3_num++;
 				parse_descriptors(TABLE_PMT, buf + 5,
 						  ES_info_len, s,
-						  flags.scantype);
+						  ctx->flags.scantype);
 			} else
 				warning
 				    ("more than %i ac3 audio channels, truncating\n",
@@ -1577,13 +1740,13 @@ em_static void parse_nit(const unsigned char *buf,
 	hexdump(__FUNCTION__, buf, section_length);
 
 	if ((table_id == TABLE_NIT_ACT)
-	    && (current_tp->network_id != network_id)) {
-		print_transponder(buffer, current_tp);
+	    && (ctx->current_tp->network_id != network_id)) {
+		print_transponder(buffer, ctx->current_tp);
 		info("        %s : updating network_id -> (%u:%u:%u)\n",
-		     buffer, current_tp->original_network_id,
-		     network_id, current_tp->transport_stream_id);
-		current_tp->network_id = network_id;
-		if (flags.delete_duplicate_transponders) {
+		     buffer, ctx->current_tp->original_network_id,
+		     network_id, ctx->current_tp->transport_stream_id);
+		ctx->current_tp->network_id = network_id;
+		if (ctx->flags.delete_duplicate_transponders) {
 			check_duplicate_transponders();
 		}
 		if (verbosity > 1)
@@ -1599,7 +1762,7 @@ em_static void parse_nit(const unsigned char *buf,
 	}
 	// update network_name
 	parse_descriptors(table_id, buf + 2, descriptors_loop_len,
-			  current_tp, flags.scantype);
+			  ctx->current_tp, ctx->flags.scantype);
 	section_length -= descriptors_loop_len + 4;
 	buf += descriptors_loop_len + 4;
 
@@ -1625,8 +1788,8 @@ em_static void parse_nit(const unsigned char *buf,
 
 		update_pids = false;
 		memset(&tn, 0, sizeof(tn));
-		tn.type = current_tp->type;
-		tn.network_PID = current_tp->network_PID;
+		tn.type = ctx->current_tp->type;
+		tn.network_PID = ctx->current_tp->network_PID;
 		tn.network_id = network_id;
 		tn.original_network_id = original_network_id;
 		tn.transport_stream_id = transport_stream_id;
@@ -1637,15 +1800,15 @@ em_static void parse_nit(const unsigned char *buf,
 		tn.cells = &tn._cells;
 		NewList(tn.cells, "tn_cells");
 
-		if ((current_tp->original_network_id == original_network_id)
-		    && (current_tp->transport_stream_id == transport_stream_id)
+		if ((ctx->current_tp->original_network_id == original_network_id)
+		    && (ctx->current_tp->transport_stream_id == transport_stream_id)
 		    && (table_id == TABLE_NIT_ACT)) {
 			// if we've found the current tp by onid && ts_id and update it from nit(act), use actual settings as default.
-			copy_fe_params(&tn, current_tp);	//  tn.param = current_tp->param;
+			copy_fe_params(&tn, ctx->current_tp);	//  tn.param = current_tp->param;
 		}
 
 		parse_descriptors(table_id, buf + 6,
-				  descriptors_loop_len, &tn, flags.scantype);
+				  descriptors_loop_len, &tn, ctx->flags.scantype);
 		tn.source |= table_id << 8;
 
 		t = find_transponder(original_network_id, network_id, transport_stream_id);	// try to find tp by transport_stream_id;
@@ -1664,7 +1827,7 @@ em_static void parse_nit(const unsigned char *buf,
 			if (t->locks_with_params && !tn.bandwidth)
 				tn.bandwidth = t->bandwidth;
 			if (table_id == TABLE_NIT_ACT
-			    && flags.delete_duplicate_transponders) {
+			    && ctx->flags.delete_duplicate_transponders) {
 				// only nit_actual should update transponders, too much garbage in satellite nit_other.
 				if (update_pids) {
 					update_pids = false;
@@ -1686,7 +1849,7 @@ em_static void parse_nit(const unsigned char *buf,
 						    transport_stream_id;
 						if (verbosity > 1)
 							list_transponders();
-						if (flags.
+						if (ctx->flags.
 						    delete_duplicate_transponders)
 						{
 							check_duplicate_transponders
@@ -1740,8 +1903,8 @@ em_static void parse_nit(const unsigned char *buf,
 			}
 		} else {
 			// we could not find the transponder by freq and fe_type. probably a new one - so adding it to scan list
-			if (flags.add_frequencies > 0
-			    && (tn.type == flags.scantype)) {
+			if (ctx->flags.add_frequencies > 0
+			    && (tn.type == ctx->flags.scantype)) {
 				if ((t = find_transponder_by_freq(&tn))) {
 					print_transponder(buffer, t);
 					info("        unexpected: already known tp (%s), but not found by pids\n", buffer);
@@ -1780,7 +1943,7 @@ em_static void parse_nit(const unsigned char *buf,
 							}
 						}
 					}
-					if (flags.delete_duplicate_transponders) {
+					if (ctx->flags.delete_duplicate_transponders) {
 						check_duplicate_transponders();
 					}
 					if (verbosity > 1)
@@ -1816,16 +1979,16 @@ em_static void parse_sdt(const unsigned char *buf,
 			break;
 		}
 
-		s = find_service(current_tp, service_id);
+		s = find_service(ctx->current_tp, service_id);
 		if (!s)
 			/* maybe PAT has not yet been parsed... */
-			s = alloc_service(current_tp, service_id);
+			s = alloc_service(ctx->current_tp, service_id);
 
 		s->running = (buf[3] >> 5) & 0x7;
 		s->scrambled = (buf[3] >> 4) & 1;
 
 		parse_descriptors(TABLE_SDT_ACT, buf + 5,
-				  descriptors_loop_len, s, flags.scantype);
+				  descriptors_loop_len, s, ctx->flags.scantype);
 
 		section_length -= descriptors_loop_len + 5;
 		buf += descriptors_loop_len + 5;
@@ -1898,10 +2061,10 @@ em_static void parse_psip_vct(const unsigned char *buf,
 		 * May be finding transponder by transport_stream_id from PAT. However, setting
 		 * t->transport_stream_id from data in PAT may collide with the current DVB scan algorithm.
 		 */
-		current_tp->source = 0x40 << 8 | table_id;
-		s = find_service(current_tp, ch.program_number);
+		ctx->current_tp->source = 0x40 << 8 | table_id;
+		s = find_service(ctx->current_tp, ch.program_number);
 		if (!s)
-			s = alloc_service(current_tp, ch.program_number);
+			s = alloc_service(ctx->current_tp, ch.program_number);
 
 		if (s->service_name)
 			free(s->service_name);
@@ -1953,6 +2116,48 @@ static void set_bit(uint8_t * bitfield, int bit)
 	bitfield[bit / 8] |= 1 << (bit % 8);
 }
 
+static void parse_table(const unsigned char *buf, uint16_t section_length,
+			uint8_t table_id, uint16_t table_id_ext, int pid,
+			uint32_t section_flags)
+{
+	switch (table_id) {
+	case TABLE_PAT:
+		//verbose("PAT for transport_stream_id %d (0x%04x)\n", table_id_ext, table_id_ext);
+		parse_pat(buf, section_length, table_id_ext, section_flags);
+		break;
+	case TABLE_PMT:
+		verbose
+		    ("PMT %d (0x%04x) for service %d (0x%04x)\n",
+		     pid, pid, table_id_ext, table_id_ext);
+		parse_pmt(buf, section_length, table_id_ext);
+		break;
+	case TABLE_NIT_ACT:
+	case TABLE_NIT_OTH:
+		//verbose("NIT(%s TS, network_id %d (0x%04x) )\n", table_id == 0x40 ? "actual":"other",
+		//       table_id_ext, table_id_ext);
+		parse_nit(buf, section_length, table_id,
+			  table_id_ext, section_flags);
+		break;
+	case TABLE_SDT_ACT:
+	case TABLE_SDT_OTH:
+		verbose
+		    ("SDT(%s TS, transport_stream_id %d (0x%04x) )\n",
+		     table_id == 0x42 ? "actual" : "other",
+		     table_id_ext, table_id_ext);
+		parse_sdt(buf, section_length, table_id_ext);
+		break;
+	case TABLE_VCT_TERR:
+	case TABLE_VCT_CABLE:
+		verbose
+		    ("ATSC VCT, table_id %d, table_id_ext %d\n",
+		     table_id, table_id_ext);
+		parse_psip_vct(buf, section_length, table_id,
+			       table_id_ext);
+		break;
+	default:;
+	}
+}
+
 /*   returns 0 when more sections are expected
  *           1 when all sections are read on this pid
  *          -1 on invalid table id
@@ -1960,6 +2165,7 @@ static void set_bit(uint8_t * bitfield, int bit)
 static int parse_section(struct section_buf *s)
 {
 	const unsigned char *buf = s->buf;
+	const unsigned char *section = s->buf;	// s may change to a segment below.
 	uint8_t table_id;
 //uint8_t  section_syntax_indicator;
 	uint16_t section_length;	// 12bit: 0..4095
@@ -1971,6 +2177,7 @@ static int parse_section(struct section_buf *s)
 //int pcr_pid;
 //int program_info_length;
 	int i;
+	uint64_t trace_start;
 
 	table_id = buf[0];
 	if (s->table_id != table_id)
@@ -1981,7 +2188,8 @@ static int parse_section(struct section_buf *s)
 	if (!crc_check(&buf[0], section_length + 12)) {
 		int verbosity = 5;
 		int slow_rep_rate =
-		    30 + repetition_rate(flags.scantype, s->table_id);
+		    30 + repetition_rate(ctx->flags.scantype, s->table_id);
+		stats_crc_error(table_id);
 		hexdump(__FUNCTION__, &buf[0], section_length + 14);
 		if (s->timeout < slow_rep_rate) {
 			info("increasing filter timeout to %d secs (pid:%d table_id:%d table_id_ext:%d).\n", slow_rep_rate, s->pid, s->table_id, s->table_id_ext);
@@ -2003,6 +2211,7 @@ static int parse_section(struct section_buf *s)
 		//    return fuzzy_section(s);
 		return 0;
 	}
+	stats_section(table_id);
 
 	table_id_ext = (buf[3] << 8) | buf[4];	// p.program_number
 	section_version_number = (buf[5] >> 1) & 0x1f;	// p.version_number = getBits (b, 0, 42, 5); -> 40 + 1 -> 5 bit weit? -> version_number = buf[5] & 0x3e;
@@ -2044,6 +2253,12 @@ static int parse_section(struct section_buf *s)
 			     s->section_version_number,
 			     section_version_number, s->table_id_ext,
 			     table_id_ext);
+		if (s->flags & SECTION_FLAG_MONITOR)
+			monitor_version(ctx->current_tp, table_id,
+					table_id_ext,
+					s->table_id_ext == table_id_ext ?
+					s->section_version_number : -1,
+					section_version_number);
 		s->table_id_ext = table_id_ext;
 		s->section_version_number = section_version_number;
 		s->sectionfilter_done = 0;
@@ -2063,49 +2278,30 @@ static int parse_section(struct section_buf *s)
 		     table_id_ext, section_number, last_section_number,
 		     section_version_number);
 
-		switch (table_id) {
-		case TABLE_PAT:
-			//verbose("PAT for transport_stream_id %d (0x%04x)\n", table_id_ext, table_id_ext);
-			parse_pat(buf, section_length, table_id_ext, s->flags);
-			break;
-		case TABLE_PMT:
-			verbose
-			    ("PMT %d (0x%04x) for service %d (0x%04x)\n",
-			     s->pid, s->pid, table_id_ext, table_id_ext);
-			parse_pmt(buf, section_length, table_id_ext);
-			break;
-		case TABLE_NIT_ACT:
-		case TABLE_NIT_OTH:
-			//verbose("NIT(%s TS, network_id %d (0x%04x) )\n", table_id == 0x40 ? "actual":"other",
-			//       table_id_ext, table_id_ext);
-			parse_nit(buf, section_length, table_id,
-				  table_id_ext, s->flags);
-			break;
-		case TABLE_SDT_ACT:
-		case TABLE_SDT_OTH:
-			verbose
-			    ("SDT(%s TS, transport_stream_id %d (0x%04x) )\n",
-			     table_id == 0x42 ? "actual" : "other",
-			     table_id_ext, table_id_ext);
-			parse_sdt(buf, section_length, table_id_ext);
-			break;
-		case TABLE_VCT_TERR:
-		case TABLE_VCT_CABLE:
-			verbose
-			    ("ATSC VCT, table_id %d, table_id_ext %d\n",
-			     table_id, table_id_ext);
-			parse_psip_vct(buf, section_length, table_id,
-				       table_id_ext);
-			break;
-		default:;
-		}
+		if (ctx->si_cache)
+			si_cache_section(ctx->si_cache, section);
+		if (s->flags & SECTION_FLAG_PROBE)
+			return 1;	// version number only, see scan_tp_dvb().
+
+		trace_start = trace_begin();
+		parse_table(buf, section_length, table_id, table_id_ext,
+			    s->pid, s->flags);
+		trace_end(trace_start, "parse", s->fd, s->pid, table_id,
+			  ctx->current_tp ? ctx->current_tp->frequency : 0);
+	}
 
+	// monitor: restarted filters find all sections of a version done.
+	if (!s->sectionfilter_done) {
 		for (i = 0; i <= last_section_number; i++)
 			if (get_bit(s->section_done, i) == 0)
 				break;
 
-		if (i > last_section_number)
+		if (i > last_section_number) {
 			s->sectionfilter_done = 1;
+			if (s->flags & SECTION_FLAG_MONITOR)
+				monitor_table_done(ctx->current_tp, table_id,
+						   table_id_ext);
+		}
 	}
 
 	if (s->segmented) {
@@ -2123,7 +2319,7 @@ static int read_sections(struct section_buf *s)
 {
 	int section_length, count;
 
-	if (s->sectionfilter_done && !s->segmented)
+	if (s->sectionfilter_done && !s->segmented && s->run_once)
 		return 1;
 
 	/* the section filter API guarantess that we get one full section
@@ -2151,16 +2347,6 @@ static int read_sections(struct section_buf *s)
 	return 0;
 }
 
-cList _running_filters, *running_filters = &_running_filters;
-cList _waiting_filters, *waiting_filters = &_waiting_filters;
-static int n_running;
-// see http://www.linuxtv.org/pipermail/linux-dvb/2005-October/005577.html:
-// #define MAX_RUNNING 32
-#define MAX_RUNNING 27
-
-static struct pollfd poll_fds[MAX_RUNNING];
-static struct section_buf *poll_section_bufs[MAX_RUNNING];
-
 static void setup_filter(struct section_buf *s, const char *dmx_devname,
 			 int pid, int table_id, int table_id_ext,
 			 int run_once, int segmented, uint32_t filter_flags)
@@ -2176,10 +2362,10 @@ static void setup_filter(struct section_buf *s, const char *dmx_devname,
 	s->run_once = run_once;
 	s->segmented = segmented;
 	s->timeout = 1;		// add 1sec for safety..
-	if (flags.filter_timeout > 0)
-		s->timeout += 5 * repetition_rate(flags.scantype, table_id);
+	if (ctx->flags.filter_timeout > 0)
+		s->timeout += 5 * repetition_rate(ctx->flags.scantype, table_id);
 	else
-		s->timeout += repetition_rate(flags.scantype, table_id);
+		s->timeout += repetition_rate(ctx->flags.scantype, table_id);
 
 	s->table_id_ext = table_id_ext;
 	s->section_version_number = -1;
@@ -2193,31 +2379,32 @@ static void update_poll_fds(void)
 	struct section_buf *s;
 	int i;
 
-	memset(poll_section_bufs, 0, sizeof(poll_section_bufs));
+	memset(ctx->poll_section_bufs, 0, sizeof(ctx->poll_section_bufs));
 	for (i = 0; i < MAX_RUNNING; i++)
-		poll_fds[i].fd = -1;
+		ctx->poll_fds[i].fd = -1;
 	i = 0;
-	for (s = running_filters->first; s; s = s->next) {
+	for (s = ctx->running_filters->first; s; s = s->next) {
 		if (i >= MAX_RUNNING)
 			fatal("too many poll_fds\n");
 		if (s->fd == -1)
 			fatal("s->fd == -1 on running_filters\n");
 		verbosedebug("poll fd %d\n", s->fd);
-		poll_fds[i].fd = s->fd;
-		poll_fds[i].events = POLLIN;
-		poll_fds[i].revents = 0;
-		poll_section_bufs[i] = s;
+		ctx->poll_fds[i].fd = s->fd;
+		ctx->poll_fds[i].events = POLLIN;
+		ctx->poll_fds[i].revents = 0;
+		ctx->poll_section_bufs[i] = s;
 		i++;
 	}
-	if (i != n_running)
+	if (i != ctx->n_running)
 		fatal("n_running is hosed\n");
+	trace_filters(ctx->n_running, ctx->waiting_filters->count);
 }
 
 static int start_filter(struct section_buf *s)
 {
 	struct dmx_sct_filter_params f;
 
-	if (n_running >= MAX_RUNNING) {
+	if (ctx->n_running >= MAX_RUNNING) {
 		verbose("%s: too much filters. skip for now\n", __FUNCTION__);
 		goto err0;
 	}
@@ -2239,6 +2426,8 @@ static int start_filter(struct section_buf *s)
 
 	f.timeout = 0;
 	f.flags = DMX_IMMEDIATE_START;
+	if (s->flags & SECTION_FLAG_MONITOR)
+		f.flags |= DMX_CHECK_CRC;
 
 	if (ioctl(s->fd, DMX_SET_FILTER, &f) == -1) {
 		errorn("ioctl DMX_SET_FILTER failed");
@@ -2247,10 +2436,12 @@ static int start_filter(struct section_buf *s)
 
 	s->sectionfilter_done = 0;
 	time(&s->start_time);
+	trace_filter(true, s, s->fd, s->pid, s->table_id,
+		     ctx->current_tp ? ctx->current_tp->frequency : 0);
 
-	AddItem(running_filters, s);
+	AddItem(ctx->running_filters, s);
 
-	n_running++;
+	ctx->n_running++;
 	update_poll_fds();
 
 	return 0;
@@ -2265,15 +2456,17 @@ err0:
 static void stop_filter(struct section_buf *s)
 {
 	verbosedebug("%s: pid %d (0x%04x)\n", __FUNCTION__, s->pid, s->pid);
+	trace_filter(false, s, s->fd, s->pid, s->table_id,
+		     ctx->current_tp ? ctx->current_tp->frequency : 0);
 
 	ioctl(s->fd, DMX_STOP);
 	close(s->fd);
 
 	s->fd = -1;
-	UnlinkItem(running_filters, s, false);
+	UnlinkItem(ctx->running_filters, s, false);
 	s->running_time += time(NULL) - s->start_time;
 
-	n_running--;
+	ctx->n_running--;
 	update_poll_fds();
 	if (s->garbage) {
 		ClearList(s->garbage);
@@ -2286,8 +2479,10 @@ static void add_filter(struct section_buf *s)
 	verbosedebug("%s %d: pid=%d (0x%04x), s=%p\n",
 		     __FUNCTION__, __LINE__, s->pid, s->pid, s);
 	EMUL(em_addfilter, s)
-	    if (start_filter(s))	// could not start filter immediately.
-		AddItem(waiting_filters, s);
+	    if (start_filter(s)) {	// could not start filter immediately.
+		AddItem(ctx->waiting_filters, s);
+		trace_filters(ctx->n_running, ctx->waiting_filters->count);
+	}
 }
 
 static void remove_filter(struct section_buf *s)
@@ -2300,14 +2495,14 @@ static void remove_filter(struct section_buf *s)
 		s = NULL;
 	}
 
-	if (running_filters->count > (MAX_RUNNING - 1))	// maximum num of filters reached.
+	if (ctx->running_filters->count > (MAX_RUNNING - 1))	// maximum num of filters reached.
 		return;
 
-	for (s = waiting_filters->first; s; s = s->next) {
-		UnlinkItem(waiting_filters, s, false);
+	for (s = ctx->waiting_filters->first; s; s = s->next) {
+		UnlinkItem(ctx->waiting_filters, s, false);
 		if (start_filter(s)) {
 			// any non-zero is error -> put again to list.
-			InsertItem(waiting_filters, s, 0);
+			InsertItem(ctx->waiting_filters, s, 0);
 			break;
 		}
 	}
@@ -2322,25 +2517,31 @@ static int read_filters(void)
 	struct section_buf *s;
 	int i, n, done = 0;
 
-	n = poll(poll_fds, n_running, 25);
+	n = poll(ctx->poll_fds, ctx->n_running, 25);
 	if (n == -1)
 		errorn("poll");
 
-	for (i = 0; i < n_running; i++) {
-		s = poll_section_bufs[i];
+	for (i = 0; i < ctx->n_running; i++) {
+		s = ctx->poll_section_bufs[i];
 		if (!s)
 			fatal("poll_section_bufs[%d] is NULL\n", i);
-		if (poll_fds[i].revents)
+		if (ctx->poll_fds[i].revents)
 			done = read_sections(s) == 1;
 		else
 			done = 0;	/* timeout */
-		if (done || time(NULL) > s->start_time + s->timeout) {
-			if (s->run_once) {
+		// interrupted: stop all filters, no more waiting for data.
+		if (done || ctx->interrupted
+		    || time(NULL) > s->start_time + s->timeout) {
+			if (s->run_once || ctx->interrupted) {
+				if (done)
+					stats_filter_done(s->table_id);
+				else
+					stats_filter_timeout(s->table_id);
 				if (done)
 					verbosedebug
 					    ("filter success: pid 0x%04x\n",
 					     s->pid);
-				else {
+				else if (!ctx->interrupted) {
 					const char *intro =
 					    "        Info: no data from ";
 					// timeout waiting for data.
@@ -2477,96 +2678,96 @@ static int set_frontend(int frontend_fd, struct transponder *t)
 	switch (t->type) {
 	case SCAN_SATELLITE:
 		if (t->delsys == SYS_DVBS2) {
-			if (!(fe_info.caps & FE_CAN_2G_MODULATION)) {
+			if (!(ctx->fe_info.caps & FE_CAN_2G_MODULATION)) {
 				info("\t%d: skipped (no driver support)\n",
 				     freq_scale(t->frequency, 1e-3));
 				return -2;
 			}
 		}
 
-		if (scr_config.user_frequency > 0) {
+		if (ctx->scr_config.user_frequency > 0) {
 			// satellite channel routing.
 			if (setup_scr
-			    (frontend_fd, t, &this_lnb, &scr_config) != 0)
+			    (frontend_fd, t, &ctx->this_lnb, &ctx->scr_config) != 0)
 				return -2;
-			// repeat diseqc sequence after 100msec, because it may fail and we cannot check here.
-			usleep(100000);
-			if (setup_scr(frontend_fd, t, &this_lnb, &scr_config))
-				return -2;
-			intermediate_freq = (scr_config.user_frequency + scr_config.offset) * 1000UL;	// tune dvb card to users freq. NOTE: MHz -> kHz.
-		} else if (this_lnb.high_val) {
-			if (this_lnb.switch_val) {	// voltage controlled switch
+			intermediate_freq = (ctx->scr_config.user_frequency + ctx->scr_config.offset) * 1000UL;	// tune dvb card to users freq. NOTE: MHz -> kHz.
+		} else if (ctx->this_lnb.high_val) {
+			if (ctx->this_lnb.switch_val) {	// voltage controlled switch
 				switch_to_high_band = 0;
 
-				if (t->frequency >= this_lnb.switch_val)
+				if (t->frequency >= ctx->this_lnb.switch_val)
 					switch_to_high_band++;
 
-				if (flags.emulate == 0) {
-					if (setup_switch
-					    (frontend_fd,
-					     committed_switch,
-					     t->polarization ==
-					     POLARIZATION_VERTICAL ? 0 :
-					     1, switch_to_high_band,
-					     uncommitted_switch) != 0)
+				if (ctx->flags.emulate == 0) {
+					switch (setup_switch
+						(frontend_fd,
+						 ctx->committed_switch,
+						 t->polarization ==
+						 POLARIZATION_VERTICAL ? 0 :
+						 1, switch_to_high_band,
+						 ctx->uncommitted_switch)) {
+					case 0:
+						usleep(50000);
+						break;
+					case 1:	// unchanged, no need to settle.
+						break;
+					default:
 						return -2;	//error
-
-					usleep(50000);
+					}
 				} else {
 					em_lnb(switch_to_high_band,
-					       this_lnb.high_val,
-					       this_lnb.low_val);
+					       ctx->this_lnb.high_val,
+					       ctx->this_lnb.low_val);
 				}
 
 				if (switch_to_high_band)
 					intermediate_freq =
 					    abs(t->frequency -
-						this_lnb.high_val);
+						ctx->this_lnb.high_val);
 				else
 					intermediate_freq =
 					    abs(t->frequency -
-						this_lnb.low_val);
+						ctx->this_lnb.low_val);
 			} else {	// C-Band Multipoint LNB
 				if (t->polarization == POLARIZATION_VERTICAL)
 					intermediate_freq =
 					    abs(t->frequency -
-						this_lnb.low_val);
+						ctx->this_lnb.low_val);
 				else
 					intermediate_freq =
 					    abs(t->frequency -
-						this_lnb.high_val);
+						ctx->this_lnb.high_val);
 				em_lnb(t->polarization !=
 				       POLARIZATION_VERTICAL,
-				       this_lnb.high_val, this_lnb.low_val);
+				       ctx->this_lnb.high_val, ctx->this_lnb.low_val);
 			}
 		} else {	// Monopoint LNB w/o switch
 			intermediate_freq =
-			    abs(t->frequency - this_lnb.low_val);
-			em_lnb(0, 0, this_lnb.low_val);
+			    abs(t->frequency - ctx->this_lnb.low_val);
+			em_lnb(0, 0, ctx->this_lnb.low_val);
 		}
 		em_polarization(t->polarization);
 
-		if ((intermediate_freq < fe_info.frequency_min)
-		    || (intermediate_freq > fe_info.frequency_max)) {
-			info("\t skipped: (freq %.2f unsupported by driver: min=%.2f, max=%.2f)\n", intermediate_freq / 1e6, fe_info.frequency_min / 1e6, fe_info.frequency_max / 1e6);
+		if ((intermediate_freq < ctx->fe_info.frequency_min)
+		    || (intermediate_freq > ctx->fe_info.frequency_max)) {
+			info("\t skipped: (freq %.2f unsupported by driver: min=%.2f, max=%.2f)\n", intermediate_freq / 1e6, ctx->fe_info.frequency_min / 1e6, ctx->fe_info.frequency_max / 1e6);
 			return -2;
 		}
 
-		if ((t->symbolrate < fe_info.symbol_rate_min)
-		    || (t->symbolrate > fe_info.symbol_rate_max)) {
+		if ((t->symbolrate < ctx->fe_info.symbol_rate_min)
+		    || (t->symbolrate > ctx->fe_info.symbol_rate_max)) {
 			info("\t skipped: (srate %u unsupported by driver)\n",
 			     t->symbolrate);
 			return -2;
 		}
 
-		if (sat_list[this_channellist].rotor_position > -1) {	// rotate DiSEqC rotor to correct orbital position
+		if (sat_rotor_position(ctx->this_channellist) > -1) {	// rotate DiSEqC rotor to correct orbital position
 			/*
 			   if (t->orbital_position)
 			   rotor_pos = rotor_nn(t->orbital_position, t->west_east_flag);
 			 */
-			if (rotate_rotor(frontend_fd, &this_rotor_pos,
-					 sat_list
-					 [this_channellist].rotor_position,
+			if (rotate_rotor(frontend_fd, &ctx->this_rotor_pos,
+					 sat_rotor_position(ctx->this_channellist),
 					 t->polarization ==
 					 POLARIZATION_VERTICAL ? 0 : 1,
 					 switch_to_high_band))
@@ -2575,23 +2776,23 @@ static int set_frontend(int frontend_fd, struct transponder *t)
 		break;		//END: case SCAN_SATELLITE
 
 	case SCAN_CABLE:	// note: fall trough to TERR && ATSC
-		if ((t->symbolrate < fe_info.symbol_rate_min)
-		    || (t->symbolrate > fe_info.symbol_rate_max)) {
+		if ((t->symbolrate < ctx->fe_info.symbol_rate_min)
+		    || (t->symbolrate > ctx->fe_info.symbol_rate_max)) {
 			info("\t skipped: (srate %u unsupported by driver)\n",
 			     t->symbolrate);
 			return -2;
 		}
 	case SCAN_TERRESTRIAL:
 		if (t->delsys == SYS_DVBT2) {
-			if (!(fe_info.caps & FE_CAN_2G_MODULATION)) {
+			if (!(ctx->fe_info.caps & FE_CAN_2G_MODULATION)) {
 				info("\t%d: skipped (no driver support of DVBT2)\n", t->frequency);
 				return -2;
 			}
 		}
 		// no break needed here.
 	case SCAN_TERRCABLE_ATSC:
-		if ((t->frequency < fe_info.frequency_min)
-		    || (t->frequency > fe_info.frequency_max)) {
+		if ((t->frequency < ctx->fe_info.frequency_min)
+		    || (t->frequency > ctx->fe_info.frequency_max)) {
 			info("\t skipped: (freq %u unsupported by driver)\n",
 			     t->frequency);
 			return -2;
@@ -2600,10 +2801,12 @@ static int set_frontend(int frontend_fd, struct transponder *t)
 	default:;
 	}
 
+	stats_event(STATS_SWITCH);
+
 	// if (mem_is_zero(&t->param, sizeof(struct tuning_parameters)))
 	//    return -1;
 
-	switch (flags.api_version) {
+	switch (ctx->flags.api_version) {
 	case 0x0500 ... 0x05FF:
 #ifdef HWDBG
 #define set_cmd_sequence(_cmd, _data)   cmds[sequence_len].cmd = _cmd; \
@@ -2671,17 +2874,17 @@ static int set_frontend(int frontend_fd, struct transponder *t)
 		break;
 	default:
 		fatal("unsupported DVB API Version %d.%d\n",
-		      flags.api_version >> 8, flags.api_version & 0xFF);
+		      ctx->flags.api_version >> 8, ctx->flags.api_version & 0xFF);
 	}
 	return 0;
 }
 
 void init_tp(struct transponder *t)
 {
-	current_tp = t;
-	if (current_tp->network_name != NULL) {
-		free(current_tp->network_name);
-		current_tp->network_name = NULL;
+	ctx->current_tp = t;
+	if (ctx->current_tp->network_name != NULL) {
+		free(ctx->current_tp->network_name);
+		ctx->current_tp->network_name = NULL;
 	}
 }
 
@@ -2727,12 +2930,30 @@ uint16_t lock_timeout(uint8_t delsys)
 
 static uint16_t check_frontend(int fd, int verbose);
 
+/* dead frequency cache: the same frequency on another satellite is not the
+ * same transponder.
+ */
+static uint16_t dead_source(struct transponder *t)
+{
+	if (t->type != SCAN_SATELLITE)
+		return 0;
+	return sat_list[ctx->this_channellist].orbital_position |
+	    (sat_list[ctx->this_channellist].west_east_flag == WEST_FLAG ?
+	     0x8000 : 0);
+}
+
+static uint32_t dead_tolerance(struct transponder *t)
+{
+	return t->type == SCAN_SATELLITE ? 2000 : 750000;
+}
+
 static int __tune_to_transponder(int frontend_fd, struct transponder *t, int v)
 {
 	uint16_t ret, lastret;
 	int res;
 	struct timespec timeout, meas_start, meas_stop;
 	uint8_t delsys = t->delsys;
+	uint64_t trace_start;
 
 	if ((verbosity >= 1) && (v > 0)) {
 		char *buf = (char *)malloc(128);	// paranoia, max = 52
@@ -2743,16 +2964,22 @@ static int __tune_to_transponder(int frontend_fd, struct transponder *t, int v)
 		free(buf);
 	}
 
+	stats_tune(t);
+	trace_start = trace_begin();
 	res = set_frontend(frontend_fd, t);
+	trace_end(trace_start, "set_frontend", frontend_fd, -1, -1,
+		  t->frequency);
 
 	if (res < 0)
 		return res;
 
+	stats_event(STATS_TUNED);
+	trace_start = trace_begin();
 	get_time(&meas_start);
-	set_timeout(carrier_timeout(delsys) * flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
+	set_timeout(carrier_timeout(delsys) * ctx->flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
 	ret = 0;
 	lastret = ret;
-	if (!flags.emulate)
+	if (!ctx->flags.emulate)
 		usleep(100000);
 
 	// look for some signal.
@@ -2767,13 +2994,15 @@ static int __tune_to_transponder(int frontend_fd, struct transponder *t, int v)
 				ret & FE_HAS_LOCK ? "L" : "");
 			lastret = ret;
 		}
-		if (timeout_expired(&timeout) || flags.emulate)
+		if (timeout_expired(&timeout) || ctx->flags.emulate)
 			break;
 		usleep(50000);
 	}
+	if (ret & (FE_HAS_SIGNAL | FE_HAS_CARRIER))
+		stats_event(STATS_CARRIER);
 
 	//now, we should get also lock.
-	set_timeout(lock_timeout(delsys) * flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
+	set_timeout(lock_timeout(delsys) * ctx->flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
 	while ((ret & FE_HAS_LOCK) == 0) {
 		ret = check_frontend(frontend_fd, 0);
 		if (ret != lastret) {
@@ -2785,15 +3014,21 @@ static int __tune_to_transponder(int frontend_fd, struct transponder *t, int v)
 				ret & FE_HAS_LOCK ? "L" : "");
 			lastret = ret;
 		}
-		if (timeout_expired(&timeout) || flags.emulate)
+		if (timeout_expired(&timeout) || ctx->flags.emulate)
 			break;
 		usleep(50000);
 	}
+	trace_end(trace_start, ret & FE_HAS_LOCK ? "lock" : "no lock",
+		  frontend_fd, -1, -1, t->frequency);
 
 	if (ret & FE_HAS_LOCK) {
-		current_tp = t;
+		stats_event(STATS_LOCK);
+		ctx->current_tp = t;
 		t->last_tuning_failed = 0;
 		t->locks_with_params = true;
+		dead_cache_forget(ctx->dead_cache, t->frequency, dead_source(t),
+				  t->delsys, t->polarization,
+				  dead_tolerance(t));
 		return 0;
 	}
 
@@ -2824,12 +3059,12 @@ static int tune_to_transponder(int frontend_fd, struct transponder *t)
 	bool known = false;
 
 	/* move TP from "new" to "scanned" list */
-	if (IsMember(new_transponders, t)) {
-		UnlinkItem(new_transponders, t, false);
+	if (IsMember(ctx->new_transponders, t)) {
+		UnlinkItem(ctx->new_transponders, t, false);
 	}
 
-	for (st = scanned_transponders->first; st; st = st->next) {
-		if ((flags.scantype == SCAN_SATELLITE)
+	for (st = ctx->scanned_transponders->first; st; st = st->next) {
+		if ((ctx->flags.scantype == SCAN_SATELLITE)
 		    && (t->polarization != st->polarization))
 			continue;
 		if (is_nearly_same_frequency
@@ -2840,19 +3075,33 @@ static int tune_to_transponder(int frontend_fd, struct transponder *t)
 	}
 
 	if (known == false) {
-		AddItem(scanned_transponders, t);
+		AddItem(ctx->scanned_transponders, t);
+		ctx->scanning = t;
 	}
 
-	if (t->type != flags.scantype) {
+	if (t->type != ctx->flags.scantype) {
 		t->last_tuning_failed = 1;	// ignore cable descriptors in sat NIT and vice versa
 		return -1;
 	}
 
+	if (dead_cache_known(ctx->dead_cache, t->frequency, dead_source(t),
+			     t->delsys, t->polarization, dead_tolerance(t))) {
+		verbose("%u: no lock before, skipped.\n",
+			freq_scale(t->frequency, 1e-3));
+		t->last_tuning_failed = 1;
+		return -1;
+	}
+
 	switch (__tune_to_transponder(frontend_fd, t, 1)) {
 	case 0:
 		return 0;
 	case -1:
-		return __tune_to_transponder(frontend_fd, t, 1);
+		// second try, with AUTO params.
+		if (__tune_to_transponder(frontend_fd, t, 1) == 0)
+			return 0;
+		dead_cache_add(ctx->dead_cache, t->frequency, dead_source(t),
+			       t->delsys, t->polarization, dead_tolerance(t));
+		return -1;
 	case -2:
 		return -2;
 	default:
@@ -2860,15 +3109,170 @@ static int tune_to_transponder(int frontend_fd, struct transponder *t)
 	}
 }
 
+/* tune cost model: estimated cost of retuning the frontend from 'from' to 'to'.
+ * Only the order of the returned values matters, lower means cheaper.
+ * tune_to_next_transponder() always picks the cheapest transponder
+ * from new_transponders, relative to current_tp.
+ */
+#define TUNE_COST_ROTOR  0x40000000U
+#define TUNE_COST_SWITCH 0x10000000U
+
+static uint8_t sat_high_band(struct transponder *t)
+{
+	// C-Band Multipoint and Monopoint LNBs: no band switching.
+	return ctx->this_lnb.high_val && ctx->this_lnb.switch_val
+	    && (t->frequency >= ctx->this_lnb.switch_val);
+}
+
+/* DVB-S/S2: rotor movement > polarization or band change > frequency.
+ * Frequencies are visited ascending; going down costs twice as much,
+ * so that each band/polarization is swept once.
+ * The rotor ranks first, not last: a move takes seconds, a polarization or
+ * band change some 10msec. Ranked last, transponders of the same band and
+ * polarization on two orbital positions would turn the dish back and forth.
+ */
+static uint32_t sat_tune_cost(struct transponder *from, struct transponder *to)
+{
+	uint32_t cost = 0;
+
+	if ((from->orbital_position != to->orbital_position)
+	    || (from->west_east_flag != to->west_east_flag))
+		cost += TUNE_COST_ROTOR;
+	if (from->polarization != to->polarization)
+		cost += TUNE_COST_SWITCH;
+	if (sat_high_band(from) != sat_high_band(to))
+		cost += TUNE_COST_SWITCH;
+	if (to->frequency >= from->frequency)
+		cost += to->frequency - from->frequency;	// kHz
+	else
+		cost += 2 * (from->frequency - to->frequency);
+	return cost;
+}
+
+/* DVB-C, DVB-T, ATSC: PLL settles faster on small frequency steps. */
+static uint32_t freq_tune_cost(struct transponder *from,
+			       struct transponder *to)
+{
+	return diff(from->frequency, to->frequency) / 1000;	// Hz -> kHz
+}
+
+/* move the cheapest transponder to tune next to the head of new_transponders. */
+static void schedule_next_transponder(void)
+{
+	struct transponder *t, *best = NULL;
+	uint32_t cost, best_cost = 0;
+
+	if ((ctx->current_tp == NULL) || (ctx->tune_cost == NULL)
+	    || (ctx->new_transponders->count < 2))
+		return;
+
+	for (t = ctx->new_transponders->first; t; t = t->next) {
+		if (t->frequency == 0)
+			continue;	// needs cell/transposer lookup, keep order.
+		cost = ctx->tune_cost(ctx->current_tp, t);
+		if ((best == NULL) || (cost < best_cost)) {
+			best = t;
+			best_cost = cost;
+		}
+	}
+
+	if ((best != NULL) && (best != ctx->new_transponders->first)) {
+		UnlinkItem(ctx->new_transponders, best, false);
+		InsertItem(ctx->new_transponders, best, 0);
+	}
+}
+
+/* initial scan: channel or initial transponder n is tried by this host
+ * ('--shard') and this frontend (parallel scan).
+ */
+static bool is_my_part(uint32_t n)
+{
+	if (ctx->shard_count > 1) {
+		if (n % ctx->shard_count != ctx->shard)
+			return false;
+		n /= ctx->shard_count;
+	}
+	return n % (ctx->scr_frontends_count + 1) == (uint32_t) ctx->scr_worker;
+}
+
+/* '--shard': the shard (0..n-1) which scans t. Transponders found by our
+ * part of the initial scan are ours, all others are split by (onid, tsid),
+ * or by frequency if not known yet. No shared state: the same on all hosts.
+ */
+static uint32_t shard_owner(struct transponder *t)
+{
+	uint32_t key;
+
+	if ((ctx->shard_count < 2) || t->found_here)
+		return ctx->shard;
+	if (t->original_network_id || t->transport_stream_id)
+		key = (t->original_network_id << 16) | t->transport_stream_id;
+	else
+		key = freq_scale(t->frequency,
+				 t->type == SCAN_SATELLITE ? 1e-3 : 1e-6);
+	return key % ctx->shard_count;
+}
+
+/* parallel scan: returns true, if no other frontend scans this tp.
+ * Called on lock in the initial scan and before tuning a queued tp.
+ */
+static bool claim_transponder(struct transponder *t)
+{
+	uint32_t i;
+	bool claimed = true;
+
+	if (ctx->scr_claims == NULL)
+		return true;
+
+	while (__sync_lock_test_and_set(&ctx->scr_claims->lock, 1))
+		usleep(1000);
+	for (i = 0; i < ctx->scr_claims->count; i++) {
+		if ((ctx->scr_claims->tp[i].polarization == t->polarization)
+		    && is_nearly_same_frequency(ctx->scr_claims->tp[i].frequency,
+						t->frequency, t->type)) {
+			claimed = ctx->scr_claims->tp[i].worker == ctx->scr_worker;
+			break;
+		}
+	}
+	if ((i == ctx->scr_claims->count) && (ctx->scr_claims->count < MAX_SCR_CLAIMS)) {
+		ctx->scr_claims->tp[ctx->scr_claims->count].frequency = t->frequency;
+		ctx->scr_claims->tp[ctx->scr_claims->count].polarization = t->polarization;
+		ctx->scr_claims->tp[ctx->scr_claims->count].worker = ctx->scr_worker;
+		ctx->scr_claims->count++;
+	}
+	__sync_lock_release(&ctx->scr_claims->lock);
+	return claimed;
+}
+
 static int tune_to_next_transponder(int frontend_fd)
 {
 	struct transponder *t;
 	uint8_t i, j;
 
-	while (new_transponders->count) {
-		t = new_transponders->first;
+	while (ctx->new_transponders->count && !ctx->interrupted) {
+		schedule_next_transponder();
+		t = ctx->new_transponders->first;
 		i = 0;
 
+		if (t->frequency && (shard_owner(t) != ctx->shard)) {
+			verbose("%u: scanned by other shard.\n",
+				freq_scale(t->frequency, 1e-3));
+			// the owner may never see the NIT announcing it: '--merge' checks.
+			t->other_shard = shard_owner(t) + 1;
+			UnlinkItem(ctx->new_transponders, t, false);
+			AddItem(ctx->scanned_transponders, t);
+			continue;
+		}
+
+		if (t->frequency && !claim_transponder(t)) {
+			// keep it as known, so that NIT doesnt add it again.
+			verbose("%u: scanned by other frontend.\n",
+				freq_scale(t->frequency, 1e-3));
+			UnlinkItem(ctx->new_transponders, t, false);
+			AddItem(ctx->scanned_transponders, t);
+			continue;
+		}
+
 		if (t->frequency && (tune_to_transponder(frontend_fd, t) == 0))
 			return 0;
 
@@ -2884,7 +3288,7 @@ static int tune_to_next_transponder(int frontend_fd)
 				j = 0;
 				test = find_transponder_by_freq(t);
 				if ((test != NULL)
-				    && !(IsMember(scanned_transponders, test))) {
+				    && !(IsMember(ctx->scanned_transponders, test))) {
 					info("retrying with center_frequency = %u\n", t->frequency);
 					if (tune_to_transponder(frontend_fd, t)
 					    == 0)
@@ -2894,12 +3298,12 @@ static int tune_to_next_transponder(int frontend_fd)
 				while (j < next->num_transposers) {
 					t->frequency =
 					    next->
-					    transposers[j].transposer_frequency;
+					    transposers[j++].transposer_frequency;
 					test = find_transponder_by_freq(t);
 					if ((test != NULL)
 					    &&
 					    !(IsMember
-					      (scanned_transponders, test))) {
+					      (ctx->scanned_transponders, test))) {
 						info("retrying with transposer_frequency = %u\n", t->frequency);
 						if (tune_to_transponder
 						    (frontend_fd, t) == 0)
@@ -2908,14 +3312,14 @@ static int tune_to_next_transponder(int frontend_fd)
 				}
 			}
 		}
-		if (IsMember(new_transponders, t)) {
+		if (IsMember(ctx->new_transponders, t)) {
 			// moving new_transponders -> scanned_transponders is handled in tune_to_transponder(),
 			// but we may pass here w/o calling it. Enshure this tp is moved to scanned_transponders.
 			verbose("skipped: (%u:%u:%u) (time: %s)\n",
 				t->original_network_id, t->network_id,
 				t->transport_stream_id, run_time());
-			UnlinkItem(new_transponders, t, false);
-			AddItem(scanned_transponders, t);
+			UnlinkItem(ctx->new_transponders, t, false);
+			AddItem(ctx->scanned_transponders, t);
 		}
 	}
 	return -1;
@@ -2926,7 +3330,7 @@ static uint16_t check_frontend(int fd, int verbose)
 	fe_status_t status;
 	EMUL(em_status, &status)
 	    ioctl(fd, FE_READ_STATUS, &status);
-	if (verbose && !flags.emulate) {
+	if (verbose && !ctx->flags.emulate) {
 		uint16_t snr, signal;
 		uint32_t ber, uncorrected_blocks;
 
@@ -3043,18 +3447,18 @@ static bool initial_table_lookup(int frontend_fd)
 {
 	struct section_buf s;
 	int result;
-	current_tp->network_PID = PID_NIT_ST;
+	ctx->current_tp->network_PID = PID_NIT_ST;
 	memset(&s, 0, sizeof(s));
 	verbose("        initial PAT lookup..\n");
-	setup_filter(&s, demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0,
+	setup_filter(&s, ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0,
 		     SECTION_FLAG_INITIAL);
 	add_filter(&s);
 	EMUL(em_readfilters, &result)
 	    do {
 		result = read_filters();
 	}
-	while ((running_filters->count > 0)
-	       || (waiting_filters->count > 0));
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0));
 
 	if (result == 0) {
 		// doesnt look like valid tp.
@@ -3062,21 +3466,131 @@ static bool initial_table_lookup(int frontend_fd)
 	}
 	// cxd2820r overwrites silently delsys, toggling between SYS_DVBT && SYS_DVBT2.
 	// Therefore updating current_tp, kindly asking driver for actual delsys.
-	fe_get_delsys(frontend_fd, current_tp);
+	fe_get_delsys(frontend_fd, ctx->current_tp);
 	memset(&s, 0, sizeof(s));
 	verbose("        initial NIT lookup..\n");
-	setup_filter(&s, demux_devname, current_tp->network_PID,
+	setup_filter(&s, ctx->demux_devname, ctx->current_tp->network_PID,
 		     TABLE_NIT_ACT, -1, 1, 0, SECTION_FLAG_INITIAL);
 	add_filter(&s);
 	EMUL(em_readfilters, &result)
 	    do {
 		result = read_filters();
 	}
-	while ((running_filters->count > 0)
-	       || (waiting_filters->count > 0));
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0));
 	return true;
 }
 
+/* read the transponders of a previous scan ('--output db:<file>') with all
+ * their tuning parameters. If map is non-NULL, map[i] is set to the
+ * transponder allocated for db->transponders[i].
+ * Returns the number of transponders.
+ */
+static int warm_start_load(const struct chdb *db, scantype_t type,
+			   struct transponder **map)
+{
+	const struct chdb_transponder *ct;
+	struct transponder *t;
+	uint32_t i;
+	int count = 0;
+
+	for (i = 0; i < db->transponder_count; i++) {
+		ct = &db->transponders[i];
+		if (ct->type != type)
+			continue;
+		t = alloc_transponder(chdb32(ct->frequency), ct->delsys,
+				      ct->polarization);
+		t->type = ct->type;
+		t->source = chdb32(ct->source);
+		t->symbolrate = chdb32(ct->symbolrate);
+		t->bandwidth = chdb32(ct->bandwidth);
+		t->modulation = ct->modulation;
+		t->coderate = ct->coderate;
+		t->coderate_LP = ct->coderate_LP;
+		t->rolloff = ct->rolloff;
+		t->pilot = ct->pilot;
+		t->inversion = ct->inversion;
+		t->input_stream_identifier = ct->input_stream_id;
+		t->guard = ct->guard;
+		t->transmission = ct->transmission;
+		t->hierarchy = ct->hierarchy;
+		t->plp_id = ct->plp_id;
+		t->system_id = chdb16(ct->system_id);
+		t->data_slice_id = ct->data_slice_id;
+		t->orbital_position = chdb16(ct->orbital_position);
+		t->west_east_flag = ct->west_east_flag;
+		t->original_network_id = chdb16(ct->original_network_id);
+		t->network_id = chdb16(ct->network_id);
+		t->transport_stream_id = chdb16(ct->transport_stream_id);
+		if (map != NULL)
+			map[i] = t;
+		count++;
+	}
+	return count;
+}
+
+#define CHECKPOINT_INTERVAL 10	// sec
+
+/* '--checkpoint': at most every CHECKPOINT_INTERVAL seconds, unless forced,
+ * i.e. after scan_interrupt().
+ */
+static void save_checkpoint(bool force)
+{
+	struct transponder *t = ctx->scanning;
+	time_t now = time(NULL);
+
+	if ((ctx->checkpoint == NULL) || (ctx->scr_worker > 0))
+		return;
+	if (!force && (now - ctx->checkpoint_time < CHECKPOINT_INTERVAL))
+		return;
+	ctx->checkpoint_time = now;
+	ctx->cp.scantype = ctx->flags.scantype;
+	ctx->cp.channellist = ctx->this_channellist;
+	ctx->cp.rotor_position = ctx->this_rotor_pos;
+
+	// not done yet: scanned again after resume.
+	if (t && IsMember(ctx->scanned_transponders, t)) {
+		UnlinkItem(ctx->scanned_transponders, t, false);
+		InsertItem(ctx->new_transponders, t, 0);
+	} else
+		t = NULL;
+	if (checkpoint_write(ctx->checkpoint, &ctx->cp,
+			     ctx->scanned_transponders,
+			     ctx->new_transponders) < 0)
+		warning("could not write checkpoint %s: %s\n", ctx->checkpoint,
+			strerror(errno));
+	if (t) {
+		UnlinkItem(ctx->new_transponders, t, false);
+		AddItem(ctx->scanned_transponders, t);
+	}
+}
+
+/* blind scan: position done in the scan which is resumed. */
+static bool resume_skip(uint32_t delsys_parm, uint32_t mod_parm,
+			uint32_t channel)
+{
+	struct checkpoint_state *r = &ctx->resume;
+
+	if (!ctx->resumed)
+		return false;
+	if (delsys_parm != r->delsys_parm)
+		return delsys_parm < r->delsys_parm;
+	if (mod_parm != r->mod_parm)
+		return mod_parm < r->mod_parm;
+	return channel < r->channel;
+}
+
+/* blind scan: channel done, continue with the next one after resume. */
+static void checkpoint_blind_scan(uint32_t delsys_parm, uint32_t mod_parm,
+				  uint32_t channel)
+{
+	ctx->cp.phase = CHECKPOINT_BLIND_SCAN;
+	ctx->cp.delsys_parm = delsys_parm;
+	ctx->cp.mod_parm = mod_parm;
+	ctx->cp.channel = channel + 1;
+	save_checkpoint(false);
+}
+
 static int initial_tune(int frontend_fd, int tuning_data)
 {
 	uint32_t f = 0, channel, cnt, mod_parm, sr_parm, this_sr = 0, offs;
@@ -3091,6 +3605,25 @@ static int initial_tune(int frontend_fd, int tuning_data)
 	struct timespec timeout, meas_start, meas_stop;
 	uint16_t time2carrier = 8000, time2lock = 8000;
 
+	if (ctx->warm_start > 0) {
+		/* all params known: no initial tuning and NIT lookup, the
+		 * transponders are tuned once and scanned in the same pass.
+		 */
+		info("warm start: %d transponders from previous scan%s.\n",
+		     ctx->warm_start, ctx->fill_gaps ? ", searching gaps" : "");
+		if (!ctx->fill_gaps)
+			return tune_to_next_transponder(frontend_fd);
+	}
+	if (ctx->resumed) {
+		info("resuming scan: %u transponders done, %u to do%s.\n",
+		     ctx->scanned_transponders->count,
+		     ctx->new_transponders->count,
+		     ctx->resume.phase == CHECKPOINT_BLIND_SCAN ?
+		     ", continuing initial scan" : "");
+		if (ctx->resume.phase == CHECKPOINT_NETWORK_SCAN)
+			return tune_to_next_transponder(frontend_fd);
+	}
+
 	if (tuning_data <= 0) {
 
 		/* ---- w_scan2 blindscan loop ----
@@ -3104,39 +3637,39 @@ static int initial_tune(int frontend_fd, int tuning_data)
 		 */
 
 		//do last things before starting scan loop
-		switch (flags.scantype) {
+		switch (ctx->flags.scantype) {
 		case SCAN_TERRCABLE_ATSC:
-			switch (ATSC_type) {
+			switch (ctx->ATSC_type) {
 			case ATSC_VSB:
-				modulation_min = modulation_max = ATSC_VSB;
+				ctx->modulation_min = ctx->modulation_max = ATSC_VSB;
 				break;
 			case ATSC_QAM:
-				modulation_min = modulation_max = ATSC_QAM;
+				ctx->modulation_min = ctx->modulation_max = ATSC_QAM;
 				break;
 			default:
-				modulation_min = ATSC_VSB;
-				modulation_max = ATSC_QAM;
+				ctx->modulation_min = ATSC_VSB;
+				ctx->modulation_max = ATSC_QAM;
 				break;
 			}
 			// disable symbolrate loop
-			dvbc_symbolrate_min = dvbc_symbolrate_max = 0;
+			ctx->dvbc_symbolrate_min = ctx->dvbc_symbolrate_max = 0;
 			break;
 		case SCAN_TERRESTRIAL:
 			// disable qam loop, disable symbolrate loop
-			modulation_min = modulation_max = 0;
-			dvbc_symbolrate_min = dvbc_symbolrate_max = 0;
+			ctx->modulation_min = ctx->modulation_max = 0;
+			ctx->dvbc_symbolrate_min = ctx->dvbc_symbolrate_max = 0;
 			// enable legacy delsys loop.
-			delsys_min = delsysloop_min(0, this_channellist, flags.delsys);
+			ctx->delsys_min = delsysloop_min(0, ctx->this_channellist, ctx->flags.delsys);
 			// enable T2 loop.
-			delsys_max = delsysloop_max(0, this_channellist, flags.delsys);
+			ctx->delsys_max = delsysloop_max(0, ctx->this_channellist, ctx->flags.delsys);
 			break;
 		case SCAN_CABLE:
 			// if choosen srate is too high for channellist's bandwidth,
 			// fall back to scan all srates. scan loop will skip unsupported srates later.
-			if (dvbc_symbolrate(dvbc_symbolrate_min) >
-			    max_dvbc_srate(freq_step(0, this_channellist))) {
-				dvbc_symbolrate_min = 0;
-				dvbc_symbolrate_max = 17;
+			if (dvbc_symbolrate(ctx->dvbc_symbolrate_min) >
+			    max_dvbc_srate(freq_step(0, ctx->this_channellist))) {
+				ctx->dvbc_symbolrate_min = 0;
+				ctx->dvbc_symbolrate_max = 17;
 			}
 			// enable C2 loop.
 			//delsys_max = 1;  // enable it later here.
@@ -3144,38 +3677,44 @@ static int initial_tune(int frontend_fd, int tuning_data)
 		case SCAN_SATELLITE:
 			// channel means here: transponder,
 			// last channel == (item_count - 1) since we're counting from 0
-			channel_max = sat_list[this_channellist].item_count - 1;
+			channel_max = sat_list[ctx->this_channellist].item_count - 1;
 			// disable qam loop
-			modulation_min = modulation_max = 0;
+			ctx->modulation_min = ctx->modulation_max = 0;
 			// disable symbolrate loop
-			dvbc_symbolrate_min = dvbc_symbolrate_max = 0;
+			ctx->dvbc_symbolrate_min = ctx->dvbc_symbolrate_max = 0;
 			// disable freq offset loop
-			freq_offset_min = freq_offset_max = 0;
+			ctx->freq_offset_min = ctx->freq_offset_max = 0;
 			break;
 		default:
 			warning("unsupported delivery system %d.\n",
-				flags.scantype);
+				ctx->flags.scantype);
 		}
 
 		/* ATSC VSB, ATSC QAM, DVB-T, DVB-C, DVB-S(2) here,
 		 * please change freqs inside country.c for ATSC, DVB-T, DVB-C
 		 * and inside satellites.c for DVB-S(2)
 		 */
-		for (delsys_parm = delsys_min; delsys_parm <= delsys_max; delsys_parm++) {
-			if ((delsys_parm > 0) && ((fe_info.caps & FE_CAN_2G_MODULATION) == 0)) {
+		for (delsys_parm = ctx->delsys_min; delsys_parm <= ctx->delsys_max; delsys_parm++) {
+			if ((delsys_parm > 0) && ((ctx->fe_info.caps & FE_CAN_2G_MODULATION) == 0)) {
 				break;
 			}
-			for (mod_parm = modulation_min; mod_parm <= modulation_max; mod_parm++) {
+			for (mod_parm = ctx->modulation_min; mod_parm <= ctx->modulation_max; mod_parm++) {
 				for (channel = 0; channel <= channel_max; channel++) {
-					for (offs = freq_offset_min; offs <= freq_offset_max; offs++) {
-						for (sr_parm = dvbc_symbolrate_min; sr_parm <= dvbc_symbolrate_max; sr_parm++) {
-							if (flags.scantype == SCAN_TERRESTRIAL) {
+					if (ctx->interrupted)
+						break;
+					if (!is_my_part(channel))
+						continue;	// other shard or frontend.
+					if (resume_skip(delsys_parm, mod_parm, channel))
+						continue;
+					for (offs = ctx->freq_offset_min; offs <= ctx->freq_offset_max; offs++) {
+						for (sr_parm = ctx->dvbc_symbolrate_min; sr_parm <= ctx->dvbc_symbolrate_max; sr_parm++) {
+							if (ctx->flags.scantype == SCAN_TERRESTRIAL) {
 								// set plp_id range for DVB-T : DVB-T2
-								plp_id_min = delsys_parm == 0 ? 0 : plp_id_loop_min (flags.list_id);
-								plp_id_max = delsys_parm == 0 ? 0 : plp_id_loop_max (flags.list_id);
+								ctx->plp_id_min = delsys_parm == 0 ? 0 : plp_id_loop_min (ctx->flags.list_id);
+								ctx->plp_id_max = delsys_parm == 0 ? 0 : plp_id_loop_max (ctx->flags.list_id);
 							}
-							for (plp_id_parm = plp_id_min; plp_id_parm <= plp_id_max; plp_id_parm++) {
-								test.type = flags.scantype;
+							for (plp_id_parm = ctx->plp_id_min; plp_id_parm <= ctx->plp_id_max; plp_id_parm++) {
+								test.type = ctx->flags.scantype;
 								switch (test.type) {
 								case SCAN_TERRESTRIAL:
 									if (delsys_parm != last_delsys)	{
@@ -3183,22 +3722,22 @@ static int initial_tune(int frontend_fd, int tuning_data)
 										info("Scanning DVB-%s...\n", delsys == SYS_DVBT ? "T" : "T2");
 										last_delsys = delsys_parm;
 									}
-									f = chan_to_freq(channel, this_channellist);
+									f = chan_to_freq(channel, ctx->this_channellist);
 									if (!f)
 										continue;	//skip unused channels
-									if (freq_offset(channel, this_channellist, offs) == -1)
+									if (freq_offset(channel, ctx->this_channellist, offs) == -1)
 										continue;	//skip this one
-									f += freq_offset(channel, this_channellist, offs);
-									if (test.bandwidth != (__u32) bandwidth(channel, this_channellist))
-										info("Scanning %sMHz frequencies...\n", vdr_bandwidth_name(bandwidth(channel, this_channellist)));
-									test.inversion    = caps_inversion;
-									test.bandwidth    = (__u32)bandwidth(channel, this_channellist);
-									test.coderate     = caps_fec;
-									test.coderate_LP  = caps_fec;
-									test.modulation   = caps_qam;
-									test.transmission = caps_transmission_mode;
-									test.guard        = caps_guard_interval;
-									test.hierarchy    = caps_hierarchy;
+									f += freq_offset(channel, ctx->this_channellist, offs);
+									if (test.bandwidth != (__u32) bandwidth(channel, ctx->this_channellist))
+										info("Scanning %sMHz frequencies...\n", vdr_bandwidth_name(bandwidth(channel, ctx->this_channellist)));
+									test.inversion    = ctx->caps_inversion;
+									test.bandwidth    = (__u32)bandwidth(channel, ctx->this_channellist);
+									test.coderate     = ctx->caps_fec;
+									test.coderate_LP  = ctx->caps_fec;
+									test.modulation   = ctx->caps_qam;
+									test.transmission = ctx->caps_transmission_mode;
+									test.guard        = ctx->caps_guard_interval;
+									test.hierarchy    = ctx->caps_hierarchy;
 									test.delsys       = delsys;
 									test.plp_id       = plp_id_parm;
 									time2carrier      = carrier_timeout(test.delsys);
@@ -3223,7 +3762,7 @@ static int initial_tune(int frontend_fd, int tuning_data)
 								case SCAN_TERRCABLE_ATSC:
 									switch(mod_parm) {
 									case ATSC_VSB:
-										this_atsc = VSB_8;
+										ctx->this_atsc = VSB_8;
 										f = chan_to_freq(channel, ATSC_VSB);
 										if (!f)
 											continue;	//skip unused channels
@@ -3232,7 +3771,7 @@ static int initial_tune(int frontend_fd, int tuning_data)
 										f += freq_offset(channel, ATSC_VSB, offs);
 										break;
 									case ATSC_QAM:
-										this_atsc = QAM_256;
+										ctx->this_atsc = QAM_256;
 										f = chan_to_freq(channel, ATSC_QAM);
 										if (!f)
 											continue;	//skip unused channels
@@ -3244,38 +3783,38 @@ static int initial_tune(int frontend_fd, int tuning_data)
 										fatal("unknown modulation id\n");
 									}
 									test.frequency  = f;
-									test.inversion  = caps_inversion;
-									test.modulation = this_atsc;
-									test.delsys     = atsc_del_sys(this_atsc);
+									test.inversion  = ctx->caps_inversion;
+									test.modulation = ctx->this_atsc;
+									test.delsys     = atsc_del_sys(ctx->this_atsc);
 									time2carrier    = carrier_timeout(test.delsys);
 									time2lock       = lock_timeout(test.delsys);
 									if (is_known_initial_transponder(&test, 0)) {
-										info("%d %s: skipped (already known transponder)\n", freq_scale(f, 1e-3), atsc_mod_to_txt(this_atsc));
+										info("%d %s: skipped (already known transponder)\n", freq_scale(f, 1e-3), atsc_mod_to_txt(ctx->this_atsc));
 										continue;
 									}
-									info("%d: %s", freq_scale(f, 1e-3), atsc_mod_to_txt(this_atsc));
+									info("%d: %s", freq_scale(f, 1e-3), atsc_mod_to_txt(ctx->this_atsc));
 									break;
 								case SCAN_CABLE:
-									f = chan_to_freq(channel, this_channellist);
+									f = chan_to_freq(channel, ctx->this_channellist);
 									if (!f)
 										continue;	//skip unused channels
-									if (freq_offset(channel, this_channellist, offs) == -1)
+									if (freq_offset(channel, ctx->this_channellist, offs) == -1)
 										continue;	//skip this one
-									f += freq_offset(channel, this_channellist, offs);
+									f += freq_offset(channel, ctx->this_channellist, offs);
 									this_sr = dvbc_symbolrate(sr_parm);
-									if (this_sr > (uint32_t)max_dvbc_srate(freq_step(channel, this_channellist)))
+									if (this_sr > (uint32_t)max_dvbc_srate(freq_step(channel, ctx->this_channellist)))
 										continue;	//skip symbol rates higher than theoretical limit given by bw && roll_off
-									this_qam = caps_qam;
-									if (flags.qam_no_auto > 0) {
-										this_qam = dvbc_modulation (mod_parm);
-										if (test.modulation != this_qam)
-											info("searching QAM%s...\n", vdr_modulation_name(this_qam));
+									ctx->this_qam = ctx->caps_qam;
+									if (ctx->flags.qam_no_auto > 0) {
+										ctx->this_qam = dvbc_modulation (mod_parm);
+										if (test.modulation != ctx->this_qam)
+											info("searching QAM%s...\n", vdr_modulation_name(ctx->this_qam));
 									}
-									test.inversion  = caps_inversion;
+									test.inversion  = ctx->caps_inversion;
 									test.delsys     = SYS_DVBC_ANNEX_A;
-									test.modulation = this_qam;
+									test.modulation = ctx->this_qam;
 									test.symbolrate = this_sr;
-									test.coderate   = caps_fec;
+									test.coderate   = ctx->caps_fec;
 									time2carrier    = carrier_timeout(test.delsys);
 									time2lock       = lock_timeout(test.delsys);
 									if (f != test.frequency) {
@@ -3292,21 +3831,21 @@ static int initial_tune(int frontend_fd, int tuning_data)
 									}
 									break;
 								case SCAN_SATELLITE:
-									test.inversion        = caps_inversion;
-									test.frequency        = sat_list[this_channellist].items[channel].intermediate_frequency * 1000;
-									test.symbolrate       = sat_list[this_channellist].items[channel].symbol_rate * 1000;
-									test.coderate         = sat_list[this_channellist].items[channel].fec_inner;
-									test.modulation       = sat_list[this_channellist].items[channel].modulation_type;
+									test.inversion        = ctx->caps_inversion;
+									test.frequency        = sat_list[ctx->this_channellist].items[channel].intermediate_frequency * 1000;
+									test.symbolrate       = sat_list[ctx->this_channellist].items[channel].symbol_rate * 1000;
+									test.coderate         = sat_list[ctx->this_channellist].items[channel].fec_inner;
+									test.modulation       = sat_list[ctx->this_channellist].items[channel].modulation_type;
 									test.pilot            = PILOT_AUTO;
-									test.rolloff          = sat_list[this_channellist].items[channel].rolloff;
-									test.delsys           = sat_list[this_channellist].items[channel].modulation_system;
-									test.polarization     = sat_list[this_channellist].items[channel].polarization;
-									test.orbital_position = sat_list[this_channellist].orbital_position;
-									test.west_east_flag   = sat_list[this_channellist].west_east_flag;
+									test.rolloff          = sat_list[ctx->this_channellist].items[channel].rolloff;
+									test.delsys           = sat_list[ctx->this_channellist].items[channel].modulation_system;
+									test.polarization     = sat_list[ctx->this_channellist].items[channel].polarization;
+									test.orbital_position = sat_list[ctx->this_channellist].orbital_position;
+									test.west_east_flag   = sat_list[ctx->this_channellist].west_east_flag;
 									time2carrier          = carrier_timeout(test.delsys);
 									time2lock             = lock_timeout(test.delsys);
 									if (test.delsys == SYS_DVBS2) {
-										if (!(fe_info.caps & FE_CAN_2G_MODULATION) || (flags.api_version < 0x0500)) {
+										if (!(ctx->fe_info.caps & FE_CAN_2G_MODULATION) || (ctx->flags.api_version < 0x0500)) {
 											info("%d: skipped (no driver support)\n", freq_scale(test.frequency, 1e-3));
 											continue;
 										}
@@ -3330,8 +3869,8 @@ static int initial_tune(int frontend_fd, int tuning_data)
 									continue;
 								}
 								get_time(&meas_start);
-								set_timeout(time2carrier * flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
-								if (!flags.emulate)
+								set_timeout(time2carrier * ctx->flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
+								if (!ctx->flags.emulate)
 									usleep(100000);
 								ret = 0;
 								lastret = ret;
@@ -3349,18 +3888,18 @@ static int initial_tune(int frontend_fd, int tuning_data)
 												ret);
 										lastret = ret;
 									}
-									if (timeout_expired(&timeout) || flags.emulate)
+									if (timeout_expired(&timeout) || ctx->flags.emulate)
 										break;
 									usleep(50000);
 								}
 								if ((ret & (FE_HAS_SIGNAL | FE_HAS_CARRIER)) == 0) {
 									switch (test.delsys) {
 									case SYS_DVBT2:
-										if (plp_id_parm == plp_id_max)
+										if (plp_id_parm == ctx->plp_id_max)
 											info("\n");
 											break;
 									default:
-										if (sr_parm == dvbc_symbolrate_max)
+										if (sr_parm == ctx->dvbc_symbolrate_max)
 											info("\n");
 										break;
 									}
@@ -3368,7 +3907,7 @@ static int initial_tune(int frontend_fd, int tuning_data)
 								}
 								verbose("\n        (%.3fsec) signal", elapsed(&meas_start, &meas_stop));
 								//now, we should get also lock.
-								set_timeout(time2lock * flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
+								set_timeout(time2lock * ctx->flags.tuning_timeout, &timeout);	// N msec * {1,2,3}
 
 								while ((ret & FE_HAS_LOCK) == 0) {
 									ret = check_frontend(frontend_fd, 0);
@@ -3382,18 +3921,18 @@ static int initial_tune(int frontend_fd, int tuning_data)
 												ret);
 										lastret = ret;
 									}
-									if (timeout_expired(&timeout) || flags.emulate)
+									if (timeout_expired(&timeout) || ctx->flags.emulate)
 										break;
 									usleep(50000);
 								}
 								if ((ret & FE_HAS_LOCK) == 0) {
 									switch (test.delsys) {
 									case SYS_DVBT2:
-										if (plp_id_parm == plp_id_max)
+										if (plp_id_parm == ctx->plp_id_max)
 											info("\n");
 											break;
 									default:
-										if (sr_parm == dvbc_symbolrate_max)
+										if (sr_parm == ctx->dvbc_symbolrate_max)
 											info("\n");
 										break;
 									}
@@ -3411,7 +3950,9 @@ static int initial_tune(int frontend_fd, int tuning_data)
 								t->type = ptest->type;
 								t->source = 0;
 								t->network_name = NULL;
+								t->found_here = 1;
 								init_tp(t);
+								claim_transponder(t);	// not again from NIT by other frontends.
 
 								copy_fe_params(t, ptest);
 								print_transponder(buffer, t);
@@ -3424,10 +3965,10 @@ static int initial_tune(int frontend_fd, int tuning_data)
 									// speed up scan NITs and later skipping known transponders.
 									if (!initial_table_lookup(frontend_fd)) {
 										info("        deleting (%s)\n", buffer);
-										if (IsMember(new_transponders, t))
-											DeleteItem(new_transponders, t);
-										if (IsMember(scanned_transponders, t))
-											DeleteItem (scanned_transponders, t);
+										if (IsMember(ctx->new_transponders, t))
+											DeleteItem(ctx->new_transponders, t);
+										if (IsMember(ctx->scanned_transponders, t))
+											DeleteItem (ctx->scanned_transponders, t);
 									}
 									break;
 								}
@@ -3435,6 +3976,7 @@ static int initial_tune(int frontend_fd, int tuning_data)
 							}	// END: for plp_id_parm
 						}	// END: for sr_parm
 					}	// END: for offs
+					checkpoint_blind_scan(delsys_parm, mod_parm, channel);
 				}	// END: for channel
 			}	// END: for mod_parm
 		}		// END: for delsys_parm
@@ -3447,13 +3989,16 @@ static int initial_tune(int frontend_fd, int tuning_data)
 		 * network information table. In parallel scan for
 		 * other transponders provided by NIT actual and NIT other.
 		 */
-		for (t = new_transponders->first; t; t = t->next) {
+		for (t = ctx->new_transponders->first; t && !ctx->interrupted;
+		     t = t->next) {
+			if (!is_my_part(t->index))
+				continue;	// other shard or frontend.
 			print_transponder(buffer, t);
 
-			switch (flags.scantype) {
+			switch (ctx->flags.scantype) {
 			case SCAN_SATELLITE:
 				if (t->delsys == SYS_DVBS2) {
-					if (!(fe_info.caps & FE_CAN_2G_MODULATION) || (flags.api_version < 0x0500)) {
+					if (!(ctx->fe_info.caps & FE_CAN_2G_MODULATION) || (ctx->flags.api_version < 0x0500)) {
 						info("%s: skipped (no driver support)\n", buffer);
 						continue;
 					}
@@ -3461,7 +4006,7 @@ static int initial_tune(int frontend_fd, int tuning_data)
 				break;
 			case SCAN_TERRESTRIAL:;
 				if (t->delsys == SYS_DVBT2) {
-					if (!(fe_info.caps & FE_CAN_2G_MODULATION) || (flags.api_version < 0x0503)) {
+					if (!(ctx->fe_info.caps & FE_CAN_2G_MODULATION) || (ctx->flags.api_version < 0x0503)) {
 						info("%s: skipped (no driver support)\n", buffer);
 						continue;
 					}
@@ -3479,7 +4024,7 @@ static int initial_tune(int frontend_fd, int tuning_data)
 				dprintf(1, "\n%s:%d: Setting frontend failed %s\n", __FUNCTION__, __LINE__, buffer);
 				continue;
 			}
-			if (!flags.emulate)
+			if (!ctx->flags.emulate)
 				usleep(1500000);
 			for (cnt = 0; cnt < 5; cnt++) {
 				if (check_frontend(frontend_fd, 0) == 1)
@@ -3488,6 +4033,8 @@ static int initial_tune(int frontend_fd, int tuning_data)
 			}
 			if (__tune_to_transponder(frontend_fd, t, 0) >= 0) {
 				info("signal ok\n");
+				t->found_here = 1;
+				claim_transponder(t);	// not again from NIT by other frontends.
 				initial_table_lookup(frontend_fd);
 			} else
 				info("\n");
@@ -3504,106 +4051,464 @@ static void scan_tp_atsc(void)
 	struct section_buf s0, s1, s2;
 	int result = 0;
 
-	if (no_ATSC_PSIP > 0) {
-		setup_filter(&s0, demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0, 0);	/* PAT */
+	if (ctx->no_ATSC_PSIP > 0) {
+		setup_filter(&s0, ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0, 0);	/* PAT */
 		add_filter(&s0);
 	} else {
-		if (atsc_is_vsb(ATSC_type)) {
-			setup_filter(&s0, demux_devname, PID_VCT, TABLE_VCT_TERR, -1, 1, 0, 0);	/* terrestrial VCT */
+		if (atsc_is_vsb(ctx->ATSC_type)) {
+			setup_filter(&s0, ctx->demux_devname, PID_VCT, TABLE_VCT_TERR, -1, 1, 0, 0);	/* terrestrial VCT */
 			add_filter(&s0);
 		}
-		if (atsc_is_qam(ATSC_type)) {
-			setup_filter(&s1, demux_devname, PID_VCT, TABLE_VCT_CABLE, -1, 1, 0, 0);	/* cable VCT */
+		if (atsc_is_qam(ctx->ATSC_type)) {
+			setup_filter(&s1, ctx->demux_devname, PID_VCT, TABLE_VCT_CABLE, -1, 1, 0, 0);	/* cable VCT */
 			add_filter(&s1);
 		}
-		setup_filter(&s2, demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0, 0);	/* PAT */
+		setup_filter(&s2, ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0, 0);	/* PAT */
 		add_filter(&s2);
 	}
 	EMUL(em_readfilters, &result)
 	    do {
 		read_filters();
 	}
-	while ((running_filters->count > 0)
-	       || (waiting_filters->count > 0));
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0));
 }
 
-static void scan_tp_dvb(void)
+/* parse the sections of a cached transponder, as if read from the demux.
+ * PAT without SECTION_FLAG_INITIAL would start PMT filters.
+ */
+static void replay_sections(struct si_cache_entry *e)
 {
-	struct section_buf s[4];
+	uint32_t i;
+
+	for (i = 0; i < e->count; i++) {
+		const unsigned char *buf = e->sections[i];
+		uint16_t section_length = (((buf[1] & 0x0f) << 8) | buf[2]) - 9;
+		uint16_t table_id_ext = (buf[3] << 8) | buf[4];
+		struct service *s = NULL;
+
+		if (buf[0] == TABLE_PMT)
+			s = find_service(ctx->current_tp, table_id_ext);
+		parse_table(buf + 8, section_length, buf[0], table_id_ext,
+			    s ? s->pmt_pid : 0,
+			    buf[0] == TABLE_PAT ? SECTION_FLAG_INITIAL : 0);
+	}
+}
+
+/* incremental rescan: read PAT without PMTs, one section of SDT(actual) and
+ * NIT(actual) and compare their versions with the SI cache. Returns true,
+ * if the cached sections were used instead of scanning the tp.
+ */
+static bool scan_tp_cached(void)
+{
+	struct section_buf s[3];
+	struct si_cache_entry *e;
 	int result = 0;
 
-	// first run: read PAT, but dont read PMT (~0.5sec)
-	//   - to ensure that current_tp->transport_stream_id is set.
-	//   - to update network_PID (default: 0x10).
-	current_tp->network_PID = PID_NIT_ST;
-	setup_filter(&s[0], demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0,
-		     SECTION_FLAG_INITIAL);
+	setup_filter(&s[0], ctx->demux_devname, ctx->current_tp->network_PID,
+		     TABLE_NIT_ACT, -1, 1, 0, SECTION_FLAG_PROBE);
 	add_filter(&s[0]);
+	setup_filter(&s[1], ctx->demux_devname, PID_SDT_BAT_ST,
+		     TABLE_SDT_ACT, -1, 1, 0, SECTION_FLAG_PROBE);
+	add_filter(&s[1]);
+	setup_filter(&s[2], ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0,
+		     SECTION_FLAG_INITIAL);
+	add_filter(&s[2]);
 	EMUL(em_readfilters, &result)
 	    do {
 		read_filters();
 	}
-	while ((running_filters->count > 0)
-	       || (waiting_filters->count > 0));
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0));
+
+	if (!si_cache_known(ctx->si_cache))
+		return false;
+	if ((e = si_cache_match(ctx->si_cache)) == NULL) {
+		verbose("        SI changed, rescanning.\n");
+		return false;
+	}
+	verbose("        SI unchanged (PAT %d, SDT %d, NIT %d), using cache.\n",
+		e->pat_version, e->sdt_version, e->nit_version);
+	replay_sections(e);
+	return true;
+}
+
+static void scan_tp_dvb(void)
+{
+	struct section_buf s[4];
+	int result = 0;
 
-	// second run: now all filters; start slowest filters first.
-	setup_filter(&s[0], demux_devname, current_tp->network_PID,
+	if (ctx->si_cache)
+		si_cache_begin(ctx->si_cache, ctx->current_tp->frequency,
+			       ctx->current_tp->type ==
+			       SCAN_SATELLITE ? 2000 : 750000);
+
+	ctx->current_tp->network_PID = PID_NIT_ST;
+	if (ctx->si_cache && scan_tp_cached())
+		return;
+
+	// one run, all filters; start slowest filters first. NIT starts on
+	// PID 0x10 and follows network_PID from PAT, see follow_network_PID();
+	// PAT starts the PMT filters as soon as it is parsed.
+	setup_filter(&s[0], ctx->demux_devname, ctx->current_tp->network_PID,
 		     TABLE_NIT_ACT, -1, 1, 0, 0);
 	add_filter(&s[0]);
-	if (flags.get_other_nits > 0) {
+	if (ctx->flags.get_other_nits > 0) {
 		/* Note: There is more than one NIT-other: one per network, separated by the network_id. */
-		setup_filter(&s[1], demux_devname,
-			     current_tp->network_PID, TABLE_NIT_OTH, -1,
+		setup_filter(&s[1], ctx->demux_devname,
+			     ctx->current_tp->network_PID, TABLE_NIT_OTH, -1,
 			     1, 1, 0);
 		add_filter(&s[1]);
 	}
-	setup_filter(&s[2], demux_devname, PID_SDT_BAT_ST,
+	setup_filter(&s[2], ctx->demux_devname, PID_SDT_BAT_ST,
 		     TABLE_SDT_ACT, -1, 1, 0, 0);
 	add_filter(&s[2]);
-	setup_filter(&s[3], demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0, 0);
+	setup_filter(&s[3], ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0, 0);
 	add_filter(&s[3]);
 	EMUL(em_readfilters, &result)
 	    do {
 		read_filters();
 	}
-	while ((running_filters->count > 0)
-	       || (waiting_filters->count > 0));
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0));
+
+	if (ctx->si_cache)
+		si_cache_commit(ctx->si_cache);
+}
+
+static void stream_transponder(struct transponder *t);
+static bool want_service(struct service *s);
+
+/* hand a scanned transponder and its services to a library client. */
+static void report_transponder(struct transponder *t)
+{
+	struct scan_callbacks *cb = &ctx->callbacks;
+	struct service *s;
+
+	if (t == NULL)
+		return;
+	if (cb->transponder)
+		cb->transponder(cb->user, t);
+	if (cb->service == NULL)
+		return;
+	for (s = t->services->first; s; s = s->next)
+		if (want_service(s))
+			cb->service(cb->user, t, s);
+}
+
+/* '--verify': read PAT and SDT(actual) only, no NIT and no PMTs. */
+static void scan_tp_verify(void)
+{
+	struct section_buf s[2];
+	int result = 0;
+
+	ctx->current_tp->network_PID = PID_NIT_ST;
+	setup_filter(&s[0], ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 1, 0,
+		     SECTION_FLAG_INITIAL);
+	add_filter(&s[0]);
+	setup_filter(&s[1], ctx->demux_devname, PID_SDT_BAT_ST,
+		     TABLE_SDT_ACT, -1, 1, 0, 0);
+	add_filter(&s[1]);
+	EMUL(em_readfilters, &result)
+	    do {
+		read_filters();
+	}
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0));
+
+	verify_transponder(ctx->verify, ctx->current_tp);
 }
 
 static void scan_tp(void)
 {
-	switch (flags.scantype) {
+	switch (ctx->flags.scantype) {
 	case SCAN_SATELLITE:
 	case SCAN_CABLE:
 	case SCAN_TERRESTRIAL:
-		scan_tp_dvb();
+		if (ctx->verify)
+			scan_tp_verify();
+		else
+			scan_tp_dvb();
 		break;
 	case SCAN_TERRCABLE_ATSC:
 		scan_tp_atsc();
 		break;
 	default:
-		warning("unimplemented scantype %d.\n", flags.scantype);
+		warning("unimplemented scantype %d.\n", ctx->flags.scantype);
+	}
+	if (ctx->flags.stream_output)
+		stream_transponder(ctx->current_tp);
+	report_transponder(ctx->current_tp);
+}
+
+/* move the results of the current satellite to satellite_transponders. */
+static void collect_satellite_transponders(void)
+{
+	struct transponder *t;
+
+	while ((t = ctx->scanned_transponders->first) != NULL) {
+		t->list_id = ctx->this_channellist;
+		UnlinkItem(ctx->scanned_transponders, t, false);
+		AddItem(ctx->satellite_transponders, t);
+	}
+}
+
+/* all satellites done (or interrupted): hand over results to dump_lists. */
+static void merge_satellite_transponders(void)
+{
+	struct transponder *t;
+
+	if (ctx->satellites_count == 0)
+		return;
+	collect_satellite_transponders();
+	while ((t = ctx->satellite_transponders->first) != NULL) {
+		UnlinkItem(ctx->satellite_transponders, t, false);
+		AddItem(ctx->scanned_transponders, t);
+	}
+}
+
+static void parse_satellite_list(char *list)
+{
+	char *id, *save;
+	int i, j;
+
+	if (strcasecmp(list, "ROTOR") == 0) {
+		for (i = 0; i < sat_count(); i++)
+			if ((sat_rotor_position(i) > 0)
+			    && (ctx->satellites_count < MAX_SATELLITES))
+				ctx->satellites[ctx->satellites_count++] = i;
+	} else {
+		for (id = strtok_r(list, ",", &save); id;
+		     id = strtok_r(NULL, ",", &save)) {
+			if ((i = txt_to_satellite(id)) < 0)
+				fatal("Satellite ID \"%s\" not defined.\n", id);
+			if (sat_rotor_position(i) < 1)
+				fatal("No rotor position for satellite %s.\n", id);
+			for (j = 0; j < ctx->satellites_count; j++)
+				if (ctx->satellites[j] == i)
+					break;
+			if ((j == ctx->satellites_count)
+			    && (ctx->satellites_count < MAX_SATELLITES))
+				ctx->satellites[ctx->satellites_count++] = i;
+		}
+	}
+	if (ctx->satellites_count == 0)
+		fatal("No satellites with rotor position to scan.\n");
+
+	rotor_order_satellites(ctx->satellites, ctx->satellites_count, ctx->this_rotor_pos);
+	ctx->this_channellist = ctx->satellites[0];
+	ctx->flags.list_id = ctx->this_channellist;
+	info("scanning %d satellites:", ctx->satellites_count);
+	for (i = 0; i < ctx->satellites_count; i++)
+		info(" %s", sat_list[ctx->satellites[i]].short_name);
+	info("\n");
+}
+
+/* one rotor sweep over all satellites, each one scanned as usual. */
+static void multi_satellite_scan(int frontend_fd)
+{
+	int i;
+
+	for (i = 0; (i < ctx->satellites_count) && !ctx->interrupted; i++) {
+		ctx->this_channellist = ctx->satellites[i];
+		ctx->flags.list_id = ctx->this_channellist;
+		ctx->current_tp = NULL;
+		info("(time: %s) satellite %s (%d/%d), rotor position %d\n",
+		     run_time(), sat_list[ctx->this_channellist].short_name, i + 1,
+		     ctx->satellites_count, sat_rotor_position(ctx->this_channellist));
+
+		if (initial_tune(frontend_fd, 0) < 0) {
+			info("no working transponder on %s, skipping.\n",
+			     sat_list[ctx->this_channellist].short_name);
+		} else {
+			do {
+				scan_tp();
+			} while (tune_to_next_transponder(frontend_fd) == 0);
+		}
+		collect_satellite_transponders();
+	}
+	merge_satellite_transponders();
+}
+
+/* --monitor: stay on the current transponder. PAT, SDT and NIT filters
+ * stay open, PMTs are read in turn as there are not enough filters for
+ * all of them. Changes are reported by monitor.c.
+ */
+#define MONITOR_PMT_INTERVAL 5	// sec
+
+static void monitor_transponder(int frontend_fd)
+{
+	struct section_buf pat, sdt, nit, *p;
+	struct service *s;
+	bool locked = true;
+	time_t last_check = 0;
+
+	// PMT filters of the scan are freed by now.
+	for (s = ctx->current_tp->services->first; s; s = s->next)
+		s->priv = NULL;
+	monitor_start(ctx->current_tp);
+
+	setup_filter(&pat, ctx->demux_devname, PID_PAT, TABLE_PAT, -1, 0, 0,
+		     SECTION_FLAG_INITIAL | SECTION_FLAG_MONITOR);
+	add_filter(&pat);
+	setup_filter(&sdt, ctx->demux_devname, PID_SDT_BAT_ST, TABLE_SDT_ACT,
+		     -1, 0, 0, SECTION_FLAG_MONITOR);
+	add_filter(&sdt);
+	setup_filter(&nit, ctx->demux_devname, ctx->current_tp->network_PID,
+		     TABLE_NIT_ACT, -1, 0, 0, SECTION_FLAG_MONITOR);
+	add_filter(&nit);
+
+	while (!ctx->interrupted) {
+		read_filters();
+		for (s = ctx->current_tp->services->first; s; s = s->next) {
+			if (s->pmt_pid == 0)
+				continue;	// not (longer) in PAT.
+			if ((p = s->priv) == NULL) {
+				p = s->priv = calloc(1, sizeof(*p));
+				setup_filter(p, ctx->demux_devname, s->pmt_pid,
+					     TABLE_PMT, -1, 1, 0,
+					     SECTION_FLAG_MONITOR);
+			} else if ((p->fd != -1)
+				   || IsMember(ctx->waiting_filters, p)
+				   || (time(NULL) <
+				       p->start_time + MONITOR_PMT_INTERVAL))
+				continue;
+			p->pid = s->pmt_pid;
+			add_filter(p);
+		}
+		if (time(NULL) != last_check) {
+			bool l = (check_frontend(frontend_fd, 0) & FE_HAS_LOCK) != 0;
+			if (l != locked)
+				monitor_lock(ctx->current_tp, l);
+			locked = l;
+			last_check = time(NULL);
+		}
+	}
+	// interrupted: read_filters() stops them, waiting ones included.
+	while ((ctx->running_filters->count > 0)
+	       || (ctx->waiting_filters->count > 0))
+		read_filters();
+	for (s = ctx->current_tp->services->first; s; s = s->next) {
+		free(s->priv);
+		s->priv = NULL;
 	}
 }
 
 static void network_scan(int frontend_fd, int tuning_data)
 {
 	if (initial_tune(frontend_fd, tuning_data) < 0) {
+		if ((ctx->scr_frontends_count > 0) || ctx->interrupted)
+			return;	// parallel scan: other frontends may have more luck.
 		error
 		    ("Sorry - i couldn't get any working frequency/transponder\n Nothing to scan!!\n");
 		exit(1);
 	}
 
+	ctx->cp.phase = CHECKPOINT_NETWORK_SCAN;
 	do {
 		scan_tp();
+		if (ctx->interrupted)
+			break;	// incomplete, stays in the checkpoint.
+		ctx->scanning = NULL;
+		save_checkpoint(false);
+		if (monitor_enabled() && !ctx->flags.emulate)
+			monitor_transponder(frontend_fd);
 	} while (tune_to_next_transponder(frontend_fd) == 0);
 }
 
-int device_is_preferred(int caps, const char *frontend_name, uint16_t scantype)
+static void dump_lists(int adapter, int frontend);
+
+/* child process of a parallel scan: scan with frontend 'ctx->scr_worker'. */
+static void scr_worker_scan(int tuning_data)
 {
-	int preferred = 1;	// no preferrence
-	/* add other good/bad cards here. */
-	if (strncmp("VLSI VES1820", frontend_name, 12) == 0)
+	struct scr_frontend *fe = &ctx->scr_frontends[ctx->scr_worker - 1];
+	char devname[80];
+	int frontend_fd;
+
+	ctx->scr_config.slot = fe->slot;
+	ctx->scr_config.user_frequency = fe->user_frequency;
+	sec_state_invalidate();
+
+	snprintf(devname, sizeof(devname), "/dev/dvb/adapter%i/frontend%i",
+		 fe->adapter, fe->frontend);
+	snprintf(ctx->demux_devname, sizeof(ctx->demux_devname),
+		 "/dev/dvb/adapter%i/demux%i", fe->adapter, fe->frontend);
+	if ((frontend_fd = open(devname, O_RDWR)) < 0)
+		fatal("failed to open '%s': %d %s\n", devname, errno,
+		      strerror(errno));
+	info("%s: SCR slot=%u, userfreq=%uMHz\n", devname, fe->slot,
+	     fe->user_frequency);
+
+	// results go to our own temporary file, parent appends them.
+	dup2(fileno(fe->output), STDOUT_FILENO);
+	ctx->output_sinks[0].epilog_pos = -1;
+	network_scan(frontend_fd, tuning_data);
+	close(frontend_fd);
+	dump_lists(fe->adapter, fe->frontend);
+	fflush(stdout);
+	log_flush();
+	_exit(0);
+}
+
+/* wait for the other frontends, then append their results to ours. */
+static void scr_collect_results(void)
+{
+	char buf[4096];
+	size_t len;
+	int i;
+
+	fflush(stdout);
+	for (i = 0; i < ctx->scr_frontends_count; i++) {
+		if (ctx->scr_frontends[i].pid <= 0)
+			continue;
+		waitpid(ctx->scr_frontends[i].pid, NULL, 0);
+		ctx->scr_frontends[i].pid = 0;
+		rewind(ctx->scr_frontends[i].output);
+		while ((len = fread(buf, 1, sizeof(buf),
+				    ctx->scr_frontends[i].output)) > 0)
+			fwrite(buf, 1, len, stdout);
+		fclose(ctx->scr_frontends[i].output);
+	}
+	fflush(stdout);
+}
+
+/* scan with several frontends on one SCR cable, one process each. */
+static void scr_parallel_scan(int frontend_fd, int tuning_data)
+{
+	int i;
+
+	ctx->scr_claims = mmap(NULL, sizeof(*ctx->scr_claims), PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (ctx->scr_claims == MAP_FAILED)
+		fatal("could not map shared memory: %s\n", strerror(errno));
+	ctx->scr_claims->lock = 0;
+	ctx->scr_claims->count = 0;
+
+	for (i = 0; i < ctx->scr_frontends_count; i++) {
+		if ((ctx->scr_frontends[i].output = tmpfile()) == NULL)
+			fatal("could not create temporary file: %s\n",
+			      strerror(errno));
+		fflush(stdout);
+		fflush(stderr);
+		switch (ctx->scr_frontends[i].pid = fork()) {
+		case -1:
+			fatal("fork failed: %s\n", strerror(errno));
+		case 0:
+			close(frontend_fd);
+			ctx->scr_worker = i + 1;
+			stats_close();	// parent process writes stats.
+			scr_worker_scan(tuning_data);
+		default:;
+		}
+	}
+	network_scan(frontend_fd, tuning_data);
+}
+
+int device_is_preferred(int caps, const char *frontend_name, uint16_t scantype)
+{
+	int preferred = 1;	// no preferrence
+	/* add other good/bad cards here. */
+	if (strncmp("VLSI VES1820", frontend_name, 12) == 0)
 		/* bad working FF dvb-c card, known to have qam256 probs. */
 		preferred = 0;	// not preferred
 	else if ((strncmp("Sony CXD2820R", frontend_name, 13) == 0)
@@ -3668,33 +4573,231 @@ void bubbleSort(pList list, cmp_func compare)
 	}
 }
 
+static bool want_service(struct service *s)
+{
+	if (s->video_pid && !(ctx->serv_select & 1))	// vpid, this is tv
+		return false;	/* no TV services */
+	if (!s->video_pid && (s->audio_num || s->ac3_num) && !(ctx->serv_select & 2))	// no vpid, but apid or ac3pid, this is radio
+		return false;	/* no radio services */
+	if (!s->video_pid && !(s->audio_num || s->ac3_num) && !(ctx->serv_select & 4))	// no vpid, no apid, no ac3pid, this is service/other
+		return false;	/* no data/other services */
+	if (s->scrambled && (ctx->flags.ca_select == 0))	// caid, this is scrambled tv or radio
+		return false;	/* FTA only */
+	return true;
+}
+
+static void dump_prolog(struct output_sink *o, int adapter, int frontend)
+{
+	struct output_buffer *dest = &o->out;
+
+	switch (o->format) {
+	case OUTPUT_VLC_M3U:
+		vlc_xspf_prolog(dest, adapter, frontend, &ctx->flags, &ctx->this_lnb);
+		o->index = 0;	// track number
+		break;
+	case OUTPUT_XML:
+		xml_dump_prolog(dest);
+		if (!ctx->flags.stream_output)	// streaming: transponders are written last.
+			xml_dump_transponders(dest, ctx->scanned_transponders);
+		// xml_dump(dest, scanned_transponders);
+		xml_dump_services_open(dest);
+		break;
+	default:;
+	}
+}
+
+static void dump_epilog(struct output_sink *o)
+{
+	struct output_buffer *dest = &o->out;
+
+	switch (o->format) {
+	case OUTPUT_VLC_M3U:
+		vlc_xspf_epilog(dest);
+		break;
+	case OUTPUT_XML:
+		xml_dump_services_close(dest);
+		xml_dump_epilog(dest);
+		break;
+	case OUTPUT_CHDB:	// all at once, needs the sorted indexes.
+		chdb_dump(dest, ctx->scanned_transponders, want_service);
+		break;
+	case OUTPUT_SHARD_RESULT:	// all transponders and services, for '--merge'.
+		ob_flush(dest);
+		if (checkpoint_write_result(o->fd, ctx->scanned_transponders) < 0)
+			error("could not write %s: %s\n", o->name, strerror(errno));
+		break;
+	default:;
+	}
+}
+
+static void dump_transponder(struct output_sink *o, struct transponder *t)
+{
+	struct service *s;
+	char sn[20];
+	struct output_buffer *dest = &o->out;
+	bool recode = o->codepage != ctx->flags.codepage;
+	char *service_name, *provider_name;
+
+	ctx->flags.print_pmt = o->print_pmt;
+
+	if (ctx->satellites_count > 0) {
+		ctx->flags.list_id = t->list_id;
+		ctx->flags.rotor_position = sat_rotor_position(t->list_id);
+	}
+	if (o->format == OUTPUT_DVBSCAN_TUNING_DATA) {
+		if ((t->source >> 8) == 64)
+			dvbscan_dump_tuningdata(dest, t, o->index++, &ctx->flags);
+		return;
+	}
+	for (s = (t->services)->first; s; s = s->next) {
+		if (!s->service_name) {	// no service name in SDT
+			snprintf(sn, sizeof(sn), "service_id %d", s->service_id);
+			s->service_name = strdup(sn);
+		}
+		if (!want_service(s))
+			continue;
+		service_name = s->service_name;
+		provider_name = s->provider_name;
+		if (recode) {	// names are utf-8 here.
+			s->service_name = utf8_to_charset(service_name, o->codepage);
+			s->provider_name = utf8_to_charset(provider_name, o->codepage);
+		}
+		switch (o->format) {
+		case OUTPUT_VDR:
+			vdr_dump_service_parameter_set(dest, s, t, &ctx->flags);
+			break;
+		case OUTPUT_XINE:
+			xine_dump_service_parameter_set(dest, s, t, &ctx->flags);
+			break;
+		case OUTPUT_MPLAYER:
+			mplayer_dump_service_parameter_set(dest, s, t, &ctx->flags);
+			break;
+		case OUTPUT_VLC_M3U:
+			vlc_dump_service_parameter_set_as_xspf(dest, ++o->index, s, t,
+							       &ctx->flags,
+							       &ctx->this_lnb);
+			break;
+		case OUTPUT_XML:
+			xml_dump_service_parameter_set(dest, s, t, &ctx->flags);
+			break;
+		default:
+			break;
+		}
+		if (recode) {
+			free(s->service_name);
+			free(s->provider_name);
+			s->service_name = service_name;
+			s->provider_name = provider_name;
+		}
+	}
+}
+
+/******************************************************************************
+ * streaming output: services of each transponder are written as soon as it
+ * is scanned. If the output is a file, the epilog is rewritten after each
+ * transponder, so that the file is complete at any time.
+ *****************************************************************************/
+
+static void stream_open(int adapter, int frontend)
+{
+	struct output_sink *o;
+
+	for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++) {
+		dump_prolog(o, adapter, frontend);
+		ob_flush(&o->out);
+		o->epilog_pos = lseek(o->fd, 0, SEEK_CUR);
+		// O_APPEND ('>> file'): every write goes to the end, no rewrite.
+		if (fcntl(o->fd, F_GETFL) & O_APPEND)
+			o->epilog_pos = -1;
+		if (o->epilog_pos >= 0)
+			dump_epilog(o);
+		ob_flush(&o->out);
+	}
+}
+
+static void stream_transponder(struct transponder *t)
+{
+	struct output_sink *o;
+
+	if (t == NULL || t->streamed)
+		return;
+	t->streamed = 1;
+	for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++) {
+		if (o->epilog_pos >= 0)
+			lseek(o->fd, o->epilog_pos, SEEK_SET);
+		dump_transponder(o, t);
+		ob_flush(&o->out);
+		if (o->epilog_pos >= 0) {
+			o->epilog_pos = lseek(o->fd, 0, SEEK_CUR);
+			dump_epilog(o);
+			ob_flush(&o->out);
+		}
+	}
+}
+
+static void stream_close(void)
+{
+	struct output_sink *o;
+	struct transponder *t;
+
+	// anything not yet written, i.e. not scanned or from other satellites.
+	for (t = ctx->scanned_transponders->first; t; t = t->next)
+		stream_transponder(t);
+	for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++) {
+		if (o->epilog_pos >= 0)
+			lseek(o->fd, o->epilog_pos, SEEK_SET);
+		if (o->format == OUTPUT_XML) {
+			xml_dump_services_close(&o->out);
+			xml_dump_transponders(&o->out, ctx->scanned_transponders);
+			xml_dump_epilog(&o->out);
+		} else
+			dump_epilog(o);
+		ob_flush(&o->out);
+		if ((o->epilog_pos >= 0)
+		    && (ftruncate(o->fd, lseek(o->fd, 0, SEEK_CUR)) < 0))
+			warning("could not truncate output: %s\n",
+				strerror(errno));
+	}
+}
+
+static void close_output_sinks(void)
+{
+	struct output_sink *o;
+
+	for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++) {
+		ob_flush(&o->out);
+		if (o->fd > STDERR_FILENO)
+			close(o->fd);
+		o->fd = -1;
+	}
+	ctx->output_sinks_count = 0;
+}
+
 static void dump_lists(int adapter, int frontend)
 {
 	struct transponder *t;
 	struct service *s;
-	int n = 0, i, index = 0;
-	char sn[20];
-	FILE *dest = flags.emulate ? stderr : stdout;	// no fprintf output to stdout /w emul. why? :(
+	struct output_sink *o;
+	int n = 0;
+
+	if (ctx->flags.stream_output) {
+		stream_close();
+		close_output_sinks();
+		stats_write();
+		info("Done, scan time: %s\n", run_time());
+		return;
+	}
 
 	if (verbosity > 4)
-		bubbleSort(scanned_transponders, cmp_freq_pol);
+		bubbleSort(ctx->scanned_transponders, cmp_freq_pol);
 
-	for (t = scanned_transponders->first; t; t = t->next) {
+	for (t = ctx->scanned_transponders->first; t; t = t->next) {
 		for (s = (t->services)->first; s; s = s->next) {
-			if (s->video_pid && !(serv_select & 1))
-				continue;	/* no TV services */
-			if (!s->video_pid && (s->audio_num || s->ac3_num)
-			    && !(serv_select & 2))
-				continue;	/* no radio services */
-			if (!s->video_pid && !(s->audio_num || s->ac3_num)
-			    && !(serv_select & 4))
-				continue;	/* no data/other services */
-			if (s->scrambled && (flags.ca_select == 0))
-				continue;	/* FTA only */
-			n++;
+			if (want_service(s))
+				n++;
 		}
 		if ((verbosity > 4)
-		    && (flags.scantype == SCAN_SATELLITE)) {
+		    && (ctx->flags.scantype == SCAN_SATELLITE)) {
 			verbose
 			    ("{%d, %05u, %d, %05u, %-2d, %d, %-2d},              // (%-5d, %-5d,%-5d)\n",
 			     t->delsys, freq_scale(t->frequency, 1e-3),
@@ -3709,95 +4812,145 @@ static void dump_lists(int adapter, int frontend)
 
 	info("(time: %s) dumping lists (%d services)\n..\n", run_time(), n);
 
-	switch (output_format) {
-	case OUTPUT_VLC_M3U:
-		vlc_xspf_prolog(dest, adapter, frontend, &flags, &this_lnb);
-		break;
-	case OUTPUT_XML:
-      xml_dump_prolog(dest);
-      xml_dump_transponders(dest, scanned_transponders);
-		// xml_dump(dest, scanned_transponders);
-      xml_dump_services_open(dest);
-		break;
-	default:;
+	for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++)
+		dump_prolog(o, adapter, frontend);
+	for (t = ctx->scanned_transponders->first; t; t = t->next)
+		for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++)
+			dump_transponder(o, t);
+	for (o = ctx->output_sinks; o < ctx->output_sinks + ctx->output_sinks_count; o++)
+		dump_epilog(o);
+	close_output_sinks();
+	stats_write();
+	fflush(stderr);
+	fflush(stdout);
+	info("Done, scan time: %s\n", run_time());
+}
+
+/* '--diff': changes against a previous scan as JSON on stdout, changed
+ * services optionally in VDR format. Returns the number of changes.
+ */
+static uint32_t diff_scan(const char *vdrfile)
+{
+	struct output_buffer ob;
+	uint32_t changes;
+	int fd = -1;
+
+	if (vdrfile
+	    && ((fd = open(vdrfile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+			   0666)) < 0))
+		error("could not open %s: %s\n", vdrfile, strerror(errno));
+	if (fd >= 0)
+		ob_init(&ob, fd);
+	changes = diff_results(ctx->diff_before, ctx->scanned_transponders,
+			       want_service, stdout, fd >= 0 ? &ob : NULL,
+			       &ctx->flags);
+	if (fd >= 0) {
+		ob_flush(&ob);
+		close(fd);
 	}
+	diff_free(ctx->diff_before);
+	ctx->diff_before = NULL;
+	return changes;
+}
 
-	for (t = scanned_transponders->first; t; t = t->next) {
-		if (output_format == OUTPUT_DVBSCAN_TUNING_DATA
-		    && ((t->source >> 8) == 64)) {
-			dvbscan_dump_tuningdata(dest, t, index++, &flags);
+static bool same_merged_transponder(struct transponder *a,
+				    struct transponder *b)
+{
+	if ((a->type != b->type)
+	    || !is_nearly_same_frequency(a->frequency, b->frequency, a->type))
+		return false;
+	if ((a->type == SCAN_SATELLITE) && (a->polarization != b->polarization))
+		return false;
+	// ids not known: placeholder of a transponder owned by another shard.
+	if (!(a->original_network_id | a->network_id | a->transport_stream_id)
+	    || !(b->original_network_id | b->network_id | b->transport_stream_id))
+		return true;
+	return (a->original_network_id == b->original_network_id)
+	    && (a->network_id == b->network_id)
+	    && (a->transport_stream_id == b->transport_stream_id);
+}
+
+/* '--merge': add the result of one shard to scanned_transponders. */
+static void merge_result(const char *file)
+{
+	struct checkpoint_state st;
+	struct transponder *t, *e;
+	struct service *s;
+	cList list, queued;
+
+	NewList(&list, "merge");
+	NewList(&queued, "merge queued");
+	if (checkpoint_read(file, &st, &list, &queued) < 0)
+		fatal("could not read %s: %s\n", file, errno == EINVAL ?
+		      "not a shard result of this w_scan2 binary" : strerror(errno));
+	if ((st.phase != CHECKPOINT_RESULT) || queued.count)
+		fatal("%s is a checkpoint, not a shard result (--output shard:<file>)\n",
+		      file);
+	info("merging %s: %u transponders\n", file, list.count);
+
+	while ((t = list.first) != NULL) {
+		UnlinkItem(&list, t, false);
+		for (e = ctx->scanned_transponders->first; e; e = e->next)
+			if (same_merged_transponder(e, t))
+				break;
+		if (e == NULL) {
+			AddItem(ctx->scanned_transponders, t);
 			continue;
 		}
-		for (s = (t->services)->first; s; s = s->next) {
-			if (!s->service_name) {	// no service name in SDT
-				snprintf(sn, sizeof(sn),
-					 "service_id %d", s->service_id);
-				s->service_name = strdup(sn);
-			}
-			/* ':' is field separator in vdr service lists */
-			for (i = 0; s->service_name[i]; i++) {
-				if (s->service_name[i] == ':')
-					s->service_name[i] = ' ';
-			}
-			for (i = 0;
-			     s->provider_name && s->provider_name[i]; i++) {
-				if (s->provider_name[i] == ':')
-					s->provider_name[i] = ' ';
-			}
-			if (s->video_pid && !(serv_select & 1))	// vpid, this is tv
-				continue;	/* no TV services */
-			if (!s->video_pid && (s->audio_num || s->ac3_num) && !(serv_select & 2))	// no vpid, but apid or ac3pid, this is radio
-				continue;	/* no radio services */
-			if (!s->video_pid && !(s->audio_num || s->ac3_num) && !(serv_select & 4))	// no vpid, no apid, no ac3pid, this is service/other
-				continue;	/* no data/other services */
-			if (s->scrambled && (flags.ca_select == 0))	// caid, this is scrambled tv or radio
-				continue;	/* FTA only */
-			switch (output_format) {
-			case OUTPUT_VDR:
-				vdr_dump_service_parameter_set(dest, s,
-							       t, &flags);
-				break;
-			case OUTPUT_XINE:
-				xine_dump_service_parameter_set(dest, s,
-								t, &flags);
-				break;
-			case OUTPUT_MPLAYER:
-				mplayer_dump_service_parameter_set(dest,
-								   s, t,
-								   &flags);
-				break;
-			case OUTPUT_VLC_M3U:
-				vlc_dump_service_parameter_set_as_xspf
-				    (dest, s, t, &flags, &this_lnb);
-				break;
-         case OUTPUT_XML:
-            xml_dump_service_parameter_set(dest, s, t, &flags);
-            break;
-			default:
-				break;
+		if (!t->other_shard)	// scanned by this shard.
+			e->other_shard = 0;
+		if (!(e->original_network_id | e->transport_stream_id)) {
+			e->original_network_id = t->original_network_id;
+			e->network_id = t->network_id;
+			e->transport_stream_id = t->transport_stream_id;
+		}
+		while ((s = t->services->first) != NULL) {
+			UnlinkItem(t->services, s, false);
+			if (find_service(e, s->service_id) != NULL) {
+				free(s->provider_name);
+				free(s->provider_short_name);
+				free(s->service_name);
+				free(s->service_short_name);
+				free(s);
+				continue;
 			}
+			s->transponder = e;
+			AddItem(e->services, s);
 		}
+		if (e->network_name == NULL) {
+			e->network_name = t->network_name;
+			t->network_name = NULL;
+		}
+		free(t->network_name);
+		ClearList(t->cells);
+		free(t);
 	}
-	switch (output_format) {
-	case OUTPUT_VLC_M3U:
-		vlc_xspf_epilog(dest);
-		break;
-   case OUTPUT_XML:
-      xml_dump_services_close(dest);
-      xml_dump_epilog(dest);
-      break;
-	default:;
+	ctx->merged++;
+}
+
+/* '--merge': transponders left to a shard which never saw the NIT announcing
+ * them were not scanned by anyone.
+ */
+static void merge_check(void)
+{
+	struct transponder *t;
+	uint32_t missed = 0;
+
+	for (t = ctx->scanned_transponders->first; t; t = t->next) {
+		if (!t->other_shard)
+			continue;
+		warning("%u: not scanned, left to shard %u which never found it\n",
+			freq_scale(t->frequency, 1e-3), t->other_shard);
+		missed++;
 	}
-	fflush(stderr);
-	fflush(stdout);
-	info("Done, scan time: %s\n", run_time());
+	if (missed)
+		warning("%u transponders missing in the merged result, "
+			"scan without --shard to get them\n", missed);
 }
 
-static void handle_sigint(int sig)
+void scan_interrupt(struct scan_context *c)
 {
-	error("interrupted by SIGINT, dumping partial result...\n");
-	dump_lists(-1, -1);
-	exit(2);
+	c->interrupted = 1;
 }
 
 bool fe_supports_scan(int fd, scantype_t type, struct dvb_frontend_info info)
@@ -3806,7 +4959,7 @@ bool fe_supports_scan(int fd, scantype_t type, struct dvb_frontend_info info)
 	struct dtv_properties cmdseq = {.num = 1,.props = p };
 	bool result = false;
 
-	if (flags.api_version >= 0x0505) {
+	if (ctx->flags.api_version >= 0x0505) {
 		EMUL(em_getproperty, &cmdseq)
 		    if (ioctl(fd, FE_GET_PROPERTY, &cmdseq) < 0)
 			return 0;
@@ -3901,6 +5054,9 @@ static const char *usage = "\n"
     "               choose your satellite here:\n"
     "                       S19E2, S13E0, S15W0, ..\n"
     "                       ? for list\n"
+    "               with rotor (needs -p), scan several satellites:\n"
+    "                       S19E2,S13E0,S28E2 or ROTOR for all\n"
+    "                       satellites in rotor position file\n"
     "               ---output switches---\n"
     "       -G, --output-dvbsrc\n"
     "               generate channels.conf for dvbsrc plugin\n"
@@ -3924,6 +5080,13 @@ static const char *ext_opts = "%s expert help\n"
     "               use 'iconv --list' for full list of charsets.\n"
     "       -I <file>, --initial <file>\n"
     "               scan using dvbscan initial_tuning_data\n"
+    "       --warm-start <file>\n"
+    "               scan the transponders of a previous scan, written by\n"
+    "               '--output db:<file>', with their tuning parameters and\n"
+    "               without initial tuning\n"
+    "       --fill-gaps\n"
+    "               with --warm-start: also scan the channel list for\n"
+    "               transponders not in <file>\n"
     "       -v, --verbose\n"
     "               be more verbose (repeat for more)\n"
     "       -q, --quiet\n"
@@ -3945,6 +5108,66 @@ static const char *ext_opts = "%s expert help\n"
     "               specify VDR version / channels.conf format\n"
     "               2  = VDR-2.0.x (default)\n"
     "               21 = VDR-2.1.x\n"
+    "       --output <format>:<file>\n"
+    "               write <format> to <file> ('-' for stdout), may be repeated\n"
+    "               to get several formats from one scan. Formats:\n"
+    "               vdr, gstreamer, xine, mplayer, initial, vlc, xml, db,\n"
+    "               shard\n"
+    "       --stream\n"
+    "               write the services of each transponder as soon as it is\n"
+    "               scanned, instead of all at the end of the scan\n"
+    "       --stats <file>\n"
+    "               write timing of each scan phase per transponder to <file>\n"
+    "               as JSON, or in Prometheus textfile format if <file> ends\n"
+    "               with '.prom'\n"
+    "       --trace <file>\n"
+    "               write a timeline of tuning, lock wait, section filters and\n"
+    "               parsing to <file>, for chrome://tracing or ui.perfetto.dev\n"
+    "       --daemon <socket>\n"
+    "               keep running and read scan jobs, one line of options each,\n"
+    "               from UNIX socket <socket>; results go back to the client.\n"
+    "               The frontend is kept open between jobs\n"
+    "       --si-cache <file>\n"
+    "               keep the SI tables of all transponders in <file>. On\n"
+    "               rescan, transponders with unchanged PAT, SDT and NIT\n"
+    "               versions are taken from <file> without reading PMTs\n"
+    "       --monitor <file>\n"
+    "               stay on the first transponder scanned and write SI\n"
+    "               changes to <file> ('-' for stdout) as JSON lines, until\n"
+    "               interrupted\n"
+    "       --verify <file>\n"
+    "               check a channel database ('--output db:<file>'): tune\n"
+    "               each transponder once, read PAT and SDT only and report\n"
+    "               missing, changed and new services; exit code 3 on\n"
+    "               differences\n"
+    "       --diff <file>\n"
+    "               compare the result with a channel database\n"
+    "               ('--output db:<file>') and write the changes to stdout\n"
+    "               as JSON lines instead of the channel list\n"
+    "       --diff-vdr <file>\n"
+    "               with --diff: write new, moved and changed services to\n"
+    "               <file> in VDR format\n"
+    "       --checkpoint <file>\n"
+    "               save the scan progress to <file> every 10sec and on\n"
+    "               SIGINT; <file> is removed when the scan completes\n"
+    "       --resume <file>\n"
+    "               continue an interrupted scan from checkpoint <file>, with\n"
+    "               the same options as before. Transponders already scanned\n"
+    "               are not tuned again\n"
+    "       --shard <i>/<n>\n"
+    "               scan part i of n (1 <= i <= n) only: initial scan channels\n"
+    "               and transponders found in NIT are split between n hosts\n"
+    "       --merge <file>\n"
+    "               no scan: combine the results of the shards, written with\n"
+    "               '--output shard:<file>', into one channel list. Repeat for\n"
+    "               each shard\n"
+    "       --dead-cache <file>\n"
+    "               remember frequencies without lock in <file>; they are\n"
+    "               not tuned again, also not in later scans. Without this\n"
+    "               option, only during the running scan\n"
+    "       --dead-ttl <hours>\n"
+    "               retry frequencies without lock after <hours>\n"
+    "               [default: 24], 0 disables the dead frequency cache\n"
     "       -d, --delete-duplicate-transponders\n"
     "               with this option, only the first transponder copy is kept,\n"
     "               regardless of the signal strength, so if you are in an area\n"
@@ -4015,6 +5238,9 @@ static const char *ext_opts = "%s expert help\n"
     "               use DiSEqC rotor Position file\n"
     "       -r N, --rotor-position N\n"
     "               use Rotor position N (needs -s)\n"
+    "       --rotor-model <file>\n"
+    "               measure rotor speed (DiSEqC-2.2 positioner) and\n"
+    "               keep it in <file> to shorten waiting for the rotor\n"
     "       -u    <slot:user_frequency:sat_pos(:user_pin)>\n"
     "       --scr <slot:user_frequency:sat_pos(:user_pin)>\n"
     "               Satellite Channel Routing\n"
@@ -4049,11 +5275,39 @@ static const char *ext_opts = "%s expert help\n"
     "                                              'n'    0   |   1      |   1    |   1\n"
     "                                              'o'    1   |   0      |   1    |   1\n"
     "                                              'p'    1   |   1      |   1    |   1\n"
+    "       --scr-frontend <adapter:frontend:slot:user_frequency>\n"
+    "               scan in parallel with another frontend on the same SCR\n"
+    "               cable, using its own slot and user frequency (needs -u).\n"
+    "               May be repeated, max 8. Line based output formats only.\n"
     ".................ATSC....................\n"
     "       -P, --use-pat\n"
     "               do not use ATSC PSIP tables for scanning\n"
     "               (but only PAT and PMT) (applies for ATSC only)\n";
 
+/* long options without short form. */
+enum __long_only_options {
+	OPT_ROTOR_MODEL = 256,
+	OPT_SCR_FRONTEND,
+	OPT_STREAM,
+	OPT_OUTPUT,
+	OPT_STATS,
+	OPT_TRACE,
+	OPT_DAEMON,
+	OPT_SI_CACHE,
+	OPT_WARM_START,
+	OPT_FILL_GAPS,
+	OPT_MONITOR,
+	OPT_VERIFY,
+	OPT_DIFF,
+	OPT_DIFF_VDR,
+	OPT_CHECKPOINT,
+	OPT_RESUME,
+	OPT_SHARD,
+	OPT_MERGE,
+	OPT_DEAD_CACHE,
+	OPT_DEAD_TTL,
+};
+
 /*no_argument, required_argument and optional_argument. */
 static struct option long_options[] = {
 	{"frontend", required_argument, NULL, 'f'},
@@ -4091,22 +5345,296 @@ static struct option long_options[] = {
 	{"diseqc-switch", required_argument, NULL, 'D'},
 	{"position-file", required_argument, NULL, 'p'},
 	{"rotor-position", required_argument, NULL, 'r'},
+	{"rotor-model", required_argument, NULL, OPT_ROTOR_MODEL},
 	{"scr", required_argument, NULL, 'u'},
+	{"scr-frontend", required_argument, NULL, OPT_SCR_FRONTEND},
 	{"use-pat", required_argument, NULL, 'P'},
 	{"delete-duplicate-transponders", no_argument, NULL, 'd'},
+	{"stream", no_argument, NULL, OPT_STREAM},
+	{"output", required_argument, NULL, OPT_OUTPUT},
+	{"stats", required_argument, NULL, OPT_STATS},
+	{"trace", required_argument, NULL, OPT_TRACE},
+	{"daemon", required_argument, NULL, OPT_DAEMON},
+	{"si-cache", required_argument, NULL, OPT_SI_CACHE},
+	{"warm-start", required_argument, NULL, OPT_WARM_START},
+	{"fill-gaps", no_argument, NULL, OPT_FILL_GAPS},
+	{"monitor", required_argument, NULL, OPT_MONITOR},
+	{"verify", required_argument, NULL, OPT_VERIFY},
+	{"diff", required_argument, NULL, OPT_DIFF},
+	{"diff-vdr", required_argument, NULL, OPT_DIFF_VDR},
+	{"checkpoint", required_argument, NULL, OPT_CHECKPOINT},
+	{"resume", required_argument, NULL, OPT_RESUME},
+	{"shard", required_argument, NULL, OPT_SHARD},
+	{"merge", required_argument, NULL, OPT_MERGE},
+	{"dead-cache", required_argument, NULL, OPT_DEAD_CACHE},
+	{"dead-ttl", required_argument, NULL, OPT_DEAD_TTL},
 	{NULL, 0, NULL, 0},
 };
 
-void bad_usage(char *pname)
+#define SHORT_OPTIONS "a:c:de:f:hi:l:o:p:qr:s:t:u:vxA:C:D:E:FGHI:LMO:PQ:R:S:T:VXZ"
+
+/******************************************************************************
+ * options, either from a command line or from struct scan_option.
+ * Same syntax as getopt_long(), but without global state: several scans
+ * may be configured at the same time. Non-option arguments are ignored.
+ *****************************************************************************/
+
+struct option_parser {
+	const char *name;	// program name, for usage
+	int argc;		// command line, or
+	char **argv;
+	const struct scan_option *options;	// name/value pairs
+	unsigned count;
+	int index;		// next argv[] / options[]
+	char *group;		// rest of short option group, i.e. "sX" of "-fsX"
+	char *arg;		// argument of last option
+	char *copy;		// options[]: writable copy of the value
+};
+
+static const struct option *find_long_option(const char *name, size_t len,
+					     bool exact)
+{
+	const struct option *o, *found = NULL;
+	int matches = 0;
+
+	for (o = long_options; o->name; o++) {
+		if (strncmp(o->name, name, len))
+			continue;
+		if (strlen(o->name) == len)
+			return o;
+		found = o;
+		matches++;
+	}
+	if (exact || (matches != 1)) {
+		error("%s option '--%.*s'\n", matches > 1 && !exact ?
+		      "ambiguous" : "unrecognized", (int)len, name);
+		return NULL;
+	}
+	return found;		// unique abbreviation.
+}
+
+/* next option as getopt_long() would return it, -1 at the end, '?' if invalid. */
+static int next_option(struct option_parser *p)
 {
+	const struct option *o;
+	const char *spec;
+	char *s;
+	size_t len;
+	int c;
+
+	p->arg = NULL;
+	free(p->copy);
+	p->copy = NULL;
+
+	if (p->options) {
+		const struct scan_option *so;
+
+		if ((unsigned)p->index >= p->count)
+			return -1;
+		so = &p->options[p->index++];
+		len = strlen(so->name);
+		if (len == 1) {
+			c = so->name[0];
+			if ((c == ':') || (spec = strchr(SHORT_OPTIONS, c)) == NULL) {
+				error("unrecognized option '%s'\n", so->name);
+				return '?';
+			}
+			len = spec[1] == ':';
+		} else {
+			if ((o = find_long_option(so->name, len, true)) == NULL)
+				return '?';
+			c = o->val;
+			len = o->has_arg == required_argument;
+		}
+		if (len) {	// argument required
+			if (so->value == NULL) {
+				error("option '%s' requires an argument\n",
+				      so->name);
+				return '?';
+			}
+			p->arg = p->copy = strdup(so->value);
+		}
+		return c;
+	}
+
+	if ((p->group == NULL) || (*p->group == 0)) {
+		do {
+			if (p->index >= p->argc)
+				return -1;
+			s = p->argv[p->index++];
+			if (!strcmp(s, "--"))
+				return -1;
+		} while ((s[0] != '-') || (s[1] == 0));
+
+		if (s[1] == '-') {
+			s += 2;
+			len = strcspn(s, "=");
+			if ((o = find_long_option(s, len, false)) == NULL)
+				return '?';
+			if (o->has_arg == no_argument) {
+				if (s[len] == '=') {
+					error("option '--%s' doesn't allow an argument\n",
+					      o->name);
+					return '?';
+				}
+			} else if (s[len] == '=')
+				p->arg = s + len + 1;
+			else if (p->index < p->argc)
+				p->arg = p->argv[p->index++];
+			else {
+				error("option '--%s' requires an argument\n",
+				      o->name);
+				return '?';
+			}
+			return o->val;
+		}
+		p->group = s + 1;
+	}
+
+	c = *p->group++;
+	if ((c == ':') || (spec = strchr(SHORT_OPTIONS, c)) == NULL) {
+		error("invalid option -- '%c'\n", c);
+		return '?';
+	}
+	if (spec[1] == ':') {
+		if (*p->group)
+			p->arg = p->group;
+		else if (p->index < p->argc)
+			p->arg = p->argv[p->index++];
+		else {
+			error("option requires an argument -- '%c'\n", c);
+			return '?';
+		}
+		p->group = NULL;
+	}
+	return c;
+}
+
+void bad_usage(const char *pname)
+{
+	log_flush();
 	fprintf(stderr, usage, pname);
 }
 
 void ext_help(void)
 {
+	log_flush();
 	fprintf(stderr, ext_opts, PACKAGE_NAME);
 }
 
+struct scan_context *scan_context_new(void)
+{
+	struct scan_context *c = calloc(1, sizeof(*c));
+
+	if (c == NULL)
+		fatal("out of memory\n");
+
+	c->flags = default_flags;
+	c->delsys_min = 0;
+	c->delsys_max = 0;
+	c->modulation_min = 0;
+	c->modulation_max = 1;
+	c->dvbc_symbolrate_min = 0;
+	c->dvbc_symbolrate_max = 1;
+	c->plp_id_min = 0;
+	c->plp_id_max = 0;
+	c->freq_offset_min = 0;
+	c->freq_offset_max = 4;
+	c->this_channellist = DVBT_DE;
+	c->ATSC_type = ATSC_VSB;
+	c->no_ATSC_PSIP = 0;
+	c->serv_select = 3;
+
+	c->this_rotor_pos = -1;
+	c->dead_cache = dead_cache_new();
+	diseqc_context_init(&c->diseqc);
+	c->this_lnb = *lnb_enum(0);
+	c->this_lnb.low_val *= 1000;
+	c->this_lnb.high_val *= 1000;
+	c->this_lnb.switch_val *= 1000;
+	c->scr_config.pin = 0xFFFF;
+
+	c->bandwidth_auto = true;
+	c->caps_inversion = INVERSION_AUTO;
+	c->caps_fec = FEC_AUTO;
+	c->caps_qam = QAM_AUTO;
+	c->this_qam = QAM_64;
+	c->this_atsc = VSB_8;
+	c->caps_transmission_mode = TRANSMISSION_MODE_AUTO;
+	c->caps_guard_interval = GUARD_INTERVAL_AUTO;
+	c->caps_hierarchy = HIERARCHY_AUTO;
+
+	c->output_format = OUTPUT_VDR;
+	c->tune_cost = freq_tune_cost;
+
+	c->running_filters = &c->_running_filters;
+	c->waiting_filters = &c->_waiting_filters;
+	c->scanned_transponders = &c->_scanned_transponders;
+	c->new_transponders = &c->_new_transponders;
+	c->satellite_transponders = &c->_satellite_transponders;
+	NewList(c->running_filters, "running_filters");
+	NewList(c->waiting_filters, "waiting_filters");
+	NewList(c->scanned_transponders, "scanned_transponders");
+	NewList(c->new_transponders, "new_transponders");
+	NewList(c->satellite_transponders, "satellite_transponders");
+	return c;
+}
+
+static void free_transponders(pList list)
+{
+	struct transponder *t;
+	struct service *s;
+
+	for (t = list->first; t; t = t->next) {
+		for (s = t->services->first; s; s = s->next) {
+			free(s->provider_name);
+			free(s->provider_short_name);
+			free(s->service_name);
+			free(s->service_short_name);
+		}
+		ClearList(t->services);
+		ClearList(t->cells);
+		free(t->network_name);
+	}
+	ClearList(list);
+}
+
+/* filters have to be stopped, i.e. the scan is finished. */
+void scan_context_free(struct scan_context *c)
+{
+	if (c == NULL)
+		return;
+	free_transponders(c->scanned_transponders);
+	free_transponders(c->new_transponders);
+	free_transponders(c->satellite_transponders);
+	if (c->diff_before)
+		diff_free(c->diff_before);
+	si_cache_free(c->si_cache);
+	dead_cache_free(c->dead_cache);
+	diseqc_context_release(&c->diseqc);
+	if (c->scr_claims)
+		munmap(c->scr_claims, sizeof(*c->scr_claims));
+	free(c->checkpoint);
+	if (ctx == c)
+		ctx = NULL;
+	free(c);
+}
+
+struct scan_context *scan_context_use(struct scan_context *c)
+{
+	struct scan_context *prev = ctx;
+
+	ctx = c;
+	diseqc_context_use(c ? &c->diseqc : NULL);
+	return prev;
+}
+
+void scan_context_set_callbacks(struct scan_context *c,
+				const struct scan_callbacks *cb)
+{
+	c->callbacks = *cb;
+}
+
 #define MOD_USE_STANDARD  0x0
 #define MOD_OVERRIDE_MIN  0x1
 #define MOD_OVERRIDE_MAX  0x2
@@ -4117,11 +5645,12 @@ void ext_help(void)
 
 #define cl(x)  if (x) { free(x); x=NULL; }
 
-int main(int argc, char **argv)
+static int scan_main(struct scan_context *c, struct option_parser *p)
 {
 	char frontend_devname[80];
 	int adapter = DVB_ADAPTER_AUTO, frontend = 0, demux = 0;
 	int opt;
+	uint32_t changes = 0;	// --diff
 	unsigned int i = 0, j;
 	int frontend_fd = -1;
 	int fe_open_mode;
@@ -4139,91 +5668,94 @@ int main(int argc, char **argv)
 	char *codepage = NULL;
 	char *satellite = NULL;
 	char *initdata = NULL;
+	char *warmstart = NULL;
+	char *verifyfile = NULL;
+	char *difffile = NULL;
+	char *diffvdr = NULL;
+	char *resumefile = NULL;
+	unsigned shard_i, shard_n;
 	char *positionfile = NULL;
 	char sw_type = 0;
+	struct warm_device *warm = NULL;
 
-	// initialize lists.
-	NewList(running_filters, "running_filters");
-	NewList(waiting_filters, "waiting_filters");
-	NewList(scanned_transponders, "scanned_transponders");
-	NewList(new_transponders, "new_transponders");
-
-#define cleanup() cl(country); cl(satellite); cl(initdata); cl(positionfile); cl(codepage);
+	log_init();
+	scan_context_use(c);
 
-	this_lnb = *lnb_enum(0);
-	this_lnb.low_val *= 1000;
-	this_lnb.high_val *= 1000;
-	this_lnb.switch_val *= 1000;
+#define cleanup() cl(country); cl(satellite); cl(initdata); cl(warmstart); cl(verifyfile); cl(difffile); cl(diffvdr); cl(resumefile); cl(positionfile); cl(codepage);
 
 	run_time_init();
 
-	for (opt = 0; opt < argc; opt++)
-		info("%s ", argv[opt]);
+	if (p->options) {
+		info("%s", p->name);
+		for (opt = 0; (unsigned)opt < p->count; opt++)
+			info(" %s%s %s", strlen(p->options[opt].name) > 1 ? "--" : "-",
+			     p->options[opt].name,
+			     p->options[opt].value ? p->options[opt].value : "");
+	} else
+		for (opt = 0; opt < p->argc; opt++)
+			info("%s ", p->argv[opt]);
 	info("%s", "\n");
 
-	while ((opt =
-		getopt_long(argc, argv,
-			    "a:c:de:f:hi:l:o:p:qr:s:t:u:vxA:C:D:E:FGHI:LMO:PQ:R:S:T:VXZ",
-			    long_options, NULL)) != -1) {
+	while ((opt = next_option(p)) != -1) {
 		switch (opt) {
 		case 'a':	//adapter
-			if (strstr(optarg, "/dev/dvb")) {
+			if (strstr(p->arg, "/dev/dvb")) {
 				if (sscanf
-				    (optarg,
+				    (p->arg,
 				     "/dev/dvb/adapter%d/frontend%d",
 				     &adapter, &frontend) != 2)
 					adapter =
 					    DVB_ADAPTER_AUTO, frontend = 0;
 			} else {
 				adapter = DVB_ADAPTER_AUTO, frontend = 0;
-				if (sscanf(optarg, "%d", &adapter) < 1) {
+				if (sscanf(p->arg, "%d", &adapter) < 1) {
 					adapter = 9999, frontend = 0;
-					flags.emulate = 1;
-					em_init(optarg);
+					ctx->flags.emulate = 1;
+					em_init(p->arg);
 				}
 			}
 			break;
 		case 'c':	//country setting
-			if (0 == strcasecmp(optarg, "?")) {
+			if (0 == strcasecmp(p->arg, "?")) {
 				print_countries();
 				cleanup();
 				return (0);
 			}
 			cl(country);
-			country = strdup(optarg);
+			country = strdup(p->arg);
 			break;
 		case 'e':	//extended scan flags
-			ext = strtoul(optarg, NULL, 0);
+			ext = strtoul(p->arg, NULL, 0);
 			if (ext & 0x01)
-				dvbc_symbolrate_max = 17;
+				ctx->dvbc_symbolrate_max = 17;
 			if (ext & 0x02) {
-				modulation_max = 2;
+				ctx->modulation_max = 2;
 				modulation_flags |= MOD_OVERRIDE_MAX;
 			}
 			break;
 		case 'f':	//frontend type -> hmmm..., actually it's scan type now! 20120109, -wk-
-			if (strcmp(optarg, "t") == 0)
+			if (strcmp(p->arg, "t") == 0)
 				scantype = SCAN_TERRESTRIAL;
-			if (strcmp(optarg, "t1") == 0) {
+			if (strcmp(p->arg, "t1") == 0) {
 				scantype = SCAN_TERRESTRIAL;
-				flags.delsys = SYS_DVBT;
+				ctx->flags.delsys = SYS_DVBT;
 			}
-			if (strcmp(optarg, "t2") == 0) {
+			if (strcmp(p->arg, "t2") == 0) {
 				scantype = SCAN_TERRESTRIAL;
-				flags.delsys = SYS_DVBT2;
+				ctx->flags.delsys = SYS_DVBT2;
 			}
-			if (strcmp(optarg, "c") == 0)
+			if (strcmp(p->arg, "c") == 0)
 				scantype = SCAN_CABLE;
-			if (strcmp(optarg, "a") == 0)
+			if (strcmp(p->arg, "a") == 0)
 				scantype = SCAN_TERRCABLE_ATSC;
-			if (strcmp(optarg, "s") == 0)
+			if (strcmp(p->arg, "s") == 0)
 				scantype = SCAN_SATELLITE;
 			if (scantype == SCAN_TERRCABLE_ATSC) {
-				this_channellist = ATSC_VSB;
+				ctx->this_channellist = ATSC_VSB;
 				country = strdup("US");
 			}
-			if (strcmp(optarg, "b") == 0) {
-				this_channellist = ISDBT_6MHZ;
+			if (strcmp(p->arg, "b") == 0) {
+				ctx->this_channellist = ISDBT_6MHZ;
 				scantype = SCAN_TERRESTRIAL;
 			}
 			break;
@@ -4233,10 +5765,10 @@ int main(int argc, char **argv)
 			return 0;
 			break;
 		case 'i':	//specify inversion
-			caps_inversion = strtoul(optarg, NULL, 0);
+			ctx->caps_inversion = strtoul(p->arg, NULL, 0);
 			break;
 		case 'l':	//satellite lnb type
-			if (strcmp(optarg, "?") == 0) {
+			if (strcmp(p->arg, "?") == 0) {
 				struct lnb_types_st *p;
 				char **cp;
 
@@ -4248,128 +5780,128 @@ int main(int argc, char **argv)
 				cleanup();
 				return 0;
 			}
-			if (lnb_decode(optarg, &this_lnb) < 0) {
+			if (lnb_decode(p->arg, &ctx->this_lnb) < 0) {
 				cleanup();
 				fatal
 				    ("LNB decoding failed. Use \"-l ?\" for list.\n");
 			}
 			/* MHz -> kHz */
-			this_lnb.low_val *= 1000;
-			this_lnb.high_val *= 1000;
-			this_lnb.switch_val *= 1000;
+			ctx->this_lnb.low_val *= 1000;
+			ctx->this_lnb.high_val *= 1000;
+			ctx->this_lnb.switch_val *= 1000;
 			break;
 		case 'o':	//vdr Version
-			flags.vdr_version = strtoul(optarg, NULL, 0);
+			ctx->flags.vdr_version = strtoul(p->arg, NULL, 0);
 			break;
 		case 'p':	//satellite *p*osition file
-			positionfile = strdup(optarg);
+			positionfile = strdup(p->arg);
 			break;
 		case 'q':	//quite
 			if (--verbosity < 0)
 				verbosity = 0;
 			break;
 		case 'r':	//satellite rotor position
-			flags.rotor_position = strtoul(optarg, NULL, 0);
+			ctx->flags.rotor_position = strtoul(p->arg, NULL, 0);
 			break;
 		case 's':	//satellite setting
-			if (0 == strcasecmp(optarg, "?")) {
+			if (0 == strcasecmp(p->arg, "?")) {
 				print_satellites();
 				cleanup();
 				return (0);
 			}
-			satellite = strdup(optarg);
+			satellite = strdup(p->arg);
 			break;
 		case 't':	//tuning speed
-			flags.tuning_timeout = strtoul(optarg, NULL, 0);
-			if ((flags.tuning_timeout < 1))
-				bad_usage(argv[0]);
-			if ((flags.tuning_timeout > 3))
-				bad_usage(argv[0]);
+			ctx->flags.tuning_timeout = strtoul(p->arg, NULL, 0);
+			if ((ctx->flags.tuning_timeout < 1))
+				bad_usage(p->name);
+			if ((ctx->flags.tuning_timeout > 3))
+				bad_usage(p->name);
 			break;
 		case 'u':	//SCR user definition: <slot>:<user frequency>:<SatPos 'A' or 'B'>(:<Pin>) "N:N:<A|B>(:Pin)"
 			{
 				char c = 'A';
 				int i1 = 0, i2 = 0, i3 = 0xFFFF;
 				if (sscanf
-				    (optarg, "%d:%d:%c:%d", &i1, &i2,
+				    (p->arg, "%d:%d:%c:%d", &i1, &i2,
 				     &c, &i3) < 3)
-					bad_usage(argv[0]);
-				scr_config.slot = i1;
-				scr_config.user_frequency = i2;
-				scr_config.pin = i3;
+					bad_usage(p->name);
+				ctx->scr_config.slot = i1;
+				ctx->scr_config.user_frequency = i2;
+				ctx->scr_config.pin = i3;
 				switch (c) {
 				case 'A':
-					scr_config.pos = 0;
-					scr_config.norm = 1;
+					ctx->scr_config.pos = 0;
+					ctx->scr_config.norm = 1;
 					break;
 				case 'B':
-					scr_config.pos = 1;
-					scr_config.norm = 1;
+					ctx->scr_config.pos = 1;
+					ctx->scr_config.norm = 1;
 					break;
 					//--------------------------------------------------
 				case 'a':
-					scr_config.pos = (0U << 6) | (0U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (0U << 6) | (0U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'b':
-					scr_config.pos = (0U << 6) | (1U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (0U << 6) | (1U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'c':
-					scr_config.pos = (0U << 6) | (2U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (0U << 6) | (2U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'd':
-					scr_config.pos = (0U << 6) | (3U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (0U << 6) | (3U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'e':
-					scr_config.pos = (1U << 6) | (0U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (1U << 6) | (0U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'f':
-					scr_config.pos = (1U << 6) | (1U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (1U << 6) | (1U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'g':
-					scr_config.pos = (1U << 6) | (2U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (1U << 6) | (2U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'h':
-					scr_config.pos = (1U << 6) | (3U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (1U << 6) | (3U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'i':
-					scr_config.pos = (2U << 6) | (0U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (2U << 6) | (0U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'j':
-					scr_config.pos = (2U << 6) | (1U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (2U << 6) | (1U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'k':
-					scr_config.pos = (2U << 6) | (2U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (2U << 6) | (2U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'l':
-					scr_config.pos = (2U << 6) | (3U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (2U << 6) | (3U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'm':
-					scr_config.pos = (3U << 6) | (0U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (3U << 6) | (0U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'n':
-					scr_config.pos = (3U << 6) | (1U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (3U << 6) | (1U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'o':
-					scr_config.pos = (3U << 6) | (2U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (3U << 6) | (2U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				case 'p':
-					scr_config.pos = (3U << 6) | (3U << 2);
-					scr_config.norm = 2;
+					ctx->scr_config.pos = (3U << 6) | (3U << 2);
+					ctx->scr_config.norm = 2;
 					break;
 				default:
 					fatal
@@ -4384,50 +5916,165 @@ int main(int argc, char **argv)
 		case '!':	//debug
 			verbosity = 5;
 			break;
+		case OPT_ROTOR_MODEL:	//measured rotor speed
+			rotor_model_load(p->arg);
+			break;
+		case OPT_STREAM:	//write services per transponder
+			ctx->flags.stream_output = 1;
+			break;
+		case OPT_STATS:	//scan phase timing
+			stats_open(p->arg);
+			break;
+		case OPT_TRACE:	//timeline of tuner and filter activity
+			trace_open(p->arg);
+			break;
+		case OPT_DAEMON:	//scan jobs from a UNIX socket
+			daemon_run(p->arg);
+			break;
+		case OPT_SI_CACHE:	//incremental rescan
+			si_cache_free(ctx->si_cache);
+			ctx->si_cache = si_cache_load(p->arg);
+			break;
+		case OPT_WARM_START:	//transponders of a previous scan
+			cl(warmstart);
+			warmstart = strdup(p->arg);
+			break;
+		case OPT_FILL_GAPS:	//warm start + blind scan
+			ctx->fill_gaps = true;
+			break;
+		case OPT_MONITOR:	//stay on first transponder, report SI changes
+			monitor_open(p->arg);
+			break;
+		case OPT_VERIFY:	//check a previous scan, PAT + SDT only
+			cl(verifyfile);
+			verifyfile = strdup(p->arg);
+			break;
+		case OPT_DIFF:	//changes against a previous scan
+			cl(difffile);
+			difffile = strdup(p->arg);
+			break;
+		case OPT_DIFF_VDR:	//changed services, VDR format
+			cl(diffvdr);
+			diffvdr = strdup(p->arg);
+			break;
+		case OPT_CHECKPOINT:	//save progress periodically
+			free(ctx->checkpoint);
+			ctx->checkpoint = strdup(p->arg);
+			break;
+		case OPT_RESUME:	//continue from checkpoint
+			cl(resumefile);
+			resumefile = strdup(p->arg);
+			break;
+		case OPT_SHARD:	//part i of n of the scan
+			if ((sscanf(p->arg, "%u/%u", &shard_i, &shard_n) != 2)
+			    || (shard_i < 1) || (shard_i > shard_n))
+				fatal("invalid shard '%s', expected i/n with 1 <= i <= n\n",
+				      p->arg);
+			ctx->shard = shard_i - 1;
+			ctx->shard_count = shard_n;
+			break;
+		case OPT_MERGE:	//results of shards
+			merge_result(p->arg);
+			break;
+		case OPT_DEAD_CACHE:	//frequencies without lock
+			dead_cache_load(ctx->dead_cache, p->arg);
+			break;
+		case OPT_DEAD_TTL:	//hours until retry
+			{
+				char *end;
+				unsigned long hours = strtoul(p->arg, &end, 10);
+
+				if ((end == p->arg) || *end || (hours > 24 * 365))
+					fatal("invalid dead frequency ttl '%s'\n",
+					      p->arg);
+				ctx->dead_cache->ttl = hours * 3600;
+			}
+			break;
+		case OPT_OUTPUT:	//additional output "format:file"
+			{
+				struct output_sink *o;
+				char *file = strchr(p->arg, ':');
+				if (ctx->output_sinks_count >= MAX_OUTPUT_SINKS)
+					fatal("too many outputs (max %d)\n",
+					      MAX_OUTPUT_SINKS);
+				if ((file == NULL) || (*(file + 1) == 0))
+					bad_usage(p->name);
+				o = &ctx->output_sinks[ctx->output_sinks_count];
+				for (i = 0; i < NUM_OUTPUT_FORMATS; i++) {
+					if (!strncmp(p->arg, output_format_names[i].name, file - p->arg)
+					    && (strlen(output_format_names[i].name) == (size_t)(file - p->arg)))
+						break;
+				}
+				if (i == NUM_OUTPUT_FORMATS)
+					fatal("unknown output format in '%s'\n", p->arg);
+				o->format = output_format_names[i].format;
+				o->format_name = output_format_names[i].name;
+				o->name = strdup(file + 1);
+				ctx->output_sinks_count++;
+			}
+			break;
+		case OPT_SCR_FRONTEND:	//parallel scan: "adapter:frontend:slot:user_frequency"
+			{
+				struct scr_frontend *fe;
+				int i1, i2, i3, i4;
+				if (ctx->scr_frontends_count >= MAX_SCR_FRONTENDS)
+					fatal("too many SCR frontends (max %d)\n",
+					      MAX_SCR_FRONTENDS);
+				if (sscanf(p->arg, "%d:%d:%d:%d", &i1, &i2, &i3,
+					   &i4) != 4)
+					bad_usage(p->name);
+				fe = &ctx->scr_frontends[ctx->scr_frontends_count++];
+				fe->adapter = i1;
+				fe->frontend = i2;
+				fe->slot = i3;
+				fe->user_frequency = i4;
+				fe->pid = 0;
+			}
+			break;
 		case 'x':	//dvbscan output
-			output_format = OUTPUT_DVBSCAN_TUNING_DATA;
+			ctx->output_format = OUTPUT_DVBSCAN_TUNING_DATA;
 			break;
 		case 'A':	//ATSC type
-			ATSC_type = strtoul(optarg, NULL, 0);
-			switch (ATSC_type) {
+			ctx->ATSC_type = strtoul(p->arg, NULL, 0);
+			switch (ctx->ATSC_type) {
 			case 1:
-				ATSC_type = ATSC_VSB;
+				ctx->ATSC_type = ATSC_VSB;
 				break;
 			case 2:
-				ATSC_type = ATSC_QAM;
+				ctx->ATSC_type = ATSC_QAM;
 				break;
 			case 3:
-				ATSC_type = (ATSC_VSB + ATSC_QAM);
+				ctx->ATSC_type = (ATSC_VSB + ATSC_QAM);
 				break;
 			default:
 				cleanup();
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 				return -1;
 			}
 			/* if -A is specified, it implies -f a */
 			scantype = SCAN_TERRCABLE_ATSC;
 			break;
 		case 'C':	// charset
-			codepage = strdup(optarg);
+			codepage = strdup(p->arg);
 			break;
 		case 'D':	//DiSEqC committed/uncommitted switch
-			sscanf(optarg, "%u%c", &i, &sw_type);
+			sscanf(p->arg, "%u%c", &i, &sw_type);
 			switch (sw_type) {
 			case 'u':
-				uncommitted_switch = i;
-				if (uncommitted_switch > 15)
+				ctx->uncommitted_switch = i;
+				if (ctx->uncommitted_switch > 15)
 					fatal
 					    ("uncommitted switch position needs to be < 16!\n");
-				flags.sw_pos =
-				    (flags.sw_pos & 0xF) | uncommitted_switch;
+				ctx->flags.sw_pos =
+				    (ctx->flags.sw_pos & 0xF) | ctx->uncommitted_switch;
 				break;
 			case 'c':
-				committed_switch = i;
-				if (committed_switch > 3)
+				ctx->committed_switch = i;
+				if (ctx->committed_switch > 3)
 					fatal
 					    ("committed switch position needs to be < 4!\n");
-				flags.sw_pos =
-				    (flags.sw_pos & 0xF0) | committed_switch;
+				ctx->flags.sw_pos =
+				    (ctx->flags.sw_pos & 0xF0) | ctx->committed_switch;
 				break;
 			default:
 				cleanup();
@@ -4437,13 +6084,13 @@ int main(int argc, char **argv)
 			}
 			break;
 		case 'E':	//include encrypted channels
-			flags.ca_select = strtoul(optarg, NULL, 0);
+			ctx->flags.ca_select = strtoul(p->arg, NULL, 0);
 			break;
 		case 'F':	//filter timeout
-			flags.filter_timeout = 1;
+			ctx->flags.filter_timeout = 1;
 			break;
 		case 'G':
-			output_format = OUTPUT_GSTREAMER;
+			ctx->output_format = OUTPUT_GSTREAMER;
 			break;
 		case 'H':	//expert help
 			ext_help();
@@ -4451,63 +6098,63 @@ int main(int argc, char **argv)
 			return 0;
 			break;
 		case 'I':	//expert providing initial_tuning_data
-			initdata = strdup(optarg);
+			initdata = strdup(p->arg);
 			break;
 		case 'd':	// delete duplicate transponders
-			flags.delete_duplicate_transponders = 1;
+			ctx->flags.delete_duplicate_transponders = 1;
 			break;
 		case 'L':	//vlc output
-			output_format = OUTPUT_VLC_M3U;
+			ctx->output_format = OUTPUT_VLC_M3U;
 			break;
 		case 'M':	//mplayer output
-			output_format = OUTPUT_MPLAYER;
+			ctx->output_format = OUTPUT_MPLAYER;
 			break;
 		case 'O':	//other services
-			Other_Services = strtoul(optarg, NULL, 0);
+			Other_Services = strtoul(p->arg, NULL, 0);
 			if ((Other_Services < 0))
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 			if ((Other_Services > 1))
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 			break;
 		case 'P':	//ATSC PSIP scan
-			no_ATSC_PSIP = 1;
+			ctx->no_ATSC_PSIP = 1;
 			break;
 		case 'Q':	//specify DVB-C QAM
-			modulation_min = modulation_max =
-			    strtoul(optarg, NULL, 0);
+			ctx->modulation_min = ctx->modulation_max =
+			    strtoul(p->arg, NULL, 0);
 			modulation_flags |= MOD_OVERRIDE_MIN;
 			modulation_flags |= MOD_OVERRIDE_MAX;
 			break;
 		case 'R':	//include Radio
-			Radio_Services = strtoul(optarg, NULL, 0);
+			Radio_Services = strtoul(p->arg, NULL, 0);
 			if ((Radio_Services < 0))
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 			if ((Radio_Services > 1))
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 			break;
 		case 'S':	//DVB-C symbolrate index
-			dvbc_symbolrate_min = dvbc_symbolrate_max =
-			    strtoul(optarg, NULL, 0);
+			ctx->dvbc_symbolrate_min = ctx->dvbc_symbolrate_max =
+			    strtoul(p->arg, NULL, 0);
 			break;
 		case 'T':	//include TV
-			TV_Services = strtoul(optarg, NULL, 0);
+			TV_Services = strtoul(p->arg, NULL, 0);
 			if ((TV_Services < 0))
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 			if ((TV_Services > 1))
-				bad_usage(argv[0]);
+				bad_usage(p->name);
 			break;
 		case 'V':	//Version
 			retVersion++;
 			break;
 		case 'X':	//xine output
-			output_format = OUTPUT_XINE;
+			ctx->output_format = OUTPUT_XINE;
 			break;
 		case 'Z':	//w_scan2 xml output
-			output_format = OUTPUT_XML;
+			ctx->output_format = OUTPUT_XML;
 			break;
 		default:	//undefined
 			cleanup();
-			bad_usage(argv[0]);
+			bad_usage(p->name);
 			return -1;
 		}
 	}
@@ -4530,19 +6177,19 @@ int main(int argc, char **argv)
 			fatal("Missing argument \"-s\" (satellite setting)\n");
 		}
 	}
-	serv_select = 1 * TV_Services + 2 * Radio_Services + 4 * Other_Services;
-	if (caps_inversion > INVERSION_AUTO) {
+	ctx->serv_select = 1 * TV_Services + 2 * Radio_Services + 4 * Other_Services;
+	if (ctx->caps_inversion > INVERSION_AUTO) {
 		info("Inversion out of range!\n");
-		bad_usage(argv[0]);
+		bad_usage(p->name);
 		cleanup();
 		return -1;
 	}
 	if (((adapter >= DVB_ADAPTER_MAX)
 	     && (adapter != DVB_ADAPTER_AUTO)
-	     && (!flags.emulate)) || (adapter < 0)) {
+	     && (!ctx->flags.emulate)) || (adapter < 0)) {
 		info("Invalid adapter: out of range (0..%d)\n",
 		     DVB_ADAPTER_MAX - 1);
-		bad_usage(argv[0]);
+		bad_usage(p->name);
 		cleanup();
 		return -1;
 	}
@@ -4551,32 +6198,33 @@ int main(int argc, char **argv)
 	case SCAN_CABLE:
 	case SCAN_TERRESTRIAL:
 		if (country != NULL) {
-			int atsc = ATSC_type;
+			int atsc = ctx->ATSC_type;
 			int dvb = scantype;
-			flags.atsc_type = ATSC_type;
+			ctx->flags.atsc_type = ctx->ATSC_type;
 			choose_country(country, &atsc, &dvb, &scantype,
-				       &this_channellist);
+				       &ctx->this_channellist);
 			//dvbc: setting qam loop
 			if ((modulation_flags & MOD_OVERRIDE_MAX) ==
 			    MOD_USE_STANDARD)
-				modulation_max =
-				    dvbc_qam_max(2, this_channellist);
+				ctx->modulation_max =
+				    dvbc_qam_max(2, ctx->this_channellist);
 			if ((modulation_flags & MOD_OVERRIDE_MIN) ==
 			    MOD_USE_STANDARD)
-				modulation_min =
-				    dvbc_qam_min(2, this_channellist);
-			flags.list_id = txt_to_country(country);
+				ctx->modulation_min =
+				    dvbc_qam_min(2, ctx->this_channellist);
+			ctx->flags.list_id = txt_to_country(country);
 			cl(country);
 		}
 		break;
 	case SCAN_SATELLITE:
-		if (satellite != NULL) {
-			choose_satellite(satellite, &this_channellist);
-			flags.list_id = txt_to_satellite(satellite);
+		if ((satellite != NULL) && (strchr(satellite, ',') == NULL)
+		    && strcasecmp(satellite, "ROTOR")) {
+			choose_satellite(satellite, &ctx->this_channellist);
+			ctx->flags.list_id = txt_to_satellite(satellite);
 			cl(satellite);
-			sat_list[this_channellist].rotor_position =
-			    flags.rotor_position;
-		} else if (flags.rotor_position > -1) {
+			set_sat_rotor_position(ctx->this_channellist,
+					       ctx->flags.rotor_position);
+		} else if (ctx->flags.rotor_position > -1) {
 			cleanup();
 			fatal("Using rotor position needs option \"-s\"\n");
 		}
@@ -4591,44 +6239,167 @@ int main(int argc, char **argv)
 				     "CHECK IDENTIFIERS AND FILE FORMAT.\n");
 			}
 		}
-		if (scr_config.user_frequency)
-			info("SCR: slot=%u, userfreq=%uMHz, satpos=%c, pin=%d\n", scr_config.slot, scr_config.user_frequency, scr_config.pos == 1 ? 'B' : 'A', scr_config.pin <= 255 ? scr_config.pin : -1);
+		if (satellite != NULL) {	// list of satellites
+			if (!valid_rotor_data || (initdata != NULL)
+			    || (warmstart != NULL) || (verifyfile != NULL)
+			    || (ctx->flags.rotor_position > -1)) {
+				cleanup();
+				fatal("Scanning multiple satellites needs a rotor position file (option \"-p\"),\n"
+				      "options \"-I\", \"-r\", \"--warm-start\" and \"--verify\" cannot be used.\n");
+			}
+			parse_satellite_list(satellite);
+			cl(satellite);
+		}
+		if (ctx->scr_config.user_frequency)
+			info("SCR: slot=%u, userfreq=%uMHz, satpos=%c, pin=%d\n", ctx->scr_config.slot, ctx->scr_config.user_frequency, ctx->scr_config.pos == 1 ? 'B' : 'A', ctx->scr_config.pin <= 255 ? ctx->scr_config.pin : -1);
+		if (ctx->scr_frontends_count > 0) {
+			if (!ctx->scr_config.user_frequency || ctx->flags.emulate
+			    || (ctx->satellites_count > 0) || (ctx->output_sinks_count > 0)
+			    || (difffile != NULL)) {
+				cleanup();
+				fatal("Option \"--scr-frontend\" needs \"-u\" and cannot be combined\n"
+				      "with emulation, a list of satellites, \"--output\" or \"--diff\".\n");
+			}
+			switch (ctx->output_format) {
+			case OUTPUT_XML:
+			case OUTPUT_VLC_M3U:
+			case OUTPUT_DVBSCAN_TUNING_DATA:
+				cleanup();
+				fatal("Option \"--scr-frontend\" supports line based output formats only.\n");
+			default:;
+			}
+		}
 		break;
 	default:
 		cleanup();
 		fatal("Unknown scan type %d\n", scantype);
 	}
 
+	if (verifyfile != NULL) {
+		if ((initdata != NULL) || (warmstart != NULL)
+		    || (scantype == SCAN_TERRCABLE_ATSC)) {
+			cleanup();
+			fatal("option \"--verify\" cannot be used with \"-I\", \"--warm-start\" or ATSC.\n");
+		}
+		ctx->verify = verify_open(verifyfile, stdout);
+		ctx->fill_gaps = false;
+		ctx->warm_start = warm_start_load(&ctx->verify->db, scantype,
+						  ctx->verify->tps);
+		cl(verifyfile);
+		if (ctx->warm_start == 0) {
+			cleanup();
+			fatal("no %s transponders in verify file. EXITING.\n",
+			      scantype_to_text(scantype));
+		}
+	}
+	if (difffile != NULL) {
+		struct chdb db;
+
+		if (chdb_open(&db, difffile) < 0) {
+			error("could not read %s: %s\n", difffile,
+			      strerror(errno));
+			cleanup();
+			fatal("option \"--diff\" needs a channel database. EXITING.\n");
+		}
+		ctx->diff_before = &ctx->_diff_before;
+		NewList(ctx->diff_before, "diff_before");
+		diff_load(&db, ctx->diff_before);
+		chdb_close(&db);
+		cl(difffile);
+	} else if (diffvdr != NULL) {
+		cleanup();
+		fatal("option \"--diff-vdr\" needs \"--diff\".\n");
+	}
+	if (warmstart != NULL) {
+		struct chdb db;
+
+		if (initdata != NULL) {
+			cleanup();
+			fatal("options \"-I\" and \"--warm-start\" cannot be used together.\n");
+		}
+		if (chdb_open(&db, warmstart) < 0)
+			error("could not read %s: %s\n", warmstart,
+			      strerror(errno));
+		else {
+			ctx->warm_start = warm_start_load(&db, scantype, NULL);
+			chdb_close(&db);
+		}
+		cl(warmstart);
+		if (ctx->warm_start == 0) {
+			cleanup();
+			fatal("no %s transponders in warm start file. EXITING.\n",
+			      scantype_to_text(scantype));
+		}
+	}
+	if (resumefile != NULL) {
+		struct checkpoint_state *r = &ctx->resume;
+
+		if ((ctx->satellites_count > 0) || (ctx->scr_frontends_count > 0)
+		    || (ctx->warm_start > 0) || (ctx->verify != NULL)) {
+			cleanup();
+			fatal("option \"--resume\" cannot be used with a list of satellites,\n"
+			      "\"--scr-frontend\", \"--warm-start\" or \"--verify\".\n");
+		}
+		if (checkpoint_read(resumefile, r, ctx->scanned_transponders,
+				    ctx->new_transponders) < 0) {
+			error("could not read checkpoint %s: %s\n", resumefile,
+			      errno == EINVAL ? "not a checkpoint of this w_scan2 version" : strerror(errno));
+			cleanup();
+			fatal("could not resume. EXITING.\n");
+		}
+		if (initdata != NULL) {
+			// tuning data are part of the checkpoint.
+			scantype = ctx->flags.scantype = r->scantype;
+			valid_initial_data = 1;
+			cl(initdata);
+		} else if ((r->scantype != scantype)
+			   || (r->channellist != (uint32_t) ctx->this_channellist)) {
+			cleanup();
+			fatal("checkpoint is from a scan with other options. EXITING.\n");
+		}
+		ctx->this_rotor_pos = r->rotor_position;
+		ctx->cp = *r;
+		ctx->resumed = true;
+		if (ctx->checkpoint == NULL)
+			ctx->checkpoint = strdup(resumefile);
+		cl(resumefile);
+	}
+	if ((ctx->checkpoint != NULL)
+	    && ((ctx->satellites_count > 0) || (ctx->scr_frontends_count > 0))) {
+		cleanup();
+		fatal("option \"--checkpoint\" cannot be used with a list of satellites\n"
+		      "or \"--scr-frontend\".\n");
+	}
 	if (initdata != NULL) {
-		valid_initial_data = dvbscan_parse_tuningdata(initdata, &flags);
+		valid_initial_data = dvbscan_parse_tuningdata(initdata, &ctx->flags);
 		cl(initdata);
 		if (valid_initial_data == 0) {
 			cleanup();
 			fatal("Could not read initial tuning data. EXITING.\n");
 		}
-		if (flags.scantype != scantype) {
+		if (ctx->flags.scantype != scantype) {
 			warning("\n"
 				"========================================================================\n"
 				"INITIAL TUNING DATA NEEDS FRONTEND TYPE %s, YOU SELECTED TYPE %s.\n"
 				"I WILL OVERRIDE YOUR DEFAULTS TO %s\n"
 				"========================================================================\n",
-				scantype_to_text(flags.scantype),
+				scantype_to_text(ctx->flags.scantype),
 				scantype_to_text(scantype),
-				scantype_to_text(flags.scantype));
-			scantype = flags.scantype;
+				scantype_to_text(ctx->flags.scantype));
+			scantype = ctx->flags.scantype;
 			sleep(10);	// enshure that user reads warning.
 		}
 	}
 	if (scantype == SCAN_TERRESTRIAL) {
 		info("scan type %s, delivery system %s, channellist %d\n",
-			scantype_to_text(scantype), delivery_system_name(flags.delsys), this_channellist);
+			scantype_to_text(scantype), delivery_system_name(ctx->flags.delsys), ctx->this_channellist);
 	} else {
 		info("scan type %s, channellist %d\n",
-			scantype_to_text(scantype), this_channellist);
+			scantype_to_text(scantype), ctx->this_channellist);
 	}
-	switch (output_format) {
+	switch (ctx->output_format) {
 	case OUTPUT_VDR:
-		switch (flags.vdr_version) {
+		switch (ctx->flags.vdr_version) {
 		case 2:
 			info("output format vdr-2.0\n");
 			break;
@@ -4641,9 +6412,9 @@ int main(int argc, char **argv)
 		break;
 	case OUTPUT_GSTREAMER:
 		// Gstreamer output: As vdr-1.7+, but pmt_pid added at end of line.
-		flags.print_pmt = 1;
-		flags.vdr_version = 2;
-		output_format = OUTPUT_VDR;
+		ctx->flags.print_pmt = 1;
+		ctx->flags.vdr_version = 2;
+		ctx->output_format = OUTPUT_VDR;
 		info("output format gstreamer\n");
 		break;
 	case OUTPUT_XINE:
@@ -4673,15 +6444,80 @@ int main(int argc, char **argv)
 		break;
 	default:
 		cleanup();
-		fatal("unhandled output format %d\n", output_format);
+		fatal("unhandled output format %d\n", ctx->output_format);
+	}
+	if ((ctx->output_sinks_count == 0) && (ctx->diff_before == NULL)) {
+		ctx->output_sinks[0].format = ctx->output_format;
+		ctx->output_sinks[0].print_pmt = ctx->flags.print_pmt;
+		ctx->output_sinks[0].fd = ctx->flags.emulate ? STDERR_FILENO : STDOUT_FILENO;
+		ctx->output_sinks[0].epilog_pos = -1;
+		ob_init(&ctx->output_sinks[0].out, ctx->output_sinks[0].fd);
+		ctx->output_sinks_count = 1;
+	} else {
+		for (i = 0; i < (unsigned)ctx->output_sinks_count; i++) {
+			struct output_sink *o = &ctx->output_sinks[i];
+			info("output %s: %s\n", o->name, o->format_name);
+			if (o->format == OUTPUT_GSTREAMER) {
+				o->format = OUTPUT_VDR;
+				o->print_pmt = 1;
+			}
+			if (!strcmp(o->name, "-"))
+				o->fd = ctx->flags.emulate ? STDERR_FILENO : STDOUT_FILENO;
+			else if ((o->fd = open(o->name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+					       0666)) < 0) {
+				cleanup();
+				fatal("could not open '%s': %s\n", o->name,
+				      strerror(errno));
+			}
+			o->epilog_pos = -1;
+			ob_init(&o->out, o->fd);
+		}
 	}
 	if (codepage) {
-		flags.codepage = get_codepage_index(codepage);
-		info("output charset '%s'\n", iconv_codes[flags.codepage]);
+		ctx->flags.codepage = get_codepage_index(codepage);
+		info("output charset '%s'\n", iconv_codes[ctx->flags.codepage]);
 	} else {
-		flags.codepage = get_user_codepage();
+		ctx->flags.codepage = get_user_codepage();
 		info("output charset '%s', use -C <charset> to override\n",
-		     iconv_codes[flags.codepage]);
+		     iconv_codes[ctx->flags.codepage]);
+	}
+	// vlc, xml, db and shard are always utf-8, other outputs use the charset above.
+	// If they differ, names are kept as utf-8 and recoded per output.
+	for (i = 0; i < (unsigned)ctx->output_sinks_count; i++) {
+		struct output_sink *o = &ctx->output_sinks[i];
+		if ((o->format == OUTPUT_VLC_M3U)
+		    || (o->format == OUTPUT_XML)
+		    || (o->format == OUTPUT_CHDB)
+		    || (o->format == OUTPUT_SHARD_RESULT))
+			o->codepage = get_codepage_index("UTF-8");
+		else
+			o->codepage = ctx->flags.codepage;
+	}
+	for (i = 1; i < (unsigned)ctx->output_sinks_count; i++) {
+		if (ctx->output_sinks[i].codepage != ctx->output_sinks[0].codepage) {
+			ctx->flags.codepage = get_codepage_index("UTF-8");
+			info("outputs use different charsets, names are recoded per output\n");
+			break;
+		}
+	}
+	if (ctx->merged > 0)	// names from the shards are utf-8.
+		ctx->flags.codepage = get_codepage_index("UTF-8");
+	else if (ctx->output_sinks_count == 1)
+		ctx->flags.codepage = ctx->output_sinks[0].codepage;
+	if (ctx->merged > 0) {	// no scan.
+		if (ctx->scanned_transponders->first != NULL)
+			ctx->flags.scantype = ((struct transponder *)
+					       ctx->scanned_transponders->first)->type;
+		merge_check();
+		dump_lists(-1, -1);
+		cleanup();
+		return 0;
+	}
+	if (!ctx->flags.emulate
+	    && (warm = daemon_warm_device(adapter == DVB_ADAPTER_AUTO ? -1 : adapter,
+					  frontend, scantype))) {
+		adapter = warm->adapter;
+		frontend = warm->frontend;
 	}
 	if (adapter == DVB_ADAPTER_AUTO) {
 		info("Info: using DVB adapter auto detection.\n");
@@ -4699,34 +6535,34 @@ int main(int argc, char **argv)
 				/* determine FE type and caps */
 				if (ioctl
 				    (frontend_fd, FE_GET_INFO,
-				     &fe_info) == -1) {
+				     &ctx->fe_info) == -1) {
 					info("   ERROR: unable to determine frontend type\n");
 					close(frontend_fd);
 					continue;
 				}
 
-				if (flags.api_version < 0x0500)
-					get_api_version(frontend_fd, &flags);
+				if (ctx->flags.api_version < 0x0500)
+					get_api_version(frontend_fd, &ctx->flags);
 
 				if (fe_supports_scan
-				    (frontend_fd, scantype, fe_info)) {
+				    (frontend_fd, scantype, ctx->fe_info)) {
 					info("\t%s -> %s \"%s\": ",
 					     frontend_devname,
 					     scantype_to_text(scantype),
-					     fe_info.name);
+					     ctx->fe_info.name);
 					if (device_is_preferred
-					    (fe_info.caps, fe_info.name,
+					    (ctx->fe_info.caps, ctx->fe_info.name,
 					     scantype) >= device_preferred) {
 						if (device_is_preferred
-						    (fe_info.caps,
-						     fe_info.name,
+						    (ctx->fe_info.caps,
+						     ctx->fe_info.name,
 						     scantype) >
 						    device_preferred) {
 							device_preferred
 							    =
 							    device_is_preferred
-							    (fe_info.caps,
-							     fe_info.name,
+							    (ctx->fe_info.caps,
+							     ctx->fe_info.name,
 							     scantype);
 							adapter = i;
 							frontend = j;
@@ -4749,7 +6585,7 @@ int main(int argc, char **argv)
 					}
 					close(frontend_fd);
 				} else {
-					info("\t%s -> \"%s\" doesnt support %s -> SEARCH NEXT ONE.\n", frontend_devname, fe_info.name, scantype_to_text(scantype));
+					info("\t%s -> \"%s\" doesnt support %s -> SEARCH NEXT ONE.\n", frontend_devname, ctx->fe_info.name, scantype_to_text(scantype));
 					close(frontend_fd);
 				}
 			}	// END: for j
@@ -4765,11 +6601,11 @@ int main(int argc, char **argv)
 	}
 	snprintf(frontend_devname, sizeof(frontend_devname),
 		 "/dev/dvb/adapter%i/frontend%i", adapter, frontend);
-	snprintf(demux_devname, sizeof(demux_devname),
+	snprintf(ctx->demux_devname, sizeof(ctx->demux_devname),
 		 "/dev/dvb/adapter%i/demux%i", adapter, demux);
 
 	for (i = 0; i < MAX_RUNNING; i++)
-		poll_fds[i].fd = -1;
+		ctx->poll_fds[i].fd = -1;
 
 	fe_open_mode = O_RDWR;
 	if (adapter == DVB_ADAPTER_AUTO) {
@@ -4779,218 +6615,227 @@ int main(int argc, char **argv)
 		      "verify that no dvb application (i.e. vdr) is running.\n",
 		      scantype_to_text(scantype));
 	}
-	EMUL(em_open, &frontend_fd)
-	    if ((frontend_fd = open(frontend_devname, fe_open_mode)) < 0) {
-		cleanup();
-		fatal("failed to open '%s': %d %s\n", frontend_devname,
-		      errno, strerror(errno));
-	}
-	info("-_-_-_-_ Getting frontend capabilities-_-_-_-_ \n");
-	/* determine FE type and caps */
-	EMUL(em_info, &fe_info)
-	    if (ioctl(frontend_fd, FE_GET_INFO, &fe_info) == -1) {
-		cleanup();
-		fatal("FE_GET_INFO failed: %d %s\n", errno, strerror(errno));
-	}
-	flags.scantype = scantype;
+	if (warm) {
+		info("Using %s, kept open by daemon\n", frontend_devname);
+		frontend_fd = warm->fd;
+		ctx->fe_info = warm->fe_info;
+		ctx->flags.api_version = warm->api_version;
+		ctx->this_rotor_pos = warm->rotor_pos;
+		sec_state_import(warm->sec_state);
+	} else {
+		EMUL(em_open, &frontend_fd)
+		    if ((frontend_fd = open(frontend_devname, fe_open_mode)) < 0) {
+			cleanup();
+			fatal("failed to open '%s': %d %s\n", frontend_devname,
+			      errno, strerror(errno));
+		}
+		info("-_-_-_-_ Getting frontend capabilities-_-_-_-_ \n");
+		/* determine FE type and caps */
+		EMUL(em_info, &ctx->fe_info)
+		    if (ioctl(frontend_fd, FE_GET_INFO, &ctx->fe_info) == -1) {
+			cleanup();
+			fatal("FE_GET_INFO failed: %d %s\n", errno, strerror(errno));
+		}
 
-	EMUL(em_dvbapi, &flags.api_version)
-	    if (get_api_version(frontend_fd, &flags) < 0)
-		fatal
-		    ("Your DVB driver doesnt support DVB API v5. Please upgrade.\n");
+		EMUL(em_dvbapi, &ctx->flags.api_version)
+		    if (get_api_version(frontend_fd, &ctx->flags) < 0)
+			fatal
+			    ("Your DVB driver doesnt support DVB API v5. Please upgrade.\n");
+	}
+	ctx->flags.scantype = scantype;
 
-	info("Using DVB API %d.%d\n", flags.api_version >> 8,
-	     flags.api_version & 0xFF);
+	info("Using DVB API %d.%d\n", ctx->flags.api_version >> 8,
+	     ctx->flags.api_version & 0xFF);
 
-	info("frontend '%s' supports\n", fe_info.name
-	     && *fe_info.name ? fe_info.name : "<NULL pointer>");
+	info("frontend '%s' supports\n", ctx->fe_info.name
+	     && *ctx->fe_info.name ? ctx->fe_info.name : "<NULL pointer>");
 
-	switch (flags.scantype) {
+	switch (ctx->flags.scantype) {
 	case SCAN_TERRESTRIAL:
-		if (fe_info.caps & FE_CAN_2G_MODULATION) {
+		if (ctx->fe_info.caps & FE_CAN_2G_MODULATION) {
 			info("DVB-T2\n");
 		}
-		if (fe_info.caps & FE_CAN_INVERSION_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_INVERSION_AUTO) {
 			info("INVERSION_AUTO\n");
-			caps_inversion = INVERSION_AUTO;
+			ctx->caps_inversion = INVERSION_AUTO;
 		} else {
 			info("INVERSION_AUTO not supported, trying INVERSION_OFF.\n");
-			caps_inversion = INVERSION_OFF;
+			ctx->caps_inversion = INVERSION_OFF;
 		}
-		if (fe_info.caps & FE_CAN_QAM_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_QAM_AUTO) {
 			info("QAM_AUTO\n");
-			caps_qam = QAM_AUTO;
+			ctx->caps_qam = QAM_AUTO;
 		} else {
 			info("QAM_AUTO not supported, trying QAM_64.\n");
-			caps_qam = QAM_64;
+			ctx->caps_qam = QAM_64;
 		}
-		if (fe_info.caps & FE_CAN_TRANSMISSION_MODE_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_TRANSMISSION_MODE_AUTO) {
 			info("TRANSMISSION_MODE_AUTO\n");
-			caps_transmission_mode = TRANSMISSION_MODE_AUTO;
+			ctx->caps_transmission_mode = TRANSMISSION_MODE_AUTO;
 		} else {
-			caps_transmission_mode =
-			    dvbt_transmission_mode(5, this_channellist);
+			ctx->caps_transmission_mode =
+			    dvbt_transmission_mode(5, ctx->this_channellist);
 			info("TRANSMISSION_MODE not supported, trying %s.\n",
-			     transmission_mode_name(caps_transmission_mode));
+			     transmission_mode_name(ctx->caps_transmission_mode));
 		}
-		if (fe_info.caps & FE_CAN_GUARD_INTERVAL_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_GUARD_INTERVAL_AUTO) {
 			info("GUARD_INTERVAL_AUTO\n");
-			caps_guard_interval = GUARD_INTERVAL_AUTO;
+			ctx->caps_guard_interval = GUARD_INTERVAL_AUTO;
 		} else {
 			info("GUARD_INTERVAL_AUTO not supported, trying GUARD_INTERVAL_1_8.\n");
-			caps_guard_interval = GUARD_INTERVAL_1_8;
+			ctx->caps_guard_interval = GUARD_INTERVAL_1_8;
 		}
-		if (fe_info.caps & FE_CAN_HIERARCHY_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_HIERARCHY_AUTO) {
 			info("HIERARCHY_AUTO\n");
-			caps_hierarchy = HIERARCHY_AUTO;
+			ctx->caps_hierarchy = HIERARCHY_AUTO;
 		} else {
 			info("HIERARCHY_AUTO not supported, trying HIERARCHY_NONE.\n");
-			caps_hierarchy = HIERARCHY_NONE;
+			ctx->caps_hierarchy = HIERARCHY_NONE;
 		}
-		if (fe_info.caps & FE_CAN_FEC_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_FEC_AUTO) {
 			info("FEC_AUTO\n");
-			caps_fec = FEC_AUTO;
+			ctx->caps_fec = FEC_AUTO;
 		} else {
 			info("FEC_AUTO not supported, trying FEC_NONE.\n");
-			caps_fec = FEC_NONE;
+			ctx->caps_fec = FEC_NONE;
 		}
-		if (fe_info.caps & FE_CAN_BANDWIDTH_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_BANDWIDTH_AUTO) {
 			info("BANDWIDTH_AUTO\n");
-			bandwidth_auto = true;
+			ctx->bandwidth_auto = true;
 		} else {
 			info("BANDWIDTH_AUTO not supported, trying 6/7/8 MHz.\n");
-			bandwidth_auto = false;
+			ctx->bandwidth_auto = false;
 		}
-		if (fe_info.frequency_min == 0 || fe_info.frequency_max == 0) {
+		if (ctx->fe_info.frequency_min == 0 || ctx->fe_info.frequency_max == 0) {
 			info("This dvb driver is *buggy*: the frequency limits are undefined - please report to linuxtv.org\n");
-			fe_info.frequency_min = 177500000;
-			fe_info.frequency_max = 858000000;
+			ctx->fe_info.frequency_min = 177500000;
+			ctx->fe_info.frequency_max = 858000000;
 		} else {
 			info("FREQ (%.2fMHz ... %.2fMHz)\n",
-			     fe_info.frequency_min / 1e6,
-			     fe_info.frequency_max / 1e6);
+			     ctx->fe_info.frequency_min / 1e6,
+			     ctx->fe_info.frequency_max / 1e6);
 		}
 		break;
 	case SCAN_CABLE:
 		//if (fe_info.caps & FE_CAN_2G_MODULATION) {
 		//  info("DVB-C2\n");
 		//  }
-		if (fe_info.caps & FE_CAN_INVERSION_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_INVERSION_AUTO) {
 			info("INVERSION_AUTO\n");
-			caps_inversion = INVERSION_AUTO;
+			ctx->caps_inversion = INVERSION_AUTO;
 		} else {
 			info("INVERSION_AUTO not supported, trying INVERSION_OFF.\n");
-			caps_inversion = INVERSION_OFF;
+			ctx->caps_inversion = INVERSION_OFF;
 		}
-		if (fe_info.caps & FE_CAN_QAM_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_QAM_AUTO) {
 			info("QAM_AUTO\n");
-			caps_qam = QAM_AUTO;
+			ctx->caps_qam = QAM_AUTO;
 		} else {
 			info("QAM_AUTO not supported, trying");
 			//print out modulations in the sequence they will be scanned.
-			for (i = modulation_min; i <= modulation_max; i++)
+			for (i = ctx->modulation_min; i <= ctx->modulation_max; i++)
 				info(" %s",
 				     modulation_name(dvbc_modulation(i)));
 			info(".\n");
-			caps_qam = QAM_64;
-			flags.qam_no_auto = 1;
+			ctx->caps_qam = QAM_64;
+			ctx->flags.qam_no_auto = 1;
 		}
-		if (fe_info.caps & FE_CAN_FEC_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_FEC_AUTO) {
 			info("FEC_AUTO\n");
-			caps_fec = FEC_AUTO;
+			ctx->caps_fec = FEC_AUTO;
 		} else {
 			info("FEC_AUTO not supported, trying FEC_NONE.\n");
-			caps_fec = FEC_NONE;
+			ctx->caps_fec = FEC_NONE;
 		}
-		if (fe_info.frequency_min == 0 || fe_info.frequency_max == 0) {
+		if (ctx->fe_info.frequency_min == 0 || ctx->fe_info.frequency_max == 0) {
 			info("This dvb driver is *buggy*: the frequency limits are undefined - please report to linuxtv.org\n");
-			fe_info.frequency_min = 177500000;
-			fe_info.frequency_max = 858000000;
+			ctx->fe_info.frequency_min = 177500000;
+			ctx->fe_info.frequency_max = 858000000;
 		} else {
 			info("FREQ (%.2fMHz ... %.2fMHz)\n",
-			     fe_info.frequency_min / 1e6,
-			     fe_info.frequency_max / 1e6);
+			     ctx->fe_info.frequency_min / 1e6,
+			     ctx->fe_info.frequency_max / 1e6);
 		}
-		if (fe_info.symbol_rate_min == 0
-		    || fe_info.symbol_rate_max == 0) {
+		if (ctx->fe_info.symbol_rate_min == 0
+		    || ctx->fe_info.symbol_rate_max == 0) {
 			info("This dvb driver is *buggy*: the symbol rate limits are undefined - please report to linuxtv.org\n");
-			fe_info.symbol_rate_min = 4000000;
-			fe_info.symbol_rate_max = 7000000;
+			ctx->fe_info.symbol_rate_min = 4000000;
+			ctx->fe_info.symbol_rate_max = 7000000;
 		} else {
 			info("SRATE (%.3fMSym/s ... %.3fMSym/s)\n",
-			     fe_info.symbol_rate_min / 1e6,
-			     fe_info.symbol_rate_max / 1e6);
+			     ctx->fe_info.symbol_rate_min / 1e6,
+			     ctx->fe_info.symbol_rate_max / 1e6);
 		}
 		break;
 	case SCAN_TERRCABLE_ATSC:
-		if (fe_info.caps & FE_CAN_INVERSION_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_INVERSION_AUTO) {
 			info("INVERSION_AUTO\n");
-			caps_inversion = INVERSION_AUTO;
+			ctx->caps_inversion = INVERSION_AUTO;
 		} else {
 			info("INVERSION_AUTO not supported, trying INVERSION_OFF.\n");
-			caps_inversion = INVERSION_OFF;
+			ctx->caps_inversion = INVERSION_OFF;
 		}
-		if (fe_info.caps & FE_CAN_8VSB) {
+		if (ctx->fe_info.caps & FE_CAN_8VSB) {
 			info("8VSB\n");
 		}
-		if (fe_info.caps & FE_CAN_16VSB) {
+		if (ctx->fe_info.caps & FE_CAN_16VSB) {
 			info("16VSB\n");
 		}
-		if (fe_info.caps & FE_CAN_QAM_64) {
+		if (ctx->fe_info.caps & FE_CAN_QAM_64) {
 			info("QAM_64\n");
 		}
-		if (fe_info.caps & FE_CAN_QAM_256) {
+		if (ctx->fe_info.caps & FE_CAN_QAM_256) {
 			info("QAM_256\n");
 		}
-		if (fe_info.frequency_min == 0 || fe_info.frequency_max == 0) {
+		if (ctx->fe_info.frequency_min == 0 || ctx->fe_info.frequency_max == 0) {
 			info("This dvb driver is *buggy*: the frequency limits are undefined - please report to linuxtv.org\n");
-			fe_info.frequency_min = 177500000;
-			fe_info.frequency_max = 858000000;
+			ctx->fe_info.frequency_min = 177500000;
+			ctx->fe_info.frequency_max = 858000000;
 		} else {
 			info("FREQ (%.2fMHz ... %.2fMHz)\n",
-			     fe_info.frequency_min / 1e6,
-			     fe_info.frequency_max / 1e6);
+			     ctx->fe_info.frequency_min / 1e6,
+			     ctx->fe_info.frequency_max / 1e6);
 		}
 		break;
 	case SCAN_SATELLITE:
-		if (fe_info.caps & FE_CAN_INVERSION_AUTO) {
+		if (ctx->fe_info.caps & FE_CAN_INVERSION_AUTO) {
 			info("INVERSION_AUTO\n");
-			caps_inversion = INVERSION_AUTO;
+			ctx->caps_inversion = INVERSION_AUTO;
 		}
-		if (fe_info.caps & FE_CAN_QPSK) {
+		if (ctx->fe_info.caps & FE_CAN_QPSK) {
 			info("DVB-S\n");
-			caps_inversion = INVERSION_AUTO;
+			ctx->caps_inversion = INVERSION_AUTO;
 		}
-		if (fe_info.caps & FE_CAN_2G_MODULATION) {
+		if (ctx->fe_info.caps & FE_CAN_2G_MODULATION) {
 			info("DVB-S2\n");
-			caps_inversion = INVERSION_AUTO;
+			ctx->caps_inversion = INVERSION_AUTO;
 		}
-		if (fe_info.frequency_min == 0 || fe_info.frequency_max == 0) {
+		if (ctx->fe_info.frequency_min == 0 || ctx->fe_info.frequency_max == 0) {
 			info("This dvb driver is *buggy*: the frequency limits are undefined - please report to linuxtv.org\n");
-			fe_info.frequency_min = 950000;
-			fe_info.frequency_max = 2150000;
+			ctx->fe_info.frequency_min = 950000;
+			ctx->fe_info.frequency_max = 2150000;
 		} else {
 			info("FREQ (%.2fGHz ... %.2fGHz)\n",
-			     fe_info.frequency_min / 1e6,
-			     fe_info.frequency_max / 1e6);
+			     ctx->fe_info.frequency_min / 1e6,
+			     ctx->fe_info.frequency_max / 1e6);
 		}
-		if (fe_info.symbol_rate_min == 0
-		    || fe_info.symbol_rate_max == 0) {
+		if (ctx->fe_info.symbol_rate_min == 0
+		    || ctx->fe_info.symbol_rate_max == 0) {
 			info("This dvb driver is *buggy*: the symbol rate limits are undefined - please report to linuxtv.org\n");
-			fe_info.symbol_rate_min = 1000000;
-			fe_info.symbol_rate_max = 45000000;
+			ctx->fe_info.symbol_rate_min = 1000000;
+			ctx->fe_info.symbol_rate_max = 45000000;
 		} else {
 			info("SRATE (%.3fMSym/s ... %.3fMSym/s)\n",
-			     fe_info.symbol_rate_min / 1e6,
-			     fe_info.symbol_rate_max / 1e6);
+			     ctx->fe_info.symbol_rate_min / 1e6,
+			     ctx->fe_info.symbol_rate_max / 1e6);
 		}
-		info("using LNB \"%s\"\n", this_lnb.name);
-		if (committed_switch > 0)
+		info("using LNB \"%s\"\n", ctx->this_lnb.name);
+		if (ctx->committed_switch > 0)
 			info("using DiSEqC committed switch %d\n",
-			     committed_switch);
-		if (uncommitted_switch > 0)
+			     ctx->committed_switch);
+		if (ctx->uncommitted_switch > 0)
 			info("using DiSEqC uncommitted switch %d\n",
-			     uncommitted_switch);
+			     ctx->uncommitted_switch);
 		// grrr...
 		// DVB API v5 doesnt allow checking for
 		// S2 capabilities fec3/5, fec9/10, PSK_8,
@@ -5003,18 +6848,95 @@ int main(int argc, char **argv)
 	}
 	info("-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_-_ \n");
 
-	if (!fe_supports_scan(frontend_fd, scantype, fe_info)
-	    && flags.api_version < 0x0505) {
+	if (!fe_supports_scan(frontend_fd, scantype, ctx->fe_info)
+	    && ctx->flags.api_version < 0x0505) {
 		cleanup();
 		fatal
 		    ("Frontend '%s' doesnt support your choosen scan type '%s'\n",
-		     fe_info.name, scantype_to_text(scantype));
+		     ctx->fe_info.name, scantype_to_text(scantype));
 	}
 
-	signal(SIGINT, handle_sigint);
-	network_scan(frontend_fd, valid_initial_data);
+	if (scantype == SCAN_SATELLITE)
+		ctx->tune_cost = sat_tune_cost;
+	else
+		ctx->tune_cost = freq_tune_cost;
+
+	if (ctx->flags.stream_output)
+		stream_open(adapter, frontend);
+	if (ctx->satellites_count > 0)
+		multi_satellite_scan(frontend_fd);
+	else if (ctx->scr_frontends_count > 0)
+		scr_parallel_scan(frontend_fd, valid_initial_data);
+	else
+		network_scan(frontend_fd, valid_initial_data);
+	if (!ctx->flags.emulate) {
+		struct warm_device w = {
+			.fd = frontend_fd,
+			.adapter = adapter,
+			.frontend = frontend,
+			.scantype = scantype,
+			.api_version = ctx->flags.api_version,
+			.fe_info = ctx->fe_info,
+			.rotor_pos = ctx->this_rotor_pos,
+		};
+		sec_state_export(w.sec_state);
+		daemon_job_done(&w);
+	}
 	close(frontend_fd);
+	if (ctx->interrupted) {
+		error("interrupted, dumping partial result...\n");
+		save_checkpoint(true);
+		dump_lists(adapter, frontend);
+		scr_collect_results();
+		if (ctx->si_cache)
+			si_cache_save(ctx->si_cache);
+		dead_cache_save(ctx->dead_cache);
+		cleanup();
+		return 2;
+	}
+	if (ctx->verify) {
+		// no PMTs read: a channel list would be incomplete.
+		uint32_t differences = verify_close(ctx->verify);
+
+		ctx->verify = NULL;
+		cleanup();
+		return differences ? 3 : 0;
+	}
 	dump_lists(adapter, frontend);
+	scr_collect_results();
+	if (ctx->diff_before)
+		changes = diff_scan(diffvdr);
+	if (ctx->checkpoint)	// complete, nothing to resume.
+		unlink(ctx->checkpoint);
+	if (ctx->si_cache)
+		si_cache_save(ctx->si_cache);
+	dead_cache_save(ctx->dead_cache);
 	cleanup();
-	return 0;
+	return changes ? 3 : 0;	// as --verify and 'w_scan2-db diff'.
+}
+
+int scan_run(struct scan_context *c, int argc, char **argv)
+{
+	struct option_parser p = {
+		.name = argv[0],
+		.argc = argc,
+		.argv = argv,
+		.index = 1,
+	};
+
+	return scan_main(c, &p);
+}
+
+int scan_run_options(struct scan_context *c, const struct scan_option *options,
+		     unsigned count)
+{
+	struct option_parser p = {
+		.name = PACKAGE_NAME,
+		.options = options,
+		.count = count,
+	};
+	int ret = scan_main(c, &p);
+
+	free(p.copy);
+	return ret;
 }
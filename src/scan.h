@@ -31,6 +31,7 @@
 #include "tools.h"
 #include "descriptors.h"
 #include "emulate.h"
+#include "w_scan2.h"
 
 /******************************************************************************
  * internal definitions.
@@ -58,6 +59,7 @@ struct w_scan_flags {
 	uint8_t emulate;
 	uint8_t delete_duplicate_transponders;
 	uint16_t delsys;
+	uint8_t stream_output;
 };
 
 struct service *find_service(struct transponder *t, uint16_t service_id);
@@ -0,0 +1,375 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <endian.h>
+#include "tools.h"
+#include "descriptors.h"
+#include "si-cache.h"
+
+/******************************************************************************
+ * file format, all integers little-endian:
+ *   header: magic[8], uint32 version, uint32 entry count
+ *   entry:  uint32 frequency, uint16 onid, uint16 tsid,
+ *           uint8 PAT, SDT and NIT version (0xFF == not seen), uint8 reserved,
+ *           uint32 section count, followed by the raw sections. The length of
+ *           a section is taken from its own header.
+ *****************************************************************************/
+
+static uint16_t section_len(const unsigned char *buf)
+{
+	return (((buf[1] & 0x0f) << 8) | buf[2]) + 3;
+}
+
+static void clear_entry(struct si_cache_entry *e)
+{
+	uint32_t i;
+
+	for (i = 0; i < e->count; i++)
+		free(e->sections[i]);
+	free(e->sections);
+	e->sections = NULL;
+	e->count = e->size = 0;
+	e->frequency = 0;
+	e->original_network_id = e->transport_stream_id = 0;
+	e->pat_version = e->sdt_version = e->nit_version = -1;
+}
+
+static void free_entries(pList list)
+{
+	struct si_cache_entry *e;
+
+	while ((e = list->first) != NULL) {
+		clear_entry(e);
+		UnlinkItem(list, e, true);
+	}
+}
+
+static void add_section(struct si_cache_entry *e, unsigned char *section)
+{
+	if (e->count == e->size) {
+		e->size = e->size ? 2 * e->size : 16;
+		e->sections = realloc(e->sections, e->size * sizeof(*e->sections));
+		if (e->sections == NULL)
+			fatal("out of memory\n");
+	}
+	e->sections[e->count++] = section;
+}
+
+static uint8_t version_byte(int v)
+{
+	return v < 0 ? 0xFF : v;
+}
+
+static int version_int(uint8_t v)
+{
+	return v == 0xFF ? -1 : v;
+}
+
+static bool read_entry(FILE *f, struct si_cache_entry *e)
+{
+	struct {
+		uint32_t frequency;
+		uint16_t original_network_id;
+		uint16_t transport_stream_id;
+		uint8_t version[4];
+		uint32_t count;
+	} h;
+	uint32_t i;
+
+	if (fread(&h, sizeof(h), 1, f) != 1)
+		return false;
+	e->frequency = le32toh(h.frequency);
+	e->original_network_id = le16toh(h.original_network_id);
+	e->transport_stream_id = le16toh(h.transport_stream_id);
+	e->pat_version = version_int(h.version[0]);
+	e->sdt_version = version_int(h.version[1]);
+	e->nit_version = version_int(h.version[2]);
+	h.count = le32toh(h.count);
+
+	for (i = 0; i < h.count; i++) {
+		unsigned char head[3], *section;
+		uint16_t len;
+
+		if (fread(head, sizeof(head), 1, f) != 1)
+			return false;
+		len = section_len(head);
+		section = malloc(len);
+		if (section == NULL)
+			fatal("out of memory\n");
+		memcpy(section, head, sizeof(head));
+		if (fread(section + 3, len - 3, 1, f) != 1) {
+			free(section);
+			return false;
+		}
+		add_section(e, section);
+	}
+	return true;
+}
+
+static bool write_entry(FILE *f, struct si_cache_entry *e)
+{
+	struct {
+		uint32_t frequency;
+		uint16_t original_network_id;
+		uint16_t transport_stream_id;
+		uint8_t version[4];
+		uint32_t count;
+	} h;
+	uint32_t i;
+
+	h.frequency = htole32(e->frequency);
+	h.original_network_id = htole16(e->original_network_id);
+	h.transport_stream_id = htole16(e->transport_stream_id);
+	h.version[0] = version_byte(e->pat_version);
+	h.version[1] = version_byte(e->sdt_version);
+	h.version[2] = version_byte(e->nit_version);
+	h.version[3] = 0;
+	h.count = htole32(e->count);
+
+	if (fwrite(&h, sizeof(h), 1, f) != 1)
+		return false;
+	for (i = 0; i < e->count; i++)
+		if (fwrite(e->sections[i], section_len(e->sections[i]), 1, f) != 1)
+			return false;
+	return true;
+}
+
+/* a missing or unreadable file gives an empty cache. */
+struct si_cache *si_cache_load(const char *file)
+{
+	struct si_cache *c = calloc(1, sizeof(*c));
+	char magic[8];
+	uint32_t version, count, i;
+	FILE *f;
+
+	if (c == NULL)
+		fatal("out of memory\n");
+	c->file = strdup(file);
+	c->entries = &c->_entries;
+	NewList(c->entries, "si_cache");
+	clear_entry(&c->current);
+
+	if ((f = fopen(file, "r")) == NULL) {
+		if (errno != ENOENT)
+			warning("could not open SI cache %s: %s\n", file,
+				strerror(errno));
+		return c;
+	}
+	if ((fread(magic, sizeof(magic), 1, f) != 1) ||
+	    memcmp(magic, SI_CACHE_MAGIC, sizeof(magic)) ||
+	    (fread(&version, sizeof(version), 1, f) != 1) ||
+	    (le32toh(version) != SI_CACHE_VERSION) ||
+	    (fread(&count, sizeof(count), 1, f) != 1)) {
+		warning("%s: not a SI cache (version %d), ignored.\n", file,
+			SI_CACHE_VERSION);
+		fclose(f);
+		return c;
+	}
+	count = le32toh(count);
+	for (i = 0; i < count; i++) {
+		struct si_cache_entry *e = calloc(1, sizeof(*e));
+
+		if (e == NULL)
+			fatal("out of memory\n");
+		if (!read_entry(f, e)) {
+			warning("%s: truncated after %u transponders.\n", file,
+				i);
+			clear_entry(e);
+			free(e);
+			break;
+		}
+		AddItem(c->entries, e);
+	}
+	fclose(f);
+	verbose("SI cache %s: %u transponders\n", file, c->entries->count);
+	return c;
+}
+
+/* written to <file>.tmp and renamed, an interrupted write keeps the old one. */
+void si_cache_save(struct si_cache *c)
+{
+	struct si_cache_entry *e;
+	char tmp[strlen(c->file) + 5];
+	uint32_t v;
+	bool ok;
+	FILE *f;
+
+	sprintf(tmp, "%s.tmp", c->file);
+	if ((f = fopen(tmp, "w")) == NULL) {
+		warning("could not write SI cache %s: %s\n", tmp,
+			strerror(errno));
+		return;
+	}
+	ok = fwrite(SI_CACHE_MAGIC, 8, 1, f) == 1;
+	v = htole32(SI_CACHE_VERSION);
+	ok = ok && fwrite(&v, sizeof(v), 1, f) == 1;
+	v = htole32(c->entries->count);
+	ok = ok && fwrite(&v, sizeof(v), 1, f) == 1;
+	for (e = c->entries->first; ok && e; e = e->next)
+		ok = write_entry(f, e);
+	if (fclose(f) != 0)
+		ok = false;
+	if (!ok || rename(tmp, c->file) != 0) {
+		warning("could not write SI cache %s: %s\n", c->file,
+			strerror(errno));
+		unlink(tmp);
+	}
+}
+
+void si_cache_free(struct si_cache *c)
+{
+	if (c == NULL)
+		return;
+	free_entries(c->entries);
+	clear_entry(&c->current);
+	free(c->file);
+	free(c);
+}
+
+void si_cache_begin(struct si_cache *c, uint32_t frequency, uint32_t tolerance)
+{
+	clear_entry(&c->current);
+	c->current.frequency = frequency;
+	c->tolerance = tolerance;
+}
+
+/* called once per section number and table, before parsing it. */
+void si_cache_section(struct si_cache *c, const unsigned char *buf)
+{
+	struct si_cache_entry *e = &c->current;
+	uint8_t table_id = buf[0];
+	uint16_t table_id_ext = (buf[3] << 8) | buf[4];
+	int version = (buf[5] >> 1) & 0x1f;
+	uint16_t len = section_len(buf);
+	unsigned char *section;
+	uint32_t i;
+
+	switch (table_id) {
+	case TABLE_PAT:
+		e->pat_version = version;
+		e->transport_stream_id = table_id_ext;
+		break;
+	case TABLE_SDT_ACT:
+		e->sdt_version = version;
+		e->original_network_id = (buf[8] << 8) | buf[9];
+		break;
+	case TABLE_NIT_ACT:
+		e->nit_version = version;
+		break;
+	case TABLE_PMT:
+	case TABLE_NIT_OTH:
+		break;
+	default:
+		return;
+	}
+
+	if ((section = malloc(len)) == NULL)
+		fatal("out of memory\n");
+	memcpy(section, buf, len);
+
+	/* a section read again, maybe with a new version: replace it. */
+	for (i = 0; i < e->count; i++) {
+		const unsigned char *p = e->sections[i];
+		if ((p[0] == buf[0]) && (p[3] == buf[3]) && (p[4] == buf[4])
+		    && (p[6] == buf[6])) {
+			free(e->sections[i]);
+			e->sections[i] = section;
+			return;
+		}
+	}
+	add_section(e, section);
+}
+
+static bool same_transponder(struct si_cache *c, struct si_cache_entry *e)
+{
+	uint32_t f1 = e->frequency;
+	uint32_t f2 = c->current.frequency;
+
+	if (e->transport_stream_id != c->current.transport_stream_id)
+		return false;
+	return (f1 > f2 ? f1 - f2 : f2 - f1) < c->tolerance;
+}
+
+/* is there anything cached for the PAT read so far? */
+bool si_cache_known(struct si_cache *c)
+{
+	struct si_cache_entry *e;
+
+	if (c->current.pat_version < 0)
+		return false;
+	for (e = c->entries->first; e; e = e->next)
+		if (same_transponder(c, e))
+			return true;
+	return false;
+}
+
+/* returns the cached transponder, if all versions seen are unchanged. */
+struct si_cache_entry *si_cache_match(struct si_cache *c)
+{
+	struct si_cache_entry *e;
+
+	for (e = c->entries->first; e; e = e->next) {
+		if (!same_transponder(c, e) ||
+		    (e->original_network_id != c->current.original_network_id))
+			continue;
+		if ((e->pat_version == c->current.pat_version) &&
+		    (e->sdt_version == c->current.sdt_version) &&
+		    (e->nit_version == c->current.nit_version) &&
+		    (e->pat_version >= 0))
+			return e;
+		return NULL;
+	}
+	return NULL;
+}
+
+/* store the sections read, replacing an older entry of the same transponder. */
+void si_cache_commit(struct si_cache *c)
+{
+	struct si_cache_entry *e;
+
+	if (c->current.pat_version < 0)
+		return;
+	for (e = c->entries->first; e; e = e->next)
+		if (same_transponder(c, e) &&
+		    (e->original_network_id == c->current.original_network_id))
+			break;
+	if (e == NULL) {
+		if ((e = calloc(1, sizeof(*e))) == NULL)
+			fatal("out of memory\n");
+		AddItem(c->entries, e);
+	} else
+		clear_entry(e);
+
+	e->frequency = c->current.frequency;
+	e->original_network_id = c->current.original_network_id;
+	e->transport_stream_id = c->current.transport_stream_id;
+	e->pat_version = c->current.pat_version;
+	e->sdt_version = c->current.sdt_version;
+	e->nit_version = c->current.nit_version;
+	e->count = c->current.count;
+	e->size = c->current.size;
+	e->sections = c->current.sections;
+	c->current.sections = NULL;
+	c->current.count = c->current.size = 0;
+}
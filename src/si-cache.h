@@ -0,0 +1,75 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __SI_CACHE_H__
+#define __SI_CACHE_H__
+
+#include <stdint.h>
+#include "list.h"
+
+/******************************************************************************
+ * SI version cache, read and written by '--si-cache <file>'.
+ *
+ * Keeps the raw PAT, PMT, NIT and SDT(actual) sections of every scanned
+ * transponder, keyed by (original_network_id, transport_stream_id) and
+ * frequency. A rescan reads only the first PAT, SDT(actual) and NIT(actual)
+ * section of a transponder; if their version numbers are unchanged, the
+ * cached sections are parsed instead of reading the tables again.
+ *****************************************************************************/
+
+#define SI_CACHE_MAGIC    "W2SICACH"
+#define SI_CACHE_VERSION  1
+
+struct si_cache_entry {
+	void *prev;
+	void *next;
+	uint32_t index;
+	uint32_t frequency;
+	uint16_t original_network_id;
+	uint16_t transport_stream_id;
+	int pat_version;	// -1 == not seen
+	int sdt_version;
+	int nit_version;
+	uint32_t count;		// number of sections
+	uint32_t size;		// allocated size of sections
+	unsigned char **sections;	// raw, including header and CRC
+};
+
+struct si_cache {
+	char *file;
+	cList _entries, *entries;
+	struct si_cache_entry current;	// transponder being scanned.
+	uint32_t tolerance;	// same transponder, if frequencies differ less.
+};
+
+struct si_cache *si_cache_load(const char *file);
+void si_cache_save(struct si_cache *c);
+void si_cache_free(struct si_cache *c);
+
+/* scanning one transponder: si_cache_begin(), si_cache_section() for every
+ * valid section. Afterwards the versions seen so far are compared by
+ * si_cache_match(); si_cache_commit() stores what was read.
+ */
+void si_cache_begin(struct si_cache *c, uint32_t frequency, uint32_t tolerance);
+void si_cache_section(struct si_cache *c, const unsigned char *buf);
+bool si_cache_known(struct si_cache *c);
+struct si_cache_entry *si_cache_match(struct si_cache *c);
+void si_cache_commit(struct si_cache *c);
+
+#endif
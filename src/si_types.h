@@ -23,8 +23,9 @@
 #define __SI_TYPES_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "descriptors.h"
-#include "tools.h"
+#include "list.h"
 
 /*******************************************************************************
 /* section buffer
@@ -33,6 +34,8 @@
 #define SECTION_FLAG_DEFAULT  (1U) << 0
 #define SECTION_FLAG_INITIAL  (1U) << 1
 #define SECTION_FLAG_FREE     (1U) << 2
+#define SECTION_FLAG_PROBE    (1U) << 3
+#define SECTION_FLAG_MONITOR  (1U) << 4
 #define SECTION_BUF_SIZE      4096
 
 typedef struct section_buf {
@@ -70,7 +73,7 @@ typedef struct section_buf {
 #define SUBTITLES_MAX     (32)
 
 struct transponder;
-struct service {
+typedef struct service {
   /*----------------------------*/
 	void *prev;
 	void *next;
@@ -137,7 +140,7 @@ struct cell {
 	struct transposer transposers[16];
 };
 
-struct transponder {
+typedef struct transponder {
   /*----------------------------*/
 	void *prev;
 	void *next;
@@ -194,11 +197,29 @@ struct transponder {
 	uint16_t network_id;
 	uint16_t original_network_id;
 	uint16_t transport_stream_id;
+	uint16_t list_id;	// satellite (sat_list index), if scanning multiple satellites
+	uint8_t streamed;	// already written by streaming output
+	uint8_t found_here;	// '--shard': found by our part of the initial scan
+	uint8_t other_shard;	// '--shard': not scanned, left to shard n (1..)
   /*----------------------------*/
 	char *network_name;
 	network_change_t network_change;
 } __attribute__ ((packed)) transponder_t, *p_transponder_t;
 
+/* sets up the empty service and cell lists of t. The lists are members of a
+ * packed struct; their address is taken via offsetof() to avoid
+ * -Waddress-of-packed-member.
+ */
+static inline void init_transponder_lists(struct transponder *t)
+{
+	char *p = (char *)t;
+
+	t->services = (pList) (p + offsetof(struct transponder, _services));
+	t->cells = (pList) (p + offsetof(struct transponder, _cells));
+	NewList(t->services, "services");
+	NewList(t->cells, "cells");
+}
+
 /*******************************************************************************
 /* satellite channel routing type.
  ******************************************************************************/
@@ -0,0 +1,333 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "scan.h"
+#include "tools.h"
+#include "descriptors.h"
+#include "stats.h"
+
+/******************************************************************************
+ * one record per tuning attempt. Times are seconds since stats_tune();
+ * table times since lock, so that they show where the time on a transponder
+ * goes. Written as JSON, or as Prometheus textfile if the file name ends
+ * with '.prom'.
+ *****************************************************************************/
+
+enum __stats_table {
+	STATS_PAT,
+	STATS_PMT,
+	STATS_NIT,
+	STATS_SDT,
+	STATS_VCT,
+	STATS_NUM_TABLES
+};
+
+static const char *const table_names[STATS_NUM_TABLES] =
+    { "PAT", "PMT", "NIT", "SDT", "VCT" };
+
+static const char *const event_names[STATS_NUM_EVENTS] =
+    { "switch", "tuned", "carrier", "lock" };
+
+struct table_stats {
+	double first_section;	// < 0: none
+	double complete;	// < 0: not (yet) complete
+	uint32_t sections;
+	uint32_t crc_errors;
+	uint32_t timeouts;
+};
+
+struct tp_stats {
+	struct tp_stats *prev;
+	struct tp_stats *next;
+	uint32_t index;
+	uint32_t frequency;
+	uint8_t polarization;
+	uint8_t delsys;
+	struct timespec start;
+	double event[STATS_NUM_EVENTS];	// < 0: not reached
+	struct table_stats table[STATS_NUM_TABLES];
+};
+
+// per scan thread, as the scan_context in scan.c.
+static __thread char *stats_file = NULL;
+static __thread cList _stats_list, *stats_list = NULL;
+static __thread struct tp_stats *current = NULL;
+static __thread struct timespec scan_start;
+
+static void now(struct timespec *ts)
+{
+	clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+static double since(const struct timespec *from)
+{
+	struct timespec ts;
+
+	now(&ts);
+	return (ts.tv_sec - from->tv_sec) + (ts.tv_nsec - from->tv_nsec) / 1e9;
+}
+
+static int table_index(int table_id)
+{
+	switch (table_id) {
+	case TABLE_PAT:
+		return STATS_PAT;
+	case TABLE_PMT:
+		return STATS_PMT;
+	case TABLE_NIT_ACT:
+	case TABLE_NIT_OTH:
+		return STATS_NIT;
+	case TABLE_SDT_ACT:
+	case TABLE_SDT_OTH:
+		return STATS_SDT;
+	case TABLE_VCT_TERR:
+	case TABLE_VCT_CABLE:
+		return STATS_VCT;
+	default:
+		return -1;
+	}
+}
+
+/* table times are relative to lock; data without lock counts from tuning. */
+static double table_time(void)
+{
+	double t = since(&current->start);
+
+	if (current->event[STATS_LOCK] >= 0)
+		t -= current->event[STATS_LOCK];
+	return t;
+}
+
+static struct table_stats *table_of(int table_id)
+{
+	int i;
+
+	if ((current == NULL) || ((i = table_index(table_id)) < 0))
+		return NULL;
+	return &current->table[i];
+}
+
+void stats_open(const char *file)
+{
+	stats_file = strdup(file);
+	stats_list = &_stats_list;
+	NewList(stats_list, "stats_list");
+	now(&scan_start);
+}
+
+void stats_close(void)
+{
+	if (stats_file == NULL)
+		return;
+	ClearList(stats_list);
+	free(stats_file);
+	stats_file = NULL;
+	current = NULL;
+}
+
+void stats_tune(struct transponder *t)
+{
+	int i;
+
+	if (stats_file == NULL)
+		return;
+	current = calloc(1, sizeof(*current));
+	if (current == NULL)
+		fatal("out of memory\n");
+	current->frequency = t->frequency;
+	current->polarization = t->polarization;
+	current->delsys = t->delsys;
+	for (i = 0; i < STATS_NUM_EVENTS; i++)
+		current->event[i] = -1;
+	for (i = 0; i < STATS_NUM_TABLES; i++) {
+		current->table[i].first_section = -1;
+		current->table[i].complete = -1;
+	}
+	now(&current->start);
+	AddItem(stats_list, current);
+}
+
+void stats_event(enum __stats_event e)
+{
+	if (current == NULL)
+		return;
+	current->event[e] = since(&current->start);
+}
+
+void stats_section(int table_id)
+{
+	struct table_stats *ts = table_of(table_id);
+
+	if (ts == NULL)
+		return;
+	if (ts->sections++ == 0)
+		ts->first_section = table_time();
+}
+
+void stats_crc_error(int table_id)
+{
+	struct table_stats *ts = table_of(table_id);
+
+	if (ts)
+		ts->crc_errors++;
+}
+
+void stats_filter_done(int table_id)
+{
+	struct table_stats *ts = table_of(table_id);
+
+	if (ts)
+		ts->complete = table_time();	// last one, i.e. all PMTs.
+}
+
+void stats_filter_timeout(int table_id)
+{
+	struct table_stats *ts = table_of(table_id);
+
+	if (ts)
+		ts->timeouts++;
+}
+
+static void write_json(FILE * f)
+{
+	struct tp_stats *s;
+	int i;
+
+	fprintf(f, "{\n  \"version\": 1,\n");
+	fprintf(f, "  \"scan_time\": %.3f,\n", since(&scan_start));
+	fprintf(f, "  \"transponders\": [");
+	for (s = stats_list->first; s; s = s->next) {
+		fprintf(f, "%s\n    {\"frequency\": %u, \"polarization\": %u, "
+			"\"delsys\": \"%s\"", s == stats_list->first ? "" : ",",
+			s->frequency, s->polarization,
+			delivery_system_name(s->delsys));
+		for (i = 0; i < STATS_NUM_EVENTS; i++) {
+			if (s->event[i] >= 0)
+				fprintf(f, ", \"%s\": %.3f", event_names[i],
+					s->event[i]);
+			else
+				fprintf(f, ", \"%s\": null", event_names[i]);
+		}
+		fprintf(f, ",\n     \"tables\": {");
+		for (i = 0; i < STATS_NUM_TABLES; i++) {
+			struct table_stats *ts = &s->table[i];
+			fprintf(f, "%s\"%s\": {\"sections\": %u, "
+				"\"crc_errors\": %u, \"timeouts\": %u",
+				i ? ", " : "", table_names[i], ts->sections,
+				ts->crc_errors, ts->timeouts);
+			if (ts->first_section >= 0)
+				fprintf(f, ", \"first_section\": %.3f",
+					ts->first_section);
+			if (ts->complete >= 0)
+				fprintf(f, ", \"complete\": %.3f",
+					ts->complete);
+			fprintf(f, "}");
+		}
+		fprintf(f, "}}");
+	}
+	fprintf(f, "\n  ]\n}\n");
+}
+
+static void write_prometheus(FILE * f)
+{
+	struct tp_stats *s;
+	double event_sum[STATS_NUM_EVENTS] = { 0 };
+	uint32_t event_count[STATS_NUM_EVENTS] = { 0 };
+	struct table_stats sum[STATS_NUM_TABLES];
+	uint32_t complete_count[STATS_NUM_TABLES] = { 0 };
+	int i;
+
+	memset(sum, 0, sizeof(sum));
+	for (s = stats_list->first; s; s = s->next) {
+		for (i = 0; i < STATS_NUM_EVENTS; i++) {
+			if (s->event[i] < 0)
+				continue;
+			event_sum[i] += s->event[i];
+			event_count[i]++;
+		}
+		for (i = 0; i < STATS_NUM_TABLES; i++) {
+			sum[i].sections += s->table[i].sections;
+			sum[i].crc_errors += s->table[i].crc_errors;
+			sum[i].timeouts += s->table[i].timeouts;
+			if (s->table[i].complete >= 0) {
+				sum[i].complete += s->table[i].complete;
+				complete_count[i]++;
+			}
+		}
+	}
+
+	fprintf(f, "# HELP w_scan2_scan_seconds total scan time.\n");
+	fprintf(f, "# TYPE w_scan2_scan_seconds gauge\n");
+	fprintf(f, "w_scan2_scan_seconds %.3f\n", since(&scan_start));
+	fprintf(f, "# HELP w_scan2_tune_attempts_total tuning attempts.\n");
+	fprintf(f, "# TYPE w_scan2_tune_attempts_total counter\n");
+	fprintf(f, "w_scan2_tune_attempts_total %u\n", stats_list->count);
+	fprintf(f, "# HELP w_scan2_phase_seconds time from tuning start until phase.\n");
+	fprintf(f, "# TYPE w_scan2_phase_seconds summary\n");
+	for (i = 0; i < STATS_NUM_EVENTS; i++) {
+		fprintf(f, "w_scan2_phase_seconds_sum{phase=\"%s\"} %.3f\n",
+			event_names[i], event_sum[i]);
+		fprintf(f, "w_scan2_phase_seconds_count{phase=\"%s\"} %u\n",
+			event_names[i], event_count[i]);
+	}
+	fprintf(f, "# HELP w_scan2_table_complete_seconds time from lock until table complete.\n");
+	fprintf(f, "# TYPE w_scan2_table_complete_seconds summary\n");
+	for (i = 0; i < STATS_NUM_TABLES; i++) {
+		fprintf(f, "w_scan2_table_complete_seconds_sum{table=\"%s\"} %.3f\n",
+			table_names[i], sum[i].complete);
+		fprintf(f, "w_scan2_table_complete_seconds_count{table=\"%s\"} %u\n",
+			table_names[i], complete_count[i]);
+	}
+	fprintf(f, "# TYPE w_scan2_sections_total counter\n");
+	for (i = 0; i < STATS_NUM_TABLES; i++)
+		fprintf(f, "w_scan2_sections_total{table=\"%s\"} %u\n",
+			table_names[i], sum[i].sections);
+	fprintf(f, "# TYPE w_scan2_crc_errors_total counter\n");
+	for (i = 0; i < STATS_NUM_TABLES; i++)
+		fprintf(f, "w_scan2_crc_errors_total{table=\"%s\"} %u\n",
+			table_names[i], sum[i].crc_errors);
+	fprintf(f, "# TYPE w_scan2_filter_timeouts_total counter\n");
+	for (i = 0; i < STATS_NUM_TABLES; i++)
+		fprintf(f, "w_scan2_filter_timeouts_total{table=\"%s\"} %u\n",
+			table_names[i], sum[i].timeouts);
+}
+
+void stats_write(void)
+{
+	size_t len;
+	FILE *f;
+
+	if (stats_file == NULL)
+		return;
+	if ((f = fopen(stats_file, "w")) == NULL) {
+		warning("could not write stats to '%s'\n", stats_file);
+		return;
+	}
+	len = strlen(stats_file);
+	if ((len > 5) && !strcmp(stats_file + len - 5, ".prom"))
+		write_prometheus(f);
+	else
+		write_json(f);
+	fclose(f);
+	info("scan statistics written to '%s'\n", stats_file);
+}
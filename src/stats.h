@@ -0,0 +1,52 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stdint.h>
+#include "si_types.h"
+
+/******************************************************************************
+ * scan phase timing, written by '--stats <file>'.
+ * All hooks are no-ops unless stats_open() was called.
+ *****************************************************************************/
+
+enum __stats_event {
+	STATS_SWITCH,		// DiSEqC, switch, SCR and rotor done
+	STATS_TUNED,		// frontend parameters set
+	STATS_CARRIER,		// FE_HAS_SIGNAL or FE_HAS_CARRIER
+	STATS_LOCK,		// FE_HAS_LOCK
+	STATS_NUM_EVENTS
+};
+
+void stats_open(const char *file);
+void stats_close(void);
+void stats_write(void);
+
+void stats_tune(struct transponder *t);
+void stats_event(enum __stats_event e);
+
+/* per table: sections, CRC failures, filters done or timed out. */
+void stats_section(int table_id);
+void stats_crc_error(int table_id);
+void stats_filter_done(int table_id);
+void stats_filter_timeout(int table_id);
+
+#endif
@@ -29,7 +29,7 @@
 /*******************************************************************************
 /* common typedefs && logging.
  ******************************************************************************/
-int verbosity = 2;		// need signed -> use of fatal()
+__thread int verbosity = 2;		// need signed -> use of fatal()
 
 /*******************************************************************************
  * new implementation of double linked list since 20140118.
@@ -81,6 +81,7 @@ void NewList(pList const list, const char *name)
 	list->first = NULL;
 	list->last = NULL;
 	list->count = 0;
+	list->lock = false;
 	list->name = calloc(1, strlen(name) + 1);
 	sprintf(list->name, "%s", name);
 	report(list);
@@ -408,7 +409,7 @@ int timeout_expired(struct timespec *src)
 /*******************************************************************************
 /* debug helpers.
  ******************************************************************************/
-struct timespec starttime = { 0, 0 };
+static __thread struct timespec starttime = { 0, 0 };
 
 void run_time_init()
 {
@@ -417,7 +418,7 @@ void run_time_init()
 
 const char *run_time()
 {
-	static char rtbuf[12];
+	static __thread char rtbuf[12];
 	struct timespec now;
 	double t;
 	int sec, msec;
@@ -430,46 +431,47 @@ const char *run_time()
 	return &rtbuf[0];
 }
 
+/* one log_write() per line; byte by byte info() was far too slow at -vvvv. */
 void hexdump(const char *intro, const unsigned char *buf, int len)
 {
-	int i, j;
-	char sbuf[17];
+	static const char hex[] = "0123456789ABCDEF";
+	char line[128];
+	int i, j, n;
 
 	if (verbosity < 4)
 		return;
 
-	memset(&sbuf, 0, 17);
-
-	info("\t===================== %s ", intro);
-	for (i = strlen(intro) + 1; i < 50; i++)
-		info("=");
-	info("\n");
+	n = snprintf(line, sizeof(line), "\t===================== %s ", intro);
+	if ((n < 0) || (n > (int)sizeof(line) - 2))	// long intro: truncated.
+		n = n < 0 ? 0 : sizeof(line) - 2;
+	for (i = strlen(intro) + 1; (i < 50) && (n < (int)sizeof(line) - 2); i++)
+		line[n++] = '=';
+	line[n++] = '\n';
+	log_write(line, n);
 	info("\tlen = %d\n", len);
-	for (i = 0; i < len; i++) {
-		if ((i % 16) == 0) {
-			info("%s0x%.2X: ", i ? "\n\t" : "\t", (i / 16) * 16);
-		}
-		info("%.2X ", (uint8_t) * (buf + i));
-		sbuf[i % 16] = *(buf + i);
-		if (((i + 1) % 16) == 0) {
-			// remove non-printable chars
-			for (j = 0; j < 16; j++)
-				if (!((sbuf[j] > 31) && (sbuf[j] < 127)))
-					sbuf[j] = ' ';
-
-			info(": %s", sbuf);
-			memset(&sbuf, 0, 17);
+
+	for (i = 0; i < len; i += 16) {
+		n = snprintf(line, sizeof(line), "\t0x%.2X: ", i);
+		for (j = i; j < i + 16; j++) {
+			if (j < len) {
+				line[n++] = hex[buf[j] >> 4];
+				line[n++] = hex[buf[j] & 0xF];
+			} else {
+				line[n++] = ' ';
+				line[n++] = ' ';
+			}
+			line[n++] = ' ';
 		}
+		line[n++] = ':';
+		line[n++] = ' ';
+		// remove non-printable chars
+		for (j = i; (j < i + 16) && (j < len); j++)
+			line[n++] = ((buf[j] > 31) && (buf[j] < 127)) ? buf[j] : ' ';
+		line[n++] = '\n';
+		log_write(line, n);
 	}
-	if (len % 16) {
-		for (i = 0; i < (len % 16); i++)
-			if (!((sbuf[i] > 31) && (sbuf[i] < 127)))
-				sbuf[i] = ' ';
-		for (i = (len % 16); i < 16; i++)
-			info("   ");
-		info(": %s", sbuf);
-	}
-	info("\n");
+	if (len == 0)
+		info("\n");
 	info("\t========================================================================\n");
 }
 
@@ -23,29 +23,32 @@
 #define _TOOLS_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>		// link with -lrt
+#include "list.h"
 
 /*******************************************************************************
 /* common typedefs && logging.
  ******************************************************************************/
-#ifndef bool
-typedef int bool;
-#define false 0
-#define true  !(false)
-#endif
-
 #define min(a,b)  (b<a?b:a)
 #define max(a,b)  (b>a?b:a)
 #define diff(a,b) (a>b?(a-b):(b-a))
 
 #define range(x,low,high) ((x>=low) && (x<=high))
 
-extern int verbosity;
+extern __thread int verbosity;	// per scan thread, see scan_context_use()
+
+/* async logging to stderr, see log.c */
+void log_init(void);
+void log_write(const char *buf, size_t len);
+void log_printf(const char *fmt, ...) __attribute__ ((format(printf, 1, 2)));
+void log_flush(void);
+void log_sync(void);
 
 #define dprintf(level, fmt...)   \
    do {                          \
       if (level <= verbosity) {  \
-         fprintf(stderr, fmt); } \
+         log_printf(fmt); }      \
    } while (0)
 
 #define dpprintf(level, fmt, args...) \
@@ -92,38 +95,6 @@ uint32_t freq_scale(uint32_t freq, double scale);
 const char *alpha_name(int alpha);	/* somehow missing. */
 const char *interleaver_name(int i);	/* somehow missing. */
 
-/*******************************************************************************
-/* double linked list.
- ******************************************************************************/
-
-typedef int (*cmp_func) (void *a, void *b);
-typedef bool(*fnd_func) (void *a);
-
-typedef struct {
-	void *first;
-	void *last;
-	uint32_t count;
-	char *name;
-	bool lock;
-} cList, *pList;
-
-typedef struct {
-	void *prev;
-	void *next;
-	uint32_t index;
-} cItem, *pItem;
-
-void NewList(pList const list, const char *name);
-void ClearList(pList list);
-void SortList(pList list, cmp_func compare);
-void AddItem(pList list, void *item);
-void DeleteItem(pList list, void *item);
-void SwapItem(pList list, pItem a, pItem b);
-void UnlinkItem(pList list, void *item, bool freemem);
-void InsertItem(pList list, void *item, uint32_t index);
-void *GetItem(pList list, uint32_t index);
-bool IsMember(pList list, void *item);
-
 /*******************************************************************************
 /* fuzzy bit error recovery.
  ******************************************************************************/
@@ -0,0 +1,152 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "tools.h"
+#include "descriptors.h"
+#include "trace.h"
+
+/******************************************************************************
+ * every event is one write() to a file opened with O_APPEND, so events of
+ * parallel scan processes (--scr-frontend) don't mix and the file is usable
+ * after SIGINT. The JSON array is never closed, which the trace event format
+ * explicitly allows.
+ *****************************************************************************/
+
+static __thread int trace_fd = -1;	// per scan thread
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static const char *table_name(int table_id)
+{
+	switch (table_id) {
+	case TABLE_PAT:
+		return "PAT";
+	case TABLE_PMT:
+		return "PMT";
+	case TABLE_NIT_ACT:
+		return "NIT(actual)";
+	case TABLE_NIT_OTH:
+		return "NIT(other)";
+	case TABLE_SDT_ACT:
+		return "SDT(actual)";
+	case TABLE_SDT_OTH:
+		return "SDT(other)";
+	case TABLE_VCT_TERR:
+	case TABLE_VCT_CABLE:
+		return "VCT";
+	default:
+		return "table";
+	}
+}
+
+static int print_args(char *buf, size_t size, int fd, int pid, int table_id,
+		      uint32_t frequency)
+{
+	int len = snprintf(buf, size, "\"frequency\":%u", frequency);
+
+	if (fd >= 0)
+		len += snprintf(buf + len, size - len, ",\"fd\":%d", fd);
+	if (pid >= 0)
+		len += snprintf(buf + len, size - len, ",\"pid\":%d", pid);
+	if (table_id >= 0)
+		len += snprintf(buf + len, size - len,
+				",\"table_id\":\"0x%02x\"", table_id);
+	return len;
+}
+
+static void emit(const char *buf, int len)
+{
+	if (write(trace_fd, buf, len) != len) {
+		warning("could not write trace, stopped.\n");
+		close(trace_fd);
+		trace_fd = -1;
+	}
+}
+
+void trace_open(const char *file)
+{
+	trace_fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+	if (trace_fd < 0)
+		fatal("could not open trace file '%s'\n", file);
+	emit("[\n", 2);
+}
+
+uint64_t trace_begin(void)
+{
+	if (trace_fd < 0)
+		return 0;
+	return now_us();
+}
+
+void trace_end(uint64_t begin, const char *name, int fd, int pid,
+	       int table_id, uint32_t frequency)
+{
+	char buf[256], args[128];
+
+	if ((trace_fd < 0) || (begin == 0))
+		return;
+	print_args(args, sizeof(args), fd, pid, table_id, frequency);
+	emit(buf, snprintf(buf, sizeof(buf),
+			   "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%llu,"
+			   "\"dur\":%llu,\"pid\":%d,\"tid\":0,\"args\":{%s}},\n",
+			   name, (unsigned long long)begin,
+			   (unsigned long long)(now_us() - begin), getpid(),
+			   args));
+}
+
+void trace_filter(bool start, const void *id, int fd, int pid, int table_id,
+		  uint32_t frequency)
+{
+	char buf[256], args[128];
+
+	if (trace_fd < 0)
+		return;
+	print_args(args, sizeof(args), fd, pid, table_id, frequency);
+	emit(buf, snprintf(buf, sizeof(buf),
+			   "{\"name\":\"%s\",\"cat\":\"filter\",\"ph\":\"%c\","
+			   "\"id\":\"%p\",\"ts\":%llu,\"pid\":%d,\"tid\":0,"
+			   "\"args\":{%s}},\n", table_name(table_id),
+			   start ? 'b' : 'e', id, (unsigned long long)now_us(),
+			   getpid(), args));
+}
+
+void trace_filters(int running, int waiting)
+{
+	char buf[160];
+
+	if (trace_fd < 0)
+		return;
+	emit(buf, snprintf(buf, sizeof(buf),
+			   "{\"name\":\"filters\",\"ph\":\"C\",\"ts\":%llu,"
+			   "\"pid\":%d,\"args\":{\"running\":%d,\"waiting\":%d}},\n",
+			   (unsigned long long)now_us(), getpid(), running,
+			   waiting));
+}
@@ -0,0 +1,48 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdint.h>
+#include "tools.h"
+
+/******************************************************************************
+ * timeline of tuner and filter activity, written by '--trace <file>' in
+ * Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+ * All functions are no-ops unless trace_open() was called; trace_begin()
+ * returns 0 in that case.
+ *****************************************************************************/
+
+void trace_open(const char *file);
+
+uint64_t trace_begin(void);
+
+/* duration event from trace_begin() until now; args < 0 are omitted. */
+void trace_end(uint64_t begin, const char *name, int fd, int pid,
+	       int table_id, uint32_t frequency);
+
+/* lifetime of a section filter, from start_filter() until stop_filter(). */
+void trace_filter(bool start, const void *id, int fd, int pid, int table_id,
+		  uint32_t frequency);
+
+/* number of running and waiting filters. */
+void trace_filters(int running, int waiting);
+
+#endif
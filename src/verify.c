@@ -0,0 +1,143 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "scan.h"
+#include "verify.h"
+
+struct verify *verify_open(const char *file, FILE * report)
+{
+	struct verify *v = calloc(1, sizeof(*v));
+
+	if (v == NULL)
+		fatal("out of memory\n");
+	if (chdb_open(&v->db, file) < 0)
+		fatal("could not read %s: %s\n", file, strerror(errno));
+	v->tps = calloc(v->db.transponder_count + 1, sizeof(*v->tps));
+	v->checked = calloc(v->db.transponder_count + 1, sizeof(*v->checked));
+	if ((v->tps == NULL) || (v->checked == NULL))
+		fatal("out of memory\n");
+	v->report = report;
+	fprintf(report, "# verify %s: %u transponders, %u services\n", file,
+		v->db.transponder_count, v->db.service_count);
+	return v;
+}
+
+static bool known_service(const struct verify *v, uint32_t index,
+			  uint16_t sid)
+{
+	uint32_t i;
+
+	for (i = 0; i < v->db.service_count; i++)
+		if ((chdb32(v->db.services[i].transponder) == index) &&
+		    (chdb16(v->db.services[i].service_id) == sid))
+			return true;
+	return false;
+}
+
+static bool same_name(const char *a, const char *b)
+{
+	return strcmp(a ? a : "", b ? b : "") == 0;
+}
+
+void verify_transponder(struct verify *v, struct transponder *t)
+{
+	const struct chdb_service *cs;
+	struct service *s;
+	char buffer[128];
+	uint32_t i, index;
+
+	for (index = 0; index < v->db.transponder_count; index++)
+		if (v->tps[index] == t)
+			break;
+	if (index == v->db.transponder_count)
+		return;		// not from db.
+	v->checked[index] = true;
+	v->locked++;
+	print_transponder(buffer, t);
+
+	for (i = 0; i < v->db.service_count; i++) {
+		const char *name;
+		uint16_t sid, pmt_pid;
+
+		cs = &v->db.services[i];
+		if (chdb32(cs->transponder) != index)
+			continue;
+		sid = chdb16(cs->service_id);
+		pmt_pid = chdb16(cs->pmt_pid);
+		name = chdb_string(&v->db, chdb32(cs->name));
+		s = find_service(t, sid);
+		if ((s == NULL) || (s->pmt_pid == 0)) {
+			fprintf(v->report, "%s sid %u '%s': missing\n", buffer,
+				sid, name);
+			v->missing++;
+			continue;
+		}
+		if (*name && !same_name(name, s->service_name)) {
+			fprintf(v->report, "%s sid %u '%s': renamed '%s'\n",
+				buffer, sid, name,
+				s->service_name ? s->service_name : "");
+			v->changed++;
+		}
+		if (pmt_pid != s->pmt_pid) {
+			fprintf(v->report, "%s sid %u '%s': pmt_pid %u -> %u\n",
+				buffer, sid, name, pmt_pid, s->pmt_pid);
+			v->changed++;
+		}
+	}
+
+	// only named services: PAT also lists data services not in db.
+	for (s = t->services->first; s; s = s->next) {
+		if (!s->pmt_pid || !s->service_name ||
+		    known_service(v, index, s->service_id))
+			continue;
+		fprintf(v->report, "%s sid %u '%s': new service\n", buffer,
+			s->service_id, s->service_name);
+		v->added++;
+	}
+}
+
+uint32_t verify_close(struct verify *v)
+{
+	char buffer[128];
+	uint32_t i, differences;
+
+	for (i = 0; i < v->db.transponder_count; i++) {
+		if ((v->tps[i] == NULL) || v->checked[i])
+			continue;
+		print_transponder(buffer, v->tps[i]);
+		fprintf(v->report, "%s: no lock\n", buffer);
+		v->no_lock++;
+	}
+	fprintf(v->report,
+		"# %u transponders ok, %u without lock; services: %u missing, "
+		"%u changed, %u new\n", v->locked, v->no_lock, v->missing,
+		v->changed, v->added);
+	fflush(v->report);
+	differences = v->no_lock + v->missing + v->changed + v->added;
+
+	chdb_close(&v->db);
+	free(v->tps);
+	free(v->checked);
+	free(v);
+	return differences;
+}
@@ -0,0 +1,56 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __VERIFY_H__
+#define __VERIFY_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include "si_types.h"
+#include "chdb.h"
+
+/******************************************************************************
+ * fast verification of a channel database, '--verify <file>'.
+ *
+ * Every transponder of <file> is tuned once, only PAT and SDT(actual) are
+ * read. The services found are compared with <file> by service_id, name
+ * and PMT PID; differences are written as lines of text.
+ *****************************************************************************/
+
+struct verify {
+	struct chdb db;
+	struct transponder **tps;	// db transponder index -> scanned tp
+	bool *checked;			// db transponder index -> tuned and read
+	FILE *report;
+	uint32_t locked;
+	uint32_t no_lock;
+	uint32_t missing;
+	uint32_t changed;
+	uint32_t added;
+};
+
+struct verify *verify_open(const char *file, FILE * report);
+void verify_transponder(struct verify *v, struct transponder *t);
+
+/* reports transponders without lock and a summary. Returns the number of
+ * differences found.
+ */
+uint32_t verify_close(struct verify *v);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Simple MPEG/DVB parser to achieve network/service information without initial tuning data
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * Or, point your browser to http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ */
+
+#ifndef __W_SCAN2_H__
+#define __W_SCAN2_H__
+
+/******************************************************************************
+ * libw_scan2: the scanner as a library. The w_scan2 command line tool is
+ * a client of it, see src/main.c.
+ *
+ *   struct scan_context *c = scan_context_new();
+ *   scan_context_set_callbacks(c, &callbacks);
+ *   scan_run(c, argc, argv);	// same options as w_scan2
+ *   scan_context_free(c);
+ *
+ * or, without a command line:
+ *
+ *   struct scan_option o[] = { { "f", "s" }, { "satellite", "S19E2" } };
+ *   scan_run_options(c, o, 2);
+ *
+ * No signal handlers are installed; w_scan2 calls scan_interrupt() on SIGINT.
+ *
+ * Callbacks are called from the scanning thread, once per scanned
+ * transponder and for each of its services selected by the -R/-T/-O/-E
+ * options. The structs are owned by the context; copy what is needed.
+ *
+ * Scans in several threads at once: one context per thread. Verbosity,
+ * --stats, --trace, --monitor and emulation state belong to the thread,
+ * not the context. Not in a multithreaded client: --scr-frontend (forks a
+ * process per frontend) and --daemon (forks per job, process-wide socket).
+ * NOTE: errors in the scan still end the process by fatal().
+ *****************************************************************************/
+
+#include "si_types.h"
+
+struct scan_context;
+
+struct scan_callbacks {
+	void (*transponder) (void *user, struct transponder * t);
+	void (*service) (void *user, struct transponder * t,
+			 struct service * s);
+	void *user;
+};
+
+struct scan_context *scan_context_new(void);
+void scan_context_free(struct scan_context *c);
+
+/* select c for the calling thread, returns the previous one. */
+struct scan_context *scan_context_use(struct scan_context *c);
+
+void scan_context_set_callbacks(struct scan_context *c,
+				const struct scan_callbacks *cb);
+
+/* configure by w_scan2 command line options, then scan with c selected
+ * for the calling thread. Returns the exit status of w_scan2.
+ */
+int scan_run(struct scan_context *c, int argc, char **argv);
+
+/* an option as name/value pair: name is a long option name ("satellite")
+ * or a single short option letter ("s"), without dashes. value is NULL for
+ * options without argument.
+ */
+struct scan_option {
+	const char *name;
+	const char *value;
+};
+
+/* as scan_run(), but options given by an array instead of argv. */
+int scan_run_options(struct scan_context *c, const struct scan_option *options,
+		     unsigned count);
+
+/* stop the scan running on c. The partial result is written and
+ * scan_run() returns 2. Async-signal-safe, may be called from a handler.
+ */
+void scan_interrupt(struct scan_context *c);
+
+#endif